@@ -1,11 +1,46 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include <SFML/Network.hpp>
+#include <SFML/OpenGL.hpp>
 #include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
 #include <cmath>
+#include <cfloat>
 #include <ctime>
 #include <cstdlib>
+#include <cstdio>
 #include <vector>
 #include <string>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cassert>
+#include <new>
+#include <atomic>
+#include <type_traits>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <semaphore.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define PONG_SIMD_PARTICLES
+#define PONG_SIMD_COLLISIONS
+#endif
 
 using namespace sf;
 using namespace std;
@@ -14,10 +49,16 @@ using namespace std;
 enum GameState
 {
     MENU,
+    OPTIONS,
+    AI_DIFFICULTY,
     PLAYING,
     PAUSED,
-    GAME_OVER
+    GAME_OVER,
+    REPLAY,
+    ARENA
 };
+const int GAME_STATE_COUNT = ARENA + 1;
+const char *const GAME_STATE_NAMES[GAME_STATE_COUNT] = {"MENU", "OPTIONS", "AI_DIFFICULTY", "PLAYING", "PAUSED", "GAME_OVER", "REPLAY", "ARENA"};
 enum AILevel
 {
     EASY,
@@ -47,31 +88,491 @@ enum PowerUpType
     FREEZE_OPPONENT,
     INVISIBLE_OPPONENT
 };
+const char *const POWER_UP_NAMES[INVISIBLE_OPPONENT + 1] = {
+    "BIGGER_PADDLE", "SMALLER_OPPONENT", "SLOW_BALL", "DOUBLE_BALL", "BARRIER", "INVERT_CONTROLS",
+    "FLASHING_BALL", "DOUBLE_POINTS", "LESS_POINTS", "FREEZE_OPPONENT", "INVISIBLE_OPPONENT"};
+
+// Efectos de sonido. Hay un sonido por cada tipo de power-up a partir de SOUND_POWERUP
+enum SoundEffect
+{
+    SOUND_PADDLE_HIT,
+    SOUND_WALL_BOUNCE,
+    SOUND_GOAL,
+    SOUND_POWERUP,
+    SOUND_COUNT = SOUND_POWERUP + INVISIBLE_OPPONENT + 1
+};
+
+// Paso fijo de la simulación: las velocidades de pelotas y paletas están en píxeles por tick
+const int TICK_RATE = 120;
+const Int64 TICK_MICROSECONDS = 1000000 / TICK_RATE;
+const int FRAME_RATE = 120; // frecuencia de dibujo por defecto; la simulación no depende de ella
+const Int64 INPUT_POLL_MICROSECONDS = 1000; // sondeo de entrada mientras se espera el siguiente frame
+
+// Coordenadas lógicas del campo: la simulación y el dibujo usan siempre este espacio y una
+// sf::View lo escala a la resolución real de la ventana
+const int FIELD_WIDTH = 850;
+const int FIELD_HEIGHT = 550;
+const int HEADER_HEIGHT = 70; // barra superior del marcador; el área de juego empieza debajo
+const int FIELD_CENTER_X = FIELD_WIDTH / 2;
+const int PLAY_CENTER_Y = (HEADER_HEIGHT + FIELD_HEIGHT) / 2; // centro del área de juego
+
+// Posiciones de arranque: la pelota, las paletas y las barreras quedan algo por encima del
+// centro del área de juego, como en el diseño original
+const int BALL_START_Y = PLAY_CENTER_Y - 25;
+const int PADDLE_MARGIN = 25; // del borde lateral al centro de la paleta
+const int PADDLE_START_Y = PLAY_CENTER_Y - 60;
+const int BARRIER_MARGIN = 100; // del borde lateral a la esquina de la barrera
+const int BARRIER_WIDTH = 10;
+const int BARRIER_HEIGHT = 100;
+const int BARRIER_Y = PLAY_CENTER_Y - 60;
+
+// Los power-ups aparecen lejos de las paletas y de las paredes
+const int POWER_UP_MARGIN_X = 100;
+const int POWER_UP_MARGIN_Y = 50;
+
+// Compilación instrumentada (-DPONG_INSTRUMENT): un reemplazo global de operator new/delete
+// cuenta reservas, bytes y liberaciones del hilo principal por fase del frame, junto con las
+// pruebas de colisión y las evaluaciones de la IA. Con -DPONG_ALLOCATION_BUDGET=n, las
+// compilaciones de depuración (sin NDEBUG) fallan con assert si un frame jugando reserva
+// más de n bloques. Sin PONG_INSTRUMENT todo esto desaparece.
+enum InstrumentPhase
+{
+    PHASE_EVENTS,
+    PHASE_SIMULATION,
+    PHASE_EFFECTS,
+    PHASE_RENDER,
+    PHASE_COUNT
+};
+
+#ifdef PONG_INSTRUMENT
+struct InstrumentCounters
+{
+    unsigned long long allocations[PHASE_COUNT];
+    unsigned long long bytes[PHASE_COUNT];
+    unsigned long long frees[PHASE_COUNT];
+    unsigned long long collisionTests;
+    unsigned long long aiEvaluations;
+};
+
+InstrumentCounters instrumentFrame;   // frame en curso
+InstrumentCounters instrumentTotal;   // acumulado de todos los frames
+InstrumentCounters instrumentMax;     // máximo de un solo frame
+unsigned long long instrumentFrames = 0;
+int instrumentPhase = PHASE_EVENTS;
+thread_local bool instrumentThread = false; // solo se cuenta el hilo principal
+
+void *operator new(size_t size)
+{
+    if (instrumentThread)
+    {
+        instrumentFrame.allocations[instrumentPhase]++;
+        instrumentFrame.bytes[instrumentPhase] += size;
+    }
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void *p) noexcept
+{
+    if (p && instrumentThread)
+        instrumentFrame.frees[instrumentPhase]++;
+    free(p);
+}
+
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
+
+#define PONG_COUNT_COLLISION() (instrumentThread ? (void)instrumentFrame.collisionTests++ : (void)0)
+#define PONG_COUNT_AI_EVALUATION() (instrumentThread ? (void)instrumentFrame.aiEvaluations++ : (void)0)
+
+void instrumentBegin()
+{
+    instrumentThread = true;
+}
+
+void instrumentSetPhase(InstrumentPhase phase)
+{
+    instrumentPhase = phase;
+}
+
+// Cierra el frame: acumula los contadores y verifica el presupuesto si se estaba jugando
+void instrumentEndFrame(bool playing)
+{
+    unsigned long long frameAllocations = 0;
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        frameAllocations += instrumentFrame.allocations[i];
+        instrumentTotal.allocations[i] += instrumentFrame.allocations[i];
+        instrumentTotal.bytes[i] += instrumentFrame.bytes[i];
+        instrumentTotal.frees[i] += instrumentFrame.frees[i];
+        instrumentMax.allocations[i] = max(instrumentMax.allocations[i], instrumentFrame.allocations[i]);
+        instrumentMax.bytes[i] = max(instrumentMax.bytes[i], instrumentFrame.bytes[i]);
+        instrumentMax.frees[i] = max(instrumentMax.frees[i], instrumentFrame.frees[i]);
+    }
+    instrumentTotal.collisionTests += instrumentFrame.collisionTests;
+    instrumentTotal.aiEvaluations += instrumentFrame.aiEvaluations;
+    instrumentMax.collisionTests = max(instrumentMax.collisionTests, instrumentFrame.collisionTests);
+    instrumentMax.aiEvaluations = max(instrumentMax.aiEvaluations, instrumentFrame.aiEvaluations);
+    instrumentFrames++;
+
+#if defined(PONG_ALLOCATION_BUDGET) && !defined(NDEBUG)
+    if (playing && frameAllocations > PONG_ALLOCATION_BUDGET)
+    {
+        cout << "Presupuesto de reservas excedido en el frame " << instrumentFrames << ": " << frameAllocations
+             << " (eventos " << instrumentFrame.allocations[PHASE_EVENTS] << ", simulacion " << instrumentFrame.allocations[PHASE_SIMULATION]
+             << ", efectos " << instrumentFrame.allocations[PHASE_EFFECTS] << ", render " << instrumentFrame.allocations[PHASE_RENDER] << ")" << endl;
+        assert(frameAllocations <= PONG_ALLOCATION_BUDGET);
+    }
+#else
+    (void)playing;
+    (void)frameAllocations;
+#endif
+
+    memset(&instrumentFrame, 0, sizeof(instrumentFrame));
+}
+
+void instrumentPrintStats()
+{
+    if (instrumentFrames == 0)
+        return;
+    const char *names[PHASE_COUNT] = {"eventos", "simulacion", "efectos", "render"};
+    cout << "Instrumentacion (" << instrumentFrames << " frames, promedio por frame / maximo):" << endl;
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        cout << "  " << names[i] << ": " << (double)instrumentTotal.allocations[i] / instrumentFrames << " / " << instrumentMax.allocations[i]
+             << " reservas, " << (double)instrumentTotal.bytes[i] / instrumentFrames << " / " << instrumentMax.bytes[i]
+             << " bytes, " << (double)instrumentTotal.frees[i] / instrumentFrames << " / " << instrumentMax.frees[i] << " liberaciones" << endl;
+    }
+    cout << "  pruebas de colision: " << (double)instrumentTotal.collisionTests / instrumentFrames << " / " << instrumentMax.collisionTests << endl;
+    cout << "  evaluaciones de IA: " << (double)instrumentTotal.aiEvaluations / instrumentFrames << " / " << instrumentMax.aiEvaluations << endl;
+}
+
+// Reservas más liberaciones del heap en el frame en curso, para mediciones fuera del juego
+long long instrumentHeapOperations()
+{
+    long long operations = 0;
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        operations += instrumentFrame.allocations[i] + instrumentFrame.frees[i];
+    }
+    return operations;
+}
+// Reservas de una fase en el frame en curso (antes de instrumentEndFrame)
+long long instrumentAllocations(InstrumentPhase phase)
+{
+    return (long long)instrumentFrame.allocations[phase];
+}
+#else
+#define PONG_COUNT_COLLISION() ((void)0)
+#define PONG_COUNT_AI_EVALUATION() ((void)0)
+
+inline void instrumentBegin() {}
+inline void instrumentSetPhase(InstrumentPhase) {}
+inline void instrumentEndFrame(bool) {}
+inline void instrumentPrintStats() {}
+inline long long instrumentHeapOperations() { return -1; } // sin instrumentación no se cuentan
+inline long long instrumentAllocations(InstrumentPhase) { return -1; }
+#endif
+
+// Generador pseudoaleatorio (xorshift32) propio de cada partido: un partido se puede
+// reproducir a partir de su semilla y varios partidos pueden simularse en paralelo
+class Random
+{
+private:
+    unsigned int state;
+
+public:
+    explicit Random(unsigned int seed = 1) { setSeed(seed); }
+
+    void setSeed(unsigned int seed) { state = seed != 0 ? seed : 0x9E3779B9u; }
+
+    // Entero en [0, 2^31), se usa igual que rand()
+    int next()
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (int)(state & 0x7FFFFFFF);
+    }
+
+    // Real en [0, 1)
+    float nextFloat() { return (next() & 0xFFFFFF) / (float)0x1000000; }
+
+    // Estado interno, para guardarlo en una instantánea y restaurarlo con setSeed()
+    unsigned int getState() const { return state; }
+};
+
+// Reloj de la simulación medido en ticks: solo avanza cuando corre un tick, así la pausa
+// lo detiene, la velocidad de juego lo escala y un partido sin ventana dura lo mismo en
+// tiempo de juego que uno en pantalla
+class SimulationClock
+{
+private:
+    Uint32 ticks;
+
+public:
+    SimulationClock() : ticks(0) {}
+
+    void advance() { ticks++; }
+    void reset() { ticks = 0; }
+    void setTicks(Uint32 value) { ticks = value; }
+    Uint32 getTicks() const { return ticks; }
+};
+
+// Temporizador derivado de un SimulationClock; se usa igual que sf::Clock
+class SimulationTimer
+{
+private:
+    const SimulationClock *clock;
+    Uint32 startTick;
+
+public:
+    explicit SimulationTimer(const SimulationClock &simulationClock)
+        : clock(&simulationClock), startTick(simulationClock.getTicks()) {}
+
+    void restart() { startTick = clock->getTicks(); }
+    Uint32 getStartTick() const { return startTick; }
+    void setStartTick(Uint32 tick) { startTick = tick; }
+    Uint32 getElapsedTicks() const { return clock->getTicks() - startTick; }
+    float getElapsedSeconds() const { return getElapsedTicks() / (float)TICK_RATE; }
+};
+
+// Memoria propia de un partido: un solo bloque reservado al crearlo, del que se toman los
+// objetos del partido avanzando un puntero. No se libera objeto por objeto; reset() devuelve
+// el bloque entero en O(1) y el heap global no se toca después de construirlo.
+class BumpArena
+{
+private:
+    char *block;
+    size_t capacity;
+    size_t used;
+    size_t highWater;
+
+    BumpArena(const BumpArena &);
+    BumpArena &operator=(const BumpArena &);
+
+public:
+    explicit BumpArena(size_t bytes) : block(new char[bytes]), capacity(bytes), used(0), highWater(0) {}
+    ~BumpArena() { delete[] block; }
+
+    void *allocate(size_t bytes, size_t alignment)
+    {
+        size_t start = (used + alignment - 1) & ~(alignment - 1);
+        if (start + bytes > capacity)
+            throw bad_alloc(); // el tamaño se calcula al crear el partido; no debería pasar
+        used = start + bytes;
+        highWater = max(highWater, used);
+        return block + start;
+    }
+
+    void reset() { used = 0; }
+
+    size_t getCapacity() const { return capacity; }
+    size_t getUsed() const { return used; }
+    size_t getHighWater() const { return highWater; }
+};
+
+// Asignador de la biblioteca estándar sobre un BumpArena, para los vector del partido
+template <typename T>
+struct ArenaAllocator
+{
+    typedef T value_type;
+    BumpArena *arena;
+
+    explicit ArenaAllocator(BumpArena *memory) : arena(memory) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t count) { return static_cast<T *>(arena->allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T *, size_t) {} // se devuelve todo junto con BumpArena::reset
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+
+// Número en punto fijo Q16.16 (16 bits enteros y 16 fraccionarios en un int de 32 bits).
+// Solo usa aritmética entera, así el modo de física en punto fijo da resultados idénticos
+// bit a bit con cualquier compilador, nivel de optimización o -ffast-math.
+struct Fixed
+{
+    int raw;
+
+    static Fixed fromRaw(int value)
+    {
+        Fixed f;
+        f.raw = value;
+        return f;
+    }
+    static Fixed fromInt(int value) { return fromRaw(value * 65536); }
+
+    // La conversión desde float redondea al 1/65536 más cercano; multiplicar por una
+    // potencia de dos en double es exacto, así que el resultado no depende del compilador
+    static Fixed fromFloat(float value) { return fromRaw((int)floor((double)value * 65536.0 + 0.5)); }
+    float toFloat() const { return (float)((double)raw / 65536.0); }
+
+    Fixed operator+(Fixed o) const { return fromRaw(raw + o.raw); }
+    Fixed operator-(Fixed o) const { return fromRaw(raw - o.raw); }
+    Fixed operator-() const { return fromRaw(-raw); }
+    Fixed operator*(Fixed o) const { return fromRaw((int)(((long long)raw * o.raw) >> 16)); }
+    Fixed operator/(Fixed o) const { return fromRaw((int)(((long long)raw * 65536) / o.raw)); }
+    Fixed &operator+=(Fixed o)
+    {
+        raw += o.raw;
+        return *this;
+    }
+    bool operator<(Fixed o) const { return raw < o.raw; }
+    bool operator>(Fixed o) const { return raw > o.raw; }
+    bool operator<=(Fixed o) const { return raw <= o.raw; }
+    bool operator>=(Fixed o) const { return raw >= o.raw; }
+    bool operator==(Fixed o) const { return raw == o.raw; }
+    bool operator!=(Fixed o) const { return raw != o.raw; }
+};
+
+inline Fixed fixedAbs(Fixed value) { return Fixed::fromRaw(value.raw < 0 ? -value.raw : value.raw); }
+inline Fixed fixedMin(Fixed a, Fixed b) { return a < b ? a : b; }
+
+// Raíz cuadrada entera bit a bit: sqrt(raw / 2^16) * 2^16 = sqrt(raw * 2^16)
+inline Fixed fixedSqrt(Fixed value)
+{
+    if (value.raw <= 0)
+        return Fixed::fromRaw(0);
+
+    unsigned long long remainder = (unsigned long long)value.raw << 16;
+    unsigned long long root = 0;
+    unsigned long long bit = 1ULL << 62;
+    while (bit > remainder)
+        bit >>= 2;
+    while (bit != 0)
+    {
+        if (remainder >= root + bit)
+        {
+            remainder -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return Fixed::fromRaw((int)root);
+}
+
+// Rectángulo de colisión en punto fijo, con la misma semántica que FloatRect
+struct FixedRect
+{
+    Fixed left, top, width, height;
+
+    bool contains(Fixed x, Fixed y) const
+    {
+        return x >= left && x < left + width && y >= top && y < top + height;
+    }
+
+    bool intersects(const FixedRect &o) const
+    {
+        Fixed interLeft = left > o.left ? left : o.left;
+        Fixed interTop = top > o.top ? top : o.top;
+        Fixed interRight = fixedMin(left + width, o.left + o.width);
+        Fixed interBottom = fixedMin(top + height, o.top + o.height);
+        return interLeft < interRight && interTop < interBottom;
+    }
+
+    // Para figuras sin rotación ni origen (las barreras)
+    static FixedRect fromShape(const RectangleShape &shape)
+    {
+        FixedRect rect;
+        rect.left = Fixed::fromFloat(shape.getPosition().x);
+        rect.top = Fixed::fromFloat(shape.getPosition().y);
+        rect.width = Fixed::fromFloat(shape.getSize().x);
+        rect.height = Fixed::fromFloat(shape.getSize().y);
+        return rect;
+    }
+};
+
+// Seno y coseno de 0 a 30 grados en Q16.16 (el ángulo de saque de la pelota)
+const int FIXED_SIN_DEGREES[31] = {0, 1144, 2287, 3430, 4572, 5712, 6850, 7987, 9121, 10252, 11380, 12505, 13626, 14742, 15855, 16962,
+                                   18064, 19161, 20252, 21336, 22415, 23486, 24550, 25607, 26656, 27697, 28729, 29753, 30767, 31772, 32768};
+const int FIXED_COS_DEGREES[31] = {65536, 65526, 65496, 65446, 65376, 65287, 65177, 65048, 64898, 64729, 64540, 64332, 64104, 63856, 63589, 63303,
+                                   62997, 62672, 62328, 61966, 61584, 61183, 60764, 60326, 59870, 59396, 58903, 58393, 57865, 57319, 56756};
+
+// Parámetros de la IA para un nivel de dificultad
+struct AIParams
+{
+    float errorChance; // probabilidad por tick de desviar la predicción
+    float speedFactor; // fracción de la velocidad máxima de la paleta
+    float errorAmount; // desvío máximo en píxeles
+};
+
+// Tabla de parámetros por nivel (EASY, MEDIUM, HARD, IMPOSSIBLE).
+// Se puede regenerar con PongMejorado.exe --tune-ai y pegar aquí la salida.
+// Es constexpr para que los controladores de cada nivel se compilen con sus valores.
+constexpr AIParams AI_LEVEL_PARAMS[4] = {
+    {0.9f, 0.1f, 100.0f}, // EASY
+    {0.8f, 0.3f, 80.0f},  // MEDIUM
+    {0.04f, 0.5f, 30.0f}, // HARD
+    {0.0f, 1.0f, 0.0f},   // IMPOSSIBLE
+};
+
+// Estado de una pelota en una instantánea del partido (se guarda tal cual en las repeticiones)
+struct BallState
+{
+    float x, y;
+    float velocityX, velocityY;
+    float flashDuration;
+    Uint32 flashStartTick;
+    int fixedX, fixedY;
+    int fixedVelocityX, fixedVelocityY;
+    Uint8 active, visible, flashing, fixedPoint;
+};
 
 // Clase para la pelota
 class Ball
 {
 private:
     Sprite sprite;
+    Random *rng;
     Vector2f velocity;
     float baseSpeed;
     float maxSpeed;
     bool active;
     bool visible;
+    Vector2f previousPosition; // posición al comenzar el último tick, para interpolar al dibujar
     bool isFlashing;
-    Clock flashTimer;
+    SimulationTimer flashTimer;
     float flashDuration; // segundos
     float flashInterval; // segundos entre cambios de visibilida
 
+    // Modo de física en punto fijo: la posición y la velocidad viven en los campos Fixed
+    // y el sprite solo copia la posición para dibujar y colisionar
+    bool fixedPoint;
+    Fixed fixedX, fixedY;
+    Fixed fixedVelocityX, fixedVelocityY;
+    Fixed fixedBaseSpeed;
+    Fixed fixedMaxSpeed;
+    Fixed fixedHalfSize;
+
 public:
-    Ball(Texture &texture) : isFlashing(false), flashDuration(3.0f), flashInterval(0.3f), visible(true)
+    Ball(Texture &texture, Random &random, const SimulationClock &clock, bool useFixedPoint = false)
+        : rng(&random), visible(true), isFlashing(false), flashTimer(clock), flashDuration(3.0f), flashInterval(0.3f),
+          fixedPoint(useFixedPoint)
     {
         sprite.setTexture(texture);
         sprite.setOrigin((float)texture.getSize().x / 2, (float)texture.getSize().y / 2);
         sprite.setScale(0.25f, 0.25f);
-        reset();
         baseSpeed = 3.0f;
         maxSpeed = 8.0f;
+        fixedBaseSpeed = Fixed::fromInt(3);
+        fixedMaxSpeed = Fixed::fromInt(8);
+        fixedX = fixedY = fixedVelocityX = fixedVelocityY = Fixed::fromRaw(0);
+        fixedHalfSize = Fixed::fromFloat(texture.getSize().x * 0.25f / 2); // exacto: escala 1/4 de un entero
+        reset();
         active = true;
     }
 
@@ -87,14 +588,14 @@ public:
     {
         if (isFlashing)
         {
-            if (flashTimer.getElapsedTime().asSeconds() >= flashDuration)
+            float elapsed = flashTimer.getElapsedSeconds();
+            if (elapsed >= flashDuration)
             {
                 isFlashing = false;
                 setVisible(true); // Al terminar el efecto, volver a ser visible
             }
             else
             {
-                float elapsed = flashTimer.getElapsedTime().asSeconds();
                 bool shouldBeVisible = static_cast<int>(elapsed / flashInterval) % 2 == 0;
                 setVisible(shouldBeVisible);
             }
@@ -103,28 +604,75 @@ public:
 
     void reset()
     {
-        sprite.setPosition(425, 285); // Ajustado para el nuevo área de juego
+        if (fixedPoint)
+        {
+            resetFixed();
+            previousPosition = sprite.getPosition();
+            return;
+        }
+
+        sprite.setPosition(FIELD_CENTER_X, BALL_START_Y);
+        previousPosition = sprite.getPosition(); // sin interpolar el salto al centro
         // Velocidad inicial aleatoria
-        float angle = (rand() % 60 - 30) * 3.14159f / 180.0f;
+        float angle = (rng->next() % 60 - 30) * 3.14159f / 180.0f;
         velocity.x = baseSpeed * cos(angle);
         velocity.y = baseSpeed * sin(angle);
 
         // Asegurar que la pelota vaya hacia un lado aleatorio
-        if (rand() % 2 == 0)
+        if (rng->next() % 2 == 0)
         {
             velocity.x = -velocity.x;
         }
     }
 
+    // Igual que reset() pero con las tablas de seno y coseno en punto fijo
+    void resetFixed()
+    {
+        fixedX = Fixed::fromInt(FIELD_CENTER_X);
+        fixedY = Fixed::fromInt(BALL_START_Y);
+        sprite.setPosition(fixedX.toFloat(), fixedY.toFloat());
+
+        int degrees = rng->next() % 60 - 30;
+        int index = degrees < 0 ? -degrees : degrees;
+        fixedVelocityX = fixedBaseSpeed * Fixed::fromRaw(FIXED_COS_DEGREES[index]);
+        fixedVelocityY = fixedBaseSpeed * Fixed::fromRaw(degrees < 0 ? -FIXED_SIN_DEGREES[index] : FIXED_SIN_DEGREES[index]);
+
+        if (rng->next() % 2 == 0)
+        {
+            fixedVelocityX = -fixedVelocityX;
+        }
+        syncFloatVelocity();
+    }
+
     void update()
     {
         if (!active)
             return; // Solo si la pelota ya fue destruida del juego
+        if (fixedPoint)
+        {
+            fixedX += fixedVelocityX;
+            fixedY += fixedVelocityY;
+            sprite.setPosition(fixedX.toFloat(), fixedY.toFloat());
+            return;
+        }
         sprite.move(velocity);
     }
 
     void accelerate()
     {
+        if (fixedPoint)
+        {
+            Fixed currentSpeed = fixedSqrt(fixedVelocityX * fixedVelocityX + fixedVelocityY * fixedVelocityY);
+            if (currentSpeed < fixedMaxSpeed && currentSpeed.raw > 0)
+            {
+                Fixed factor = fixedMin(currentSpeed * Fixed::fromRaw(68813), fixedMaxSpeed) / currentSpeed; // 1.05
+                fixedVelocityX = fixedVelocityX * factor;
+                fixedVelocityY = fixedVelocityY * factor;
+                syncFloatVelocity();
+            }
+            return;
+        }
+
         // Aumentar velocidad en un 5%
         float currentSpeed = sqrt(velocity.x * velocity.x + velocity.y * velocity.y);
         if (currentSpeed < maxSpeed)
@@ -137,12 +685,65 @@ public:
 
     void slowDown(float factor)
     {
+        if (fixedPoint)
+        {
+            Fixed fixedFactor = Fixed::fromFloat(factor);
+            fixedVelocityX = fixedVelocityX * fixedFactor;
+            fixedVelocityY = fixedVelocityY * fixedFactor;
+            syncFloatVelocity();
+            return;
+        }
         velocity.x *= factor;
         velocity.y *= factor;
     }
 
-    void reverseX() { velocity.x = -velocity.x; }
-    void reverseY() { velocity.y = -velocity.y; }
+    void reverseX()
+    {
+        velocity.x = -velocity.x;
+        fixedVelocityX = -fixedVelocityX;
+    }
+    void reverseY()
+    {
+        velocity.y = -velocity.y;
+        fixedVelocityY = -fixedVelocityY;
+    }
+
+    // Mueve la pelota (las colisiones con barreras la sacan de la barrera)
+    void setPosition(float x, float y)
+    {
+        if (fixedPoint)
+        {
+            fixedX = Fixed::fromFloat(x);
+            fixedY = Fixed::fromFloat(y);
+            sprite.setPosition(fixedX.toFloat(), fixedY.toFloat());
+            return;
+        }
+        sprite.setPosition(x, y);
+    }
+
+    void setFixedPosition(Fixed x, Fixed y)
+    {
+        fixedX = x;
+        fixedY = y;
+        sprite.setPosition(fixedX.toFloat(), fixedY.toFloat());
+    }
+
+    FixedRect getFixedBounds() const
+    {
+        FixedRect rect;
+        rect.left = fixedX - fixedHalfSize;
+        rect.top = fixedY - fixedHalfSize;
+        rect.width = fixedHalfSize + fixedHalfSize;
+        rect.height = rect.width;
+        return rect;
+    }
+
+    // En punto fijo la velocidad en float es solo una copia para consultas
+    void syncFloatVelocity()
+    {
+        velocity.x = fixedVelocityX.toFloat();
+        velocity.y = fixedVelocityY.toFloat();
+    }
 
     void setVisible(bool state) { visible = state; }
     bool isVisible() const { return visible; }
@@ -152,19 +753,88 @@ public:
     const Sprite &getSprite() const { return sprite; }
     Vector2f getPosition() const { return sprite.getPosition(); }
     Vector2f getVelocity() const { return velocity; }
+    float getSpeed() const { return sqrt(velocity.x * velocity.x + velocity.y * velocity.y); }
+    float getBaseSpeed() const { return baseSpeed; }
+    float getMaxSpeed() const { return maxSpeed; }
     void setActive(bool state) { active = state; }
     bool isActive() const { return active; }
+    bool isFixedPoint() const { return fixedPoint; }
+    Fixed getFixedX() const { return fixedX; }
+    Fixed getFixedY() const { return fixedY; }
+    Fixed getFixedVelocityX() const { return fixedVelocityX; }
+    Fixed getFixedVelocityY() const { return fixedVelocityY; }
+    Fixed getFixedHalfSize() const { return fixedHalfSize; }
+
+    // Guarda la posición al comenzar un tick; al dibujar se interpola entre ella y la actual
+    void storePreviousPosition() { previousPosition = sprite.getPosition(); }
+    Vector2f getPreviousPosition() const { return previousPosition; }
+
+    void saveState(BallState &state) const
+    {
+        state.x = sprite.getPosition().x;
+        state.y = sprite.getPosition().y;
+        state.velocityX = velocity.x;
+        state.velocityY = velocity.y;
+        state.flashDuration = flashDuration;
+        state.flashStartTick = flashTimer.getStartTick();
+        state.fixedX = fixedX.raw;
+        state.fixedY = fixedY.raw;
+        state.fixedVelocityX = fixedVelocityX.raw;
+        state.fixedVelocityY = fixedVelocityY.raw;
+        state.active = active;
+        state.visible = visible;
+        state.flashing = isFlashing;
+        state.fixedPoint = fixedPoint;
+    }
+
+    void loadState(const BallState &state)
+    {
+        sprite.setPosition(state.x, state.y);
+        previousPosition = sprite.getPosition();
+        velocity = Vector2f(state.velocityX, state.velocityY);
+        flashDuration = state.flashDuration;
+        flashTimer.setStartTick(state.flashStartTick);
+        fixedX = Fixed::fromRaw(state.fixedX);
+        fixedY = Fixed::fromRaw(state.fixedY);
+        fixedVelocityX = Fixed::fromRaw(state.fixedVelocityX);
+        fixedVelocityY = Fixed::fromRaw(state.fixedVelocityY);
+        active = state.active != 0;
+        visible = state.visible != 0;
+        isFlashing = state.flashing != 0;
+        fixedPoint = state.fixedPoint != 0;
+    }
+};
+
+typedef vector<Ball, ArenaAllocator<Ball> > BallList;
+
+// Estado de una paleta en una instantánea del partido
+struct PaddleState
+{
+    float x, y;
+    float scaleX, scaleY;
+    AIParams aiParams;
+    Uint8 aiLevel, isAI, invertedControls, reserved;
 };
 
+class Paddle;
+
+// Controlador de IA ya especializado; se elige al configurar la paleta, no en cada tick
+typedef void (*AIControllerFunction)(Paddle &paddle, const BallList &balls, bool isLeftPaddle, Random &rng);
+AIControllerFunction aiControllerFor(const AIParams &params);
+
 // Clase para la paleta
 class Paddle
 {
 private:
     Sprite sprite;
+    FloatRect bounds; // getGlobalBounds() del sprite, recalculada solo al moverse o cambiar de tamaño
+    Vector2f previousPosition;
     float speed;
     float originalScale;
     bool invertedControls;
     AILevel aiLevel;
+    AIParams aiParams;
+    AIControllerFunction aiController;
     bool isAI;
 
 public:
@@ -176,119 +846,70 @@ public:
         if (isLeftPaddle)
         {
             sprite.setRotation(90);
-            sprite.setPosition(25, 250);
+            sprite.setPosition(PADDLE_MARGIN, PADDLE_START_Y);
         }
         else
         {
             sprite.setRotation(-90);
-            sprite.setPosition(825, 250);
+            sprite.setPosition(FIELD_WIDTH - PADDLE_MARGIN, PADDLE_START_Y);
         }
+        previousPosition = sprite.getPosition();
+        refreshBounds();
 
         speed = 4.0f;
         originalScale = 1.0f;
         invertedControls = false;
         isAI = isAIControlled;
-        aiLevel = level;
+        setAILevel(level);
     }
 
-    void update(const vector<Ball> &balls, bool isLeftPaddle)
+    void update(const BallList &balls, bool isLeftPaddle, Random &rng)
     {
         if (isAI)
         {
-            updateAI(balls, isLeftPaddle);
+            aiController(*this, balls, isLeftPaddle, rng);
         }
     }
 
-    void updateAI(const vector<Ball> &balls, bool isLeftPaddle)
+    // Caja de colisión en punto fijo sin pasar por las transformaciones en float de SFML.
+    // La paleta siempre está rotada 90 grados: el ancho de la textura es el alto en pantalla.
+    FixedRect getFixedBounds() const
     {
-        // No hacer nada si no hay pelotas activas
-        if (balls.empty())
-            return;
-
-        // Encontrar la pelota más cercana que se dirige hacia esta paleta
-        Ball *targetBall = nullptr;
-        float closestDistance = 1000000.0f;
-
-        for (const Ball &ball : balls)
-        {
-            if (!ball.isActive())
-                continue;
-
-            Vector2f ballPos = ball.getPosition();
-            Vector2f ballVel = ball.getVelocity();
-
-            // Solo considerar pelotas que vienen hacia esta paleta
-            if ((isLeftPaddle && ballVel.x < 0) || (!isLeftPaddle && ballVel.x > 0))
-            {
-                float distance = abs(ballPos.x - sprite.getPosition().x);
-                if (distance < closestDistance)
-                {
-                    closestDistance = distance;
-                    targetBall = const_cast<Ball *>(&ball);
-                }
-            }
-        }
-
-        if (targetBall == nullptr)
-        {
-            // Si no hay pelotas viniendo, volver al centro
-            moveTowardsY(250);
-            return;
-        }
-
-        Vector2f ballPos = targetBall->getPosition();
-        Vector2f ballVel = targetBall->getVelocity();
-
-        // Calcular dónde estará la pelota cuando llegue a la posición X de la paleta
-        float timeToReach = abs((sprite.getPosition().x - ballPos.x) / ballVel.x);
-        float predictedY = ballPos.y + ballVel.y * timeToReach;
-
-        // Ajustar por rebotes en las paredes
-        while (predictedY < 70 || predictedY > 550)
-        {
-            if (predictedY < 70)
-                predictedY = 140 - predictedY;
-            if (predictedY > 550)
-                predictedY = 1100 - predictedY;
-        }
-
-        // Añadir error según el nivel de dificultad
-        float errorChance = 0.0f;
-        float speedFactor = 1.0f;
-        float errorAmount = 0.0f;
-
-        switch (aiLevel)
-        {
-        case EASY:
-            errorChance = 0.9f;
-            speedFactor = 0.1f;
-            errorAmount = 100.0f;
-            break;
-        case MEDIUM:
-            errorChance = 0.8f;
-            speedFactor = 0.3f;
-            errorAmount = 80.0f;
-            break;
-        case HARD:
-            errorChance = 0.04f;
-            speedFactor = 0.5f;
-            errorAmount = 30.0f;
-            break;
-        case IMPOSSIBLE:
-            errorChance = 0.0f;
-            speedFactor = 1.0f;
-            errorAmount = 0.0f;
-            break;
-        }
+        const IntRect &textureRect = sprite.getTextureRect();
+        Fixed halfWidth = Fixed::fromFloat(textureRect.height * sprite.getScale().y / 2);
+        Fixed halfHeight = Fixed::fromFloat(textureRect.width * sprite.getScale().x / 2);
+
+        FixedRect rect;
+        rect.left = Fixed::fromFloat(sprite.getPosition().x) - halfWidth;
+        rect.top = Fixed::fromFloat(sprite.getPosition().y) - halfHeight;
+        rect.width = halfWidth + halfWidth;
+        rect.height = halfHeight + halfHeight;
+        return rect;
+    }
 
-        // Aplicar error aleatorio
-        if ((float)rand() / RAND_MAX < errorChance)
-        {
-            predictedY += (rand() % (int)(errorAmount * 2) - errorAmount);
-        }
+    // Movimiento hacia una altura en punto fijo (IA con pelotas en ese modo)
+    void moveTowardsYFixed(Fixed targetY, float speedFactor)
+    {
+        Fixed actualSpeed = Fixed::fromFloat(speed) * Fixed::fromFloat(speedFactor);
+        Fixed currentY = Fixed::fromFloat(sprite.getPosition().y);
+        Fixed halfHeight = Fixed::fromRaw(getFixedBounds().height.raw / 2);
+        const Fixed top = Fixed::fromInt(HEADER_HEIGHT);
+        const Fixed bottom = Fixed::fromInt(FIELD_HEIGHT);
+
+        if (fixedAbs(currentY - targetY) < actualSpeed)
+            currentY = targetY;
+        else if (currentY < targetY)
+            currentY += actualSpeed;
+        else
+            currentY = currentY - actualSpeed;
 
-        // Mover hacia la posición predicha
-        moveTowardsY(predictedY, speedFactor);
+        // Asegurar que la paleta no salga de la pantalla
+        if (currentY < top + halfHeight)
+            currentY = top + halfHeight;
+        if (currentY > bottom - halfHeight)
+            currentY = bottom - halfHeight;
+        sprite.setPosition(sprite.getPosition().x, currentY.toFloat());
+        refreshBounds();
     }
 
     void moveTowardsY(float targetY, float speedFactor = 1.0f)
@@ -309,33 +930,73 @@ public:
             sprite.move(0, -actualSpeed);
         }
 
+        refreshBounds();
+
         // Asegurar que la paleta no salga de la pantalla
         Vector2f pos = sprite.getPosition();
-        if (pos.y < 70 + sprite.getGlobalBounds().height / 2)
-            sprite.setPosition(pos.x, 70 + sprite.getGlobalBounds().height / 2);
-        if (pos.y > 550 - sprite.getGlobalBounds().height / 2)
-            sprite.setPosition(pos.x, 550 - sprite.getGlobalBounds().height / 2);
+        if (pos.y < HEADER_HEIGHT + bounds.height / 2)
+        {
+            sprite.setPosition(pos.x, HEADER_HEIGHT + bounds.height / 2);
+            refreshBounds();
+        }
+        if (pos.y > FIELD_HEIGHT - bounds.height / 2)
+        {
+            sprite.setPosition(pos.x, FIELD_HEIGHT - bounds.height / 2);
+            refreshBounds();
+        }
     }
 
     void move(float offsetY)
     {
         // Mueve la paleta
         sprite.move(0, offsetY);
+        refreshBounds();
 
         // Obtener la posición actual
         Vector2f pos = sprite.getPosition();
 
         // Verificar y ajustar si la paleta se sale de los límites
-        if (pos.y < 70 + sprite.getGlobalBounds().height / 2)
+        if (pos.y < HEADER_HEIGHT + bounds.height / 2)
         {
-            sprite.setPosition(pos.x, 70 + sprite.getGlobalBounds().height / 2);
+            sprite.setPosition(pos.x, HEADER_HEIGHT + bounds.height / 2);
+            refreshBounds();
         }
-        else if (pos.y > 550 - sprite.getGlobalBounds().height / 2)
+        else if (pos.y > FIELD_HEIGHT - bounds.height / 2)
         {
-            sprite.setPosition(pos.x, 550 - sprite.getGlobalBounds().height / 2);
+            sprite.setPosition(pos.x, FIELD_HEIGHT - bounds.height / 2);
+            refreshBounds();
         }
     }
 
+    void storePreviousPosition() { previousPosition = sprite.getPosition(); }
+    Vector2f getPreviousPosition() const { return previousPosition; }
+
+    void saveState(PaddleState &state) const
+    {
+        state.x = sprite.getPosition().x;
+        state.y = sprite.getPosition().y;
+        state.scaleX = sprite.getScale().x;
+        state.scaleY = sprite.getScale().y;
+        state.aiParams = aiParams;
+        state.aiLevel = (Uint8)aiLevel;
+        state.isAI = isAI;
+        state.invertedControls = invertedControls;
+        state.reserved = 0;
+    }
+
+    void loadState(const PaddleState &state)
+    {
+        sprite.setPosition(state.x, state.y);
+        previousPosition = sprite.getPosition();
+        sprite.setScale(state.scaleX, state.scaleY);
+        aiParams = state.aiParams;
+        aiController = aiControllerFor(aiParams);
+        aiLevel = static_cast<AILevel>(state.aiLevel);
+        isAI = state.isAI != 0;
+        invertedControls = state.invertedControls != 0;
+        refreshBounds();
+    }
+
     void setSize(float scaleFactor)
     {
         if (sprite.getRotation() == 90 || sprite.getRotation() == -90)
@@ -348,12 +1009,14 @@ public:
             // Para paletas sin rotación, ajustamos la escala Y
             sprite.setScale(sprite.getScale().x, originalScale * scaleFactor);
         }
+        refreshBounds();
     }
 
     void resetSize()
     {
         // Restaurar la escala original en ambos ejes
         sprite.setScale(originalScale, originalScale);
+        refreshBounds();
     }
 
     void setInvertedControls(bool inverted)
@@ -364,30 +1027,244 @@ public:
     void setAILevel(AILevel level)
     {
         aiLevel = level;
+        setAIParams(AI_LEVEL_PARAMS[level]);
     }
 
+    // Parámetros a medida (los usa el ajuste automático de la IA)
+    void setAIParams(const AIParams &params)
+    {
+        aiParams = params;
+        aiController = aiControllerFor(params);
+    }
+
+    const AIParams &getAIParams() const { return aiParams; }
+
+    // Quien mueva el sprite desde afuera tiene que llamar a refreshBounds()
     Sprite &getSprite() { return sprite; }
     const Sprite &getSprite() const { return sprite; }
+    const FloatRect &getBounds() const { return bounds; }
+    void refreshBounds() { bounds = sprite.getGlobalBounds(); }
     bool hasInvertedControls() { return invertedControls; }
     AILevel getAILevel() { return aiLevel; }
     void setIsAI(bool ai) { isAI = ai; }
     bool getIsAI() { return isAI; }
-    float getSpeed() { return speed; } // Añadir este método
+    float getSpeed() const { return speed; } // Añadir este método
 };
 
-// Clase para los power-ups
-class PowerUp
+// Políticas de la IA. Cada nivel combina una de cada tipo en AIController y el
+// compilador genera una función sin ramas de configuración para ese nivel.
+
+// Objetivo: la pelota activa más cercana que se dirige hacia la paleta
+struct NearestIncomingBall
 {
-private:
+    static const Ball *select(const Paddle &paddle, const BallList &balls, bool isLeftPaddle)
+    {
+        const Ball *targetBall = nullptr;
+        float closestDistance = 1000000.0f;
+        float paddleX = paddle.getSprite().getPosition().x;
+
+        for (const Ball &ball : balls)
+        {
+            if (!ball.isActive())
+                continue;
+
+            // Solo considerar pelotas que vienen hacia esta paleta
+            Vector2f ballVel = ball.getVelocity();
+            if ((isLeftPaddle && ballVel.x < 0) || (!isLeftPaddle && ballVel.x > 0))
+            {
+                float distance = abs(ball.getPosition().x - paddleX);
+                if (distance < closestDistance)
+                {
+                    closestDistance = distance;
+                    targetBall = &ball;
+                }
+            }
+        }
+        return targetBall;
+    }
+};
+
+// Predicción: dónde estará la pelota al llegar a la X de la paleta, con rebotes en las paredes
+struct BouncePredictor
+{
+    static float predict(const Paddle &paddle, const Ball &ball)
+    {
+        Vector2f ballPos = ball.getPosition();
+        Vector2f ballVel = ball.getVelocity();
+
+        float timeToReach = abs((paddle.getSprite().getPosition().x - ballPos.x) / ballVel.x);
+        float predictedY = ballPos.y + ballVel.y * timeToReach;
+
+        while (predictedY < HEADER_HEIGHT || predictedY > FIELD_HEIGHT)
+        {
+            if (predictedY < HEADER_HEIGHT)
+                predictedY = 2 * HEADER_HEIGHT - predictedY;
+            if (predictedY > FIELD_HEIGHT)
+                predictedY = 2 * FIELD_HEIGHT - predictedY;
+        }
+        return predictedY;
+    }
+
+    static Fixed predictFixed(const Paddle &paddle, const Ball &ball)
+    {
+        Fixed paddleX = Fixed::fromFloat(paddle.getSprite().getPosition().x);
+        Fixed timeToReach = fixedAbs((paddleX - ball.getFixedX()) / ball.getFixedVelocityX());
+        Fixed predictedY = ball.getFixedY() + ball.getFixedVelocityY() * timeToReach;
+
+        const Fixed top = Fixed::fromInt(HEADER_HEIGHT);
+        const Fixed bottom = Fixed::fromInt(FIELD_HEIGHT);
+        while (predictedY < top || predictedY > bottom)
+        {
+            if (predictedY < top)
+                predictedY = Fixed::fromInt(2 * HEADER_HEIGHT) - predictedY;
+            if (predictedY > bottom)
+                predictedY = Fixed::fromInt(2 * FIELD_HEIGHT) - predictedY;
+        }
+        return predictedY;
+    }
+};
+
+// Ruido: sin error (no consume números aleatorios)
+struct NoNoise
+{
+    static void apply(const Paddle &, Random &, float &) {}
+    static void applyFixed(const Paddle &, Random &, Fixed &) {}
+};
+
+// Ruido con la probabilidad y el desvío de la tabla del nivel, conocidos al compilar
+template <AILevel Level>
+struct LevelNoise
+{
+    static void apply(const Paddle &, Random &rng, float &predictedY)
+    {
+        if (rng.nextFloat() < AI_LEVEL_PARAMS[Level].errorChance)
+            predictedY += (rng.nextFloat() * 2.0f - 1.0f) * AI_LEVEL_PARAMS[Level].errorAmount;
+    }
+
+    // nextFloat() es un múltiplo exacto de 2^-24, así que la conversión es determinista
+    static void applyFixed(const Paddle &, Random &rng, Fixed &predictedY)
+    {
+        if (rng.nextFloat() < AI_LEVEL_PARAMS[Level].errorChance)
+            predictedY += Fixed::fromFloat(rng.nextFloat() * 2.0f - 1.0f) * Fixed::fromFloat(AI_LEVEL_PARAMS[Level].errorAmount);
+    }
+};
+
+// Ruido con los parámetros a medida de la paleta (ajuste automático)
+struct TunedNoise
+{
+    static void apply(const Paddle &paddle, Random &rng, float &predictedY)
+    {
+        const AIParams &params = paddle.getAIParams();
+        if (rng.nextFloat() < params.errorChance)
+            predictedY += (rng.nextFloat() * 2.0f - 1.0f) * params.errorAmount;
+    }
+
+    static void applyFixed(const Paddle &paddle, Random &rng, Fixed &predictedY)
+    {
+        const AIParams &params = paddle.getAIParams();
+        if (rng.nextFloat() < params.errorChance)
+            predictedY += Fixed::fromFloat(rng.nextFloat() * 2.0f - 1.0f) * Fixed::fromFloat(params.errorAmount);
+    }
+};
+
+// Límite de velocidad de la tabla del nivel
+template <AILevel Level>
+struct LevelSpeed
+{
+    static float factor(const Paddle &) { return AI_LEVEL_PARAMS[Level].speedFactor; }
+};
+
+// Límite de velocidad a medida de la paleta
+struct TunedSpeed
+{
+    static float factor(const Paddle &paddle) { return paddle.getAIParams().speedFactor; }
+};
+
+template <typename Target, typename Predictor, typename Noise, typename Speed>
+struct AIController
+{
+    static void update(Paddle &paddle, const BallList &balls, bool isLeftPaddle, Random &rng)
+    {
+        PONG_COUNT_AI_EVALUATION();
+
+        // No hacer nada si no hay pelotas activas
+        if (balls.empty())
+            return;
+
+        const Ball *targetBall = Target::select(paddle, balls, isLeftPaddle);
+        if (targetBall == nullptr)
+        {
+            // Si no hay pelotas viniendo, volver al centro
+            paddle.moveTowardsY(PADDLE_START_Y);
+            return;
+        }
+
+        if (targetBall->isFixedPoint())
+        {
+            Fixed predictedY = Predictor::predictFixed(paddle, *targetBall);
+            Noise::applyFixed(paddle, rng, predictedY);
+            paddle.moveTowardsYFixed(predictedY, Speed::factor(paddle));
+            return;
+        }
+
+        float predictedY = Predictor::predict(paddle, *targetBall);
+        Noise::apply(paddle, rng, predictedY);
+        paddle.moveTowardsY(predictedY, Speed::factor(paddle));
+    }
+};
+
+// Controlador de un nivel de la tabla; si el nivel nunca se equivoca no lleva ruido
+template <AILevel Level>
+using LevelAIController = AIController<NearestIncomingBall, BouncePredictor,
+                                       typename conditional<(AI_LEVEL_PARAMS[Level].errorChance > 0.0f), LevelNoise<Level>, NoNoise>::type,
+                                       LevelSpeed<Level>>;
+
+typedef AIController<NearestIncomingBall, BouncePredictor, TunedNoise, TunedSpeed> TunedAIController;
+
+// Los parámetros de un nivel de la tabla usan su controlador especializado; el resto, el genérico
+AIControllerFunction aiControllerFor(const AIParams &params)
+{
+    static const AIControllerFunction levelControllers[4] = {
+        &LevelAIController<EASY>::update,
+        &LevelAIController<MEDIUM>::update,
+        &LevelAIController<HARD>::update,
+        &LevelAIController<IMPOSSIBLE>::update,
+    };
+
+    for (int level = 0; level < 4; level++)
+    {
+        const AIParams &levelParams = AI_LEVEL_PARAMS[level];
+        if (params.errorChance == levelParams.errorChance && params.speedFactor == levelParams.speedFactor &&
+            params.errorAmount == levelParams.errorAmount)
+            return levelControllers[level];
+    }
+    return &TunedAIController::update;
+}
+
+// Estado de un power-up en una instantánea del partido
+struct PowerUpState
+{
+    float x, y;
+    Uint32 startTick;
+    int duration;
+    Uint8 type, active, collected, reserved;
+};
+
+// Clase para los power-ups
+class PowerUp
+{
+private:
     PowerUpType type;
     Sprite sprite;
-    Clock timer;
+    FloatRect bounds; // el power-up no se mueve después de aparecer
+    SimulationTimer timer;
     bool active;
     bool collected;
     int duration; // en segundos
 
 public:
-    PowerUp(PowerUpType t, Texture &texture)
+    PowerUp(PowerUpType t, Texture &texture, Random &rng, const SimulationClock &clock)
+        : timer(clock)
     {
         type = t;
         sprite.setTexture(texture);
@@ -395,9 +1272,10 @@ public:
         sprite.setScale(0.5f, 0.5f);
 
         // Posición aleatoria en el campo
-        float x = 100 + rand() % 650;
-        float y = 120 + rand() % 380; // Ajustado para el nuevo área de juego
+        float x = POWER_UP_MARGIN_X + rng.next() % (FIELD_WIDTH - 2 * POWER_UP_MARGIN_X);
+        float y = HEADER_HEIGHT + POWER_UP_MARGIN_Y + rng.next() % (FIELD_HEIGHT - HEADER_HEIGHT - 2 * POWER_UP_MARGIN_Y);
         sprite.setPosition(x, y);
+        bounds = sprite.getGlobalBounds();
 
         active = true;
         collected = false;
@@ -406,7 +1284,7 @@ public:
 
     void update()
     {
-        if (collected && timer.getElapsedTime().asSeconds() >= duration)
+        if (collected && timer.getElapsedSeconds() >= duration)
         {
             active = false;
         }
@@ -418,1704 +1296,7833 @@ public:
         timer.restart();
     }
 
+    void saveState(PowerUpState &state) const
+    {
+        state.x = sprite.getPosition().x;
+        state.y = sprite.getPosition().y;
+        state.startTick = timer.getStartTick();
+        state.duration = duration;
+        state.type = (Uint8)type;
+        state.active = active;
+        state.collected = collected;
+        state.reserved = 0;
+    }
+
+    // El tipo (y su textura) se elige al construir el power-up
+    void loadState(const PowerUpState &state)
+    {
+        sprite.setPosition(state.x, state.y);
+        bounds = sprite.getGlobalBounds();
+        timer.setStartTick(state.startTick);
+        duration = state.duration;
+        active = state.active != 0;
+        collected = state.collected != 0;
+    }
+
     PowerUpType getType() const { return type; }
     const Sprite &getSprite() const { return sprite; }
+    const FloatRect &getBounds() const { return bounds; }
     bool isActive() const { return active; }
     bool isCollected() const { return collected; }
 };
 
-// Clase para el temporizador
-class GameTimer
+typedef vector<PowerUp, ArenaAllocator<PowerUp> > PowerUpList;
+
+// Lugar de cada objeto en CollisionBoxes. El orden de las paletas y barreras es el de las
+// pruebas de updateBalls, que se queda con el primer golpe.
+enum CollisionSlot
+{
+    SLOT_RIGHT_PADDLE,
+    SLOT_LEFT_PADDLE,
+    SLOT_LEFT_BARRIER,
+    SLOT_RIGHT_BARRIER,
+    SLOT_FIRST_POWER_UP,
+    COLLISION_SLOT_COUNT = 8 // hasta 4 power-ups: dos pasadas de 4 cajas
+};
+
+// Cajas de colisión de todo lo que puede tocar una pelota, en columnas (izquierda, arriba,
+// derecha, abajo) para probar una pelota contra 4 cajas por instrucción. Cada prueba devuelve
+// una máscara con un bit por lugar; los lugares vacíos nunca dan golpe. Las comparaciones son
+// las mismas que las de FloatRect::contains e intersects, con el mismo resultado.
+class CollisionBoxes
 {
 private:
-    Clock clock;
-    int totalSeconds;
-    Text display;
+    float left[COLLISION_SLOT_COUNT];
+    float top[COLLISION_SLOT_COUNT];
+    float right[COLLISION_SLOT_COUNT];
+    float bottom[COLLISION_SLOT_COUNT];
 
 public:
-    GameTimer(Font &font, int minutes)
+    CollisionBoxes()
     {
-        totalSeconds = minutes * 60;
-        display.setFont(font);
-        display.setCharacterSize(30);
-        display.setPosition(425, 30); // Centrado en la parte superior
-        display.setOrigin(display.getLocalBounds().width / 2, 0);
-        updateDisplay();
+        for (int i = 0; i < COLLISION_SLOT_COUNT; i++)
+        {
+            clear(i);
+        }
     }
 
-    void updateDisplay()
+    void set(int slot, const FloatRect &bounds)
     {
-        int remainingSeconds = totalSeconds - (int)clock.getElapsedTime().asSeconds();
-        if (remainingSeconds < 0)
-            remainingSeconds = 0;
-
-        int minutes = remainingSeconds / 60;
-        int seconds = remainingSeconds % 60;
-
-        string timeStr = (minutes < 10 ? "0" : "") + to_string(minutes) + ":" +
-                         (seconds < 10 ? "0" : "") + to_string(seconds);
-        display.setString(timeStr);
+        left[slot] = bounds.left;
+        top[slot] = bounds.top;
+        right[slot] = bounds.left + bounds.width;
+        bottom[slot] = bounds.top + bounds.height;
+    }
 
-        // Actualizar el origen para mantenerlo centrado cuando cambia el texto
-        display.setOrigin(display.getLocalBounds().width / 2, 0);
+    // Caja invertida: ningún punto ni caja la toca
+    void clear(int slot)
+    {
+        left[slot] = top[slot] = FLT_MAX;
+        right[slot] = bottom[slot] = -FLT_MAX;
     }
 
-    bool isTimeUp()
+    // Cajas que contienen el punto (el centro de la pelota)
+    unsigned int containsMask(float x, float y) const
     {
-        return clock.getElapsedTime().asSeconds() >= totalSeconds;
+#ifdef PONG_SIMD_COLLISIONS
+        const __m128 vX = _mm_set1_ps(x);
+        const __m128 vY = _mm_set1_ps(y);
+        unsigned int mask = 0;
+        for (int i = 0; i < COLLISION_SLOT_COUNT; i += 4)
+        {
+            __m128 insideX = _mm_and_ps(_mm_cmpge_ps(vX, _mm_loadu_ps(left + i)), _mm_cmplt_ps(vX, _mm_loadu_ps(right + i)));
+            __m128 insideY = _mm_and_ps(_mm_cmpge_ps(vY, _mm_loadu_ps(top + i)), _mm_cmplt_ps(vY, _mm_loadu_ps(bottom + i)));
+            mask |= (unsigned int)_mm_movemask_ps(_mm_and_ps(insideX, insideY)) << i;
+        }
+        return mask;
+#else
+        return containsMaskScalar(x, y);
+#endif
     }
 
-    void reset()
+    unsigned int containsMaskScalar(float x, float y) const
     {
-        clock.restart();
+        unsigned int mask = 0;
+        for (int i = 0; i < COLLISION_SLOT_COUNT; i++)
+        {
+            if (x >= left[i] && x < right[i] && y >= top[i] && y < bottom[i])
+                mask |= 1u << i;
+        }
+        return mask;
     }
 
-    Text &getDisplay() { return display; }
+    // Cajas que se solapan con la caja dada (la de la pelota)
+    unsigned int intersectsMask(const FloatRect &bounds) const
+    {
+        float boundsRight = bounds.left + bounds.width;
+        float boundsBottom = bounds.top + bounds.height;
+#ifdef PONG_SIMD_COLLISIONS
+        const __m128 vLeft = _mm_set1_ps(bounds.left);
+        const __m128 vTop = _mm_set1_ps(bounds.top);
+        const __m128 vRight = _mm_set1_ps(boundsRight);
+        const __m128 vBottom = _mm_set1_ps(boundsBottom);
+        unsigned int mask = 0;
+        for (int i = 0; i < COLLISION_SLOT_COUNT; i += 4)
+        {
+            __m128 overlapX = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(left + i), vRight), _mm_cmplt_ps(vLeft, _mm_loadu_ps(right + i)));
+            __m128 overlapY = _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(top + i), vBottom), _mm_cmplt_ps(vTop, _mm_loadu_ps(bottom + i)));
+            mask |= (unsigned int)_mm_movemask_ps(_mm_and_ps(overlapX, overlapY)) << i;
+        }
+        return mask;
+#else
+        unsigned int mask = 0;
+        for (int i = 0; i < COLLISION_SLOT_COUNT; i++)
+        {
+            if (left[i] < boundsRight && bounds.left < right[i] && top[i] < boundsBottom && bounds.top < bottom[i])
+                mask |= 1u << i;
+        }
+        return mask;
+#endif
+    }
 };
 
-// Clase para el menú
-class Menu
-{
-private:
-    vector<Text> options;
-    int selectedOption;
-    Font &font;
+// Tamaños de pixelart.ttf que usa el juego; para cada uno se pre-rasterizan el ASCII imprimible
+// y Latin-1 (acentos, ñ, ¡, ¿)
+const unsigned int BAKED_FONT_SIZES[] = {14, 30, 40, 50, 60};
+const int BAKED_FONT_SIZE_COUNT = sizeof(BAKED_FONT_SIZES) / sizeof(BAKED_FONT_SIZES[0]);
+const int BAKED_FONT_ATLAS_WIDTH = 1024;
+const int BITMAP_TEXT_RESERVED_GLYPHS = 80; // el más largo, la ayuda del visor de repeticiones, tiene 77 glifos visibles
+const char *const FONT_PATH = "c:\\Pong\\images\\pixelart.ttf";
+const char *const BAKED_FONT_PATH = "c:\\Pong\\images\\pixelart_atlas"; // .png (atlas) y .txt (métricas)
 
-    // Configuraciones del juego
-    GameMode gameMode;
-    AILevel aiLevel1;
-    AILevel aiLevel2;
-    int gameDuration; // en minutos
-    int maxScore;
-    bool powerUpsEnabled;
-    float initialBallSpeed;
+inline bool isBakedCharacter(Uint32 c)
+{
+    return (c >= 32 && c <= 126) || (c >= 161 && c <= 255);
+}
 
+// Atlas de glifos pre-rasterizados con sus métricas. Se genera una vez con --bake-font; si el
+// archivo falta, se hornea desde la fuente al iniciar, antes del primer frame. FreeType
+// (sf::Font) queda como respaldo para los tamaños y caracteres que no están en el atlas.
+class BitmapFont
+{
 public:
-    Menu(Font &f) : font(f)
+    struct BakedGlyph
     {
-        selectedOption = 0;
+        float advance;
+        FloatRect bounds;    // relativo al origen en la línea base, como en sf::Glyph
+        IntRect textureRect; // en el atlas, con 1 píxel de margen transparente alrededor
+    };
 
-        // Valores por defecto
-        gameMode = PLAYER_VS_AI;
-        aiLevel1 = MEDIUM;
-        aiLevel2 = MEDIUM;
-        gameDuration = 3;
-        maxScore = 7;
-        powerUpsEnabled = true;
-        initialBallSpeed = 3.0f;
+    // Ajuste entre dos caracteres horneados; solo se guardan los pares distintos de cero
+    struct KerningPair
+    {
+        Uint16 pair; // primer carácter << 8 | segundo
+        float amount;
+    };
 
-        // Crear opciones del menú
-        createMenuOptions();
+private:
+    const Font *fallback;
+    Texture atlas;
+    vector<BakedGlyph> glyphs;
+    Int16 glyphIndex[BAKED_FONT_SIZE_COUNT][256]; // -1 si el carácter no está horneado
+    float lineSpacing[BAKED_FONT_SIZE_COUNT];
+    vector<KerningPair> kerning[BAKED_FONT_SIZE_COUNT]; // ordenados por pair (pixelart.ttf no tiene)
+
+    void clear()
+    {
+        glyphs.clear();
+        for (int slot = 0; slot < BAKED_FONT_SIZE_COUNT; slot++)
+        {
+            lineSpacing[slot] = (float)BAKED_FONT_SIZES[slot];
+            kerning[slot].clear();
+            for (int c = 0; c < 256; c++)
+                glyphIndex[slot][c] = -1;
+        }
     }
 
-    void createMenuOptions()
+public:
+    BitmapFont() : fallback(nullptr)
     {
-        options.clear();
+        clear();
+    }
 
-        // Título
-        Text title("PONG 2.0", font, 50);
+    // Rasteriza todos los glifos con FreeType y los empaqueta por filas en un solo atlas
+    bool bake(const Font &font)
+    {
+        fallback = &font;
+        clear();
 
-        // Centrar el texto horizontalmente
-        FloatRect textBounds = title.getLocalBounds();
-        title.setOrigin(textBounds.left + textBounds.width / 2.0f, textBounds.top); // Centra horizontalmente el origen
-        title.setPosition(850 / 2.0f, 50);                                          // Posición centrada en X, Y fija
+        vector<IntRect> sources;
+        vector<Image> pages(BAKED_FONT_SIZE_COUNT);
+        int x = 0, y = 0, rowHeight = 0;
+        for (int slot = 0; slot < BAKED_FONT_SIZE_COUNT; slot++)
+        {
+            unsigned int size = BAKED_FONT_SIZES[slot];
+            lineSpacing[slot] = font.getLineSpacing(size);
 
-        options.push_back(title);
+            // La página de la fuente crece mientras se agregan glifos: copiarla recién cuando están todos
+            for (Uint32 c = 0; c < 256; c++)
+            {
+                if (isBakedCharacter(c))
+                    font.getGlyph(c, size, false);
+            }
+            pages[slot] = font.getTexture(size).copyToImage();
 
-        // Opciones principales
-        addOption("Player vs IA", 200);
-        addOption("2 Player", 250);
-        addOption("IA vs IA", 300);
-        addOption("Opciones", 350);
-        addOption("Salir", 400);
+            for (Uint32 c = 0; c < 256; c++)
+            {
+                if (!isBakedCharacter(c))
+                    continue;
+                const Glyph &glyph = font.getGlyph(c, size, false);
+                BakedGlyph baked;
+                baked.advance = glyph.advance;
+                baked.bounds = glyph.bounds;
+                IntRect source;
+                if (glyph.textureRect.width > 0 && glyph.textureRect.height > 0)
+                {
+                    source = IntRect(glyph.textureRect.left - 1, glyph.textureRect.top - 1, glyph.textureRect.width + 2, glyph.textureRect.height + 2);
+                    if (x + source.width > BAKED_FONT_ATLAS_WIDTH)
+                    {
+                        x = 0;
+                        y += rowHeight;
+                        rowHeight = 0;
+                    }
+                    baked.textureRect = IntRect(x, y, source.width, source.height);
+                    x += source.width;
+                    rowHeight = max(rowHeight, source.height);
+                }
+                glyphIndex[slot][c] = (Int16)glyphs.size();
+                glyphs.push_back(baked);
+                sources.push_back(source);
+            }
 
-        // Resaltar la opción seleccionada
-        options[selectedOption + 1].setFillColor(Color::Yellow);
+            // El kerning se consulta a FreeType una sola vez aquí, no en cada cambio de texto
+            for (Uint32 first = 0; first < 256; first++)
+            {
+                if (!isBakedCharacter(first))
+                    continue;
+                for (Uint32 second = 0; second < 256; second++)
+                {
+                    float amount = isBakedCharacter(second) ? font.getKerning(first, second, size) : 0.0f;
+                    if (amount != 0.0f)
+                    {
+                        KerningPair pair = {(Uint16)(first << 8 | second), amount};
+                        kerning[slot].push_back(pair);
+                    }
+                }
+            }
+        }
+
+        Image image;
+        image.create(BAKED_FONT_ATLAS_WIDTH, max(1, y + rowHeight), Color(255, 255, 255, 0));
+        size_t index = 0;
+        for (int slot = 0; slot < BAKED_FONT_SIZE_COUNT; slot++)
+        {
+            const Image &page = pages[slot];
+            Vector2u pageSize = page.getSize();
+            for (Uint32 c = 0; c < 256; c++)
+            {
+                if (!isBakedCharacter(c))
+                    continue;
+                const IntRect &source = sources[index];
+                const IntRect &target = glyphs[index].textureRect;
+                index++;
+                for (int row = 0; row < source.height; row++)
+                {
+                    for (int column = 0; column < source.width; column++)
+                    {
+                        int sourceX = source.left + column;
+                        int sourceY = source.top + row;
+                        if (sourceX >= 0 && sourceY >= 0 && sourceX < (int)pageSize.x && sourceY < (int)pageSize.y)
+                            image.setPixel(target.left + column, target.top + row, page.getPixel(sourceX, sourceY));
+                    }
+                }
+            }
+        }
+        atlas.setSmooth(true); // igual que las páginas de sf::Font
+        return atlas.loadFromImage(image);
     }
 
-    void addOption(const std::string &text, float y)
+    // Escribe el atlas (.png) y las métricas (.txt) para cargarlos en los próximos arranques
+    bool save(const string &path) const
     {
-        Text option(text, font, 30);
-        FloatRect bounds = option.getLocalBounds();
-        option.setOrigin(bounds.left + bounds.width / 2.0f, bounds.top); // Centra horizontalmente
-        option.setPosition(850 / 2.0f, y);                               // Centra en X
-        options.push_back(option);
+        ofstream metrics(path + ".txt");
+        if (!metrics || !atlas.copyToImage().saveToFile(path + ".png"))
+            return false;
+        metrics << "PONGFONT 2 " << BAKED_FONT_SIZE_COUNT << endl;
+        metrics << setprecision(9);
+        for (int slot = 0; slot < BAKED_FONT_SIZE_COUNT; slot++)
+        {
+            int count = 0;
+            for (int c = 0; c < 256; c++)
+                count += glyphIndex[slot][c] >= 0;
+            metrics << "size " << BAKED_FONT_SIZES[slot] << " " << lineSpacing[slot] << " " << count << endl;
+            for (int c = 0; c < 256; c++)
+            {
+                if (glyphIndex[slot][c] < 0)
+                    continue;
+                const BakedGlyph &glyph = glyphs[glyphIndex[slot][c]];
+                metrics << c << " " << glyph.advance << " " << glyph.bounds.left << " " << glyph.bounds.top << " " << glyph.bounds.width << " "
+                        << glyph.bounds.height << " " << glyph.textureRect.left << " " << glyph.textureRect.top << " " << glyph.textureRect.width
+                        << " " << glyph.textureRect.height << endl;
+            }
+            metrics << "kerning " << kerning[slot].size() << endl;
+            for (const KerningPair &pair : kerning[slot])
+            {
+                metrics << (pair.pair >> 8) << " " << (pair.pair & 0xFF) << " " << pair.amount << endl;
+            }
+        }
+        return (bool)metrics;
     }
 
-    void moveUp()
+    // Carga un atlas generado con save; falla si no coincide con los tamaños de BAKED_FONT_SIZES
+    bool loadFromFile(const string &path, const Font &font)
     {
-        options[selectedOption + 1].setFillColor(Color::White);
-        selectedOption = (selectedOption - 1 + 5) % 5; // 5 opciones en total
-        options[selectedOption + 1].setFillColor(Color::Yellow);
+        fallback = &font;
+        clear();
+
+        ifstream metrics(path + ".txt");
+        string magic;
+        int version = 0, sizeCount = 0;
+        if (!(metrics >> magic >> version >> sizeCount) || magic != "PONGFONT" || version != 2 || sizeCount != BAKED_FONT_SIZE_COUNT)
+            return false;
+        for (int slot = 0; slot < BAKED_FONT_SIZE_COUNT; slot++)
+        {
+            string tag;
+            unsigned int size = 0;
+            int count = 0;
+            if (!(metrics >> tag >> size >> lineSpacing[slot] >> count) || tag != "size" || size != BAKED_FONT_SIZES[slot])
+            {
+                clear();
+                return false;
+            }
+            for (int i = 0; i < count; i++)
+            {
+                int c = 0;
+                BakedGlyph glyph;
+                if (!(metrics >> c >> glyph.advance >> glyph.bounds.left >> glyph.bounds.top >> glyph.bounds.width >> glyph.bounds.height >>
+                      glyph.textureRect.left >> glyph.textureRect.top >> glyph.textureRect.width >> glyph.textureRect.height) ||
+                    c < 0 || c > 255)
+                {
+                    clear();
+                    return false;
+                }
+                glyphIndex[slot][c] = (Int16)glyphs.size();
+                glyphs.push_back(glyph);
+            }
+
+            int pairCount = 0;
+            if (!(metrics >> tag >> pairCount) || tag != "kerning")
+            {
+                clear();
+                return false;
+            }
+            for (int i = 0; i < pairCount; i++)
+            {
+                int first = 0, second = 0;
+                float amount = 0.0f;
+                if (!(metrics >> first >> second >> amount) || first < 0 || first > 255 || second < 0 || second > 255)
+                {
+                    clear();
+                    return false;
+                }
+                KerningPair pair = {(Uint16)(first << 8 | second), amount};
+                kerning[slot].push_back(pair);
+            }
+            sort(kerning[slot].begin(), kerning[slot].end(), [](const KerningPair &a, const KerningPair &b) { return a.pair < b.pair; });
+        }
+
+        atlas.setSmooth(true);
+        if (!atlas.loadFromFile(path + ".png"))
+        {
+            clear();
+            return false;
+        }
+        return true;
     }
 
-    void moveDown()
+    // Posición de size en BAKED_FONT_SIZES, o -1 si ese tamaño no está horneado
+    int getSizeSlot(unsigned int size) const
     {
-        options[selectedOption + 1].setFillColor(Color::White);
-        selectedOption = (selectedOption + 1) % 5; // 5 opciones en total
-        options[selectedOption + 1].setFillColor(Color::Yellow);
+        for (int slot = 0; slot < BAKED_FONT_SIZE_COUNT; slot++)
+        {
+            if (BAKED_FONT_SIZES[slot] == size)
+                return glyphs.empty() ? -1 : slot;
+        }
+        return -1;
     }
 
-    int getSelectedOption()
+    // Nulo si el carácter no está en el atlas para ese tamaño
+    const BakedGlyph *getGlyph(Uint32 c, int slot) const
     {
-        return selectedOption;
+        if (c > 255 || glyphIndex[slot][c] < 0)
+            return nullptr;
+        return &glyphs[glyphIndex[slot][c]];
     }
 
-    void draw(RenderWindow &window)
+    float getLineSpacing(int slot) const { return lineSpacing[slot]; }
+
+    // Kerning horneado; 0 para los pares que no lo tienen o con caracteres fuera del atlas
+    float getKerning(Uint32 first, Uint32 second, int slot) const
     {
-        for (const auto &option : options)
-        {
-            window.draw(option);
-        }
+        const vector<KerningPair> &pairs = kerning[slot];
+        if (pairs.empty() || first > 255 || second > 255)
+            return 0.0f;
+        Uint16 key = (Uint16)(first << 8 | second);
+        vector<KerningPair>::const_iterator found = lower_bound(pairs.begin(), pairs.end(), key,
+                                                                [](const KerningPair &pair, Uint16 value) { return pair.pair < value; });
+        return found != pairs.end() && found->pair == key ? found->amount : 0.0f;
     }
 
-    // Getters y setters para las configuraciones
-    GameMode getGameMode() { return gameMode; }
-    void setGameMode(GameMode mode) { gameMode = mode; }
-
-    AILevel getAILevel1() { return aiLevel1; }
-    void setAILevel1(AILevel level) { aiLevel1 = level; }
-
-    AILevel getAILevel2() { return aiLevel2; }
-    void setAILevel2(AILevel level) { aiLevel2 = level; }
-
-    int getGameDuration() { return gameDuration; }
-    void setGameDuration(int minutes) { gameDuration = minutes; }
-
-    int getMaxScore() { return maxScore; }
-    void setMaxScore(int score) { maxScore = score; }
-
-    bool arePowerUpsEnabled() { return powerUpsEnabled; }
-    void setPowerUpsEnabled(bool enabled) { powerUpsEnabled = enabled; }
-
-    float getInitialBallSpeed() { return initialBallSpeed; }
-    void setInitialBallSpeed(float speed) { initialBallSpeed = speed; }
+    const Texture &getTexture() const { return atlas; }
+    const Font *getFallback() const { return fallback; }
+    size_t getGlyphCount() const { return glyphs.size(); }
 };
 
-// Clase principal del juego
-class Game
+// Texto dibujado con quads directamente desde el atlas de BitmapFont, con la misma disposición
+// que sf::Text. Cambiar el texto no pasa por el caché de glifos de FreeType; si falta algún
+// carácter o el tamaño no está horneado, se dibuja con un sf::Text de respaldo.
+class BitmapText : public Drawable, public Transformable
 {
 private:
-    RenderWindow window;
-    GameState state;
-    // En la sección private de la clase Game
-    vector<Text> pauseMenuOptions;
-    int selectedPauseOption;
-
-    // Recursos
-    Texture ballTexture;
-    Texture paddleTexture;
-    Texture powerUpTextures[11]; // Una textura para cada tipo de power-up
-    Font font;
-
-    // Elementos del juego
-    vector<Ball> balls;
-    Paddle leftPaddle = Paddle(paddleTexture, true, false, EASY);
-    Paddle rightPaddle = Paddle(paddleTexture, false, true, EASY); // Inicializar con un valor por defecto
-    vector<PowerUp> powerUps;
-    bool freezeLeftActive;
-    bool freezeRightActive;
-    Clock freezeTimerLeft;
-    Clock freezeTimerRight;
-    bool invisibleLeftActive;
-    bool invisibleRightActive;
-    Clock invisibleTimerLeft;
-    Clock invisibleTimerRight;
-    bool biggerLeftActive;
-    bool biggerRightActive;
-    Clock biggerTimerLeft;
-    Clock biggerTimerRight;
-    bool barrierLeftActive;
-    bool barrierRightActive;
-    Clock barrierTimerLeft;
-    Clock barrierTimerRight;
-    RectangleShape leftBarrier;
-    RectangleShape rightBarrier;
-    bool smallerLeftActive;
-    bool smallerRightActive;
-    Clock smallerTimerLeft;
-    Clock smallerTimerRight;
-    Clock doublePointsTimer;
-    Clock lessPointsTimer;
-
-    // Interfaz
-    Text scoreLeft;
-    Text scoreRight;
-    Text pauseText;
-    Text gameOverText;
-    RectangleShape headerBar; // Barra para separar el área de puntaje del juego
-
-    // Lógica del juego
-    int leftScore;
-    int rightScore;
-    GameTimer *timer;
-    Menu *menu;
-    Clock powerUpSpawnTimer;
-    bool doublePointsActive;
-    bool lessPointsActive;
-
-    // Configuraciones
-    GameMode gameMode;
-    int maxScore;
-    bool powerUpsEnabled;
+    const BitmapFont *font;
+    String text;
+    unsigned int characterSize;
+    Color fillColor;
+    vector<Vertex> vertices; // 4 por glifo visible (Quads)
+    FloatRect bounds;
+    bool usesFallback;
+    Text fallbackText;
+
+    void addQuad(float x, float y, const BitmapFont::BakedGlyph &glyph)
+    {
+        // El quad incluye el margen de 1 píxel del atlas para que el suavizado no corte los bordes
+        float left = x + glyph.bounds.left - 1;
+        float top = y + glyph.bounds.top - 1;
+        float right = x + glyph.bounds.left + glyph.bounds.width + 1;
+        float bottom = y + glyph.bounds.top + glyph.bounds.height + 1;
+        float u1 = (float)glyph.textureRect.left;
+        float v1 = (float)glyph.textureRect.top;
+        float u2 = (float)(glyph.textureRect.left + glyph.textureRect.width);
+        float v2 = (float)(glyph.textureRect.top + glyph.textureRect.height);
+
+        vertices.push_back(Vertex(Vector2f(left, top), fillColor, Vector2f(u1, v1)));
+        vertices.push_back(Vertex(Vector2f(right, top), fillColor, Vector2f(u2, v1)));
+        vertices.push_back(Vertex(Vector2f(right, bottom), fillColor, Vector2f(u2, v2)));
+        vertices.push_back(Vertex(Vector2f(left, bottom), fillColor, Vector2f(u1, v2)));
+    }
 
-public:
-    Game() : window(VideoMode(850, 550), "Pong 2.0") // Aumentar altura para el área de puntaje
+    void rebuild()
     {
-        // Inicializar el generador de números aleatorios
-        srand(static_cast<unsigned int>(time(nullptr)));
+        vertices.clear();
+        bounds = FloatRect();
+        usesFallback = false;
+        if (!font || text.isEmpty())
+            return;
 
-        // Cargar recursos ANTES de crear las paletas
-        if (!ballTexture.loadFromFile("c:\\Pong\\imagesBri\\Pelota.png"))
+        int slot = font->getSizeSlot(characterSize);
+        bool baked = slot >= 0 && font->getGlyph(' ', slot);
+        for (size_t i = 0; i < text.getSize() && baked; i++)
         {
-            cout << "Error al cargar textura Bola" << endl;
+            if (text[i] != '\n' && text[i] != '\t')
+                baked = font->getGlyph(text[i], slot) != nullptr;
         }
-
-        if (!paddleTexture.loadFromFile("c:\\Pong\\imagesBri\\Paleta.png"))
+        if (!baked)
         {
-            cout << "Error al cargar textura Paleta" << endl;
+            // Respaldo: FreeType rasteriza lo que el atlas no tiene
+            usesFallback = true;
+            if (font->getFallback())
+            {
+                fallbackText.setFont(*font->getFallback());
+                fallbackText.setCharacterSize(characterSize);
+                fallbackText.setString(text);
+                fallbackText.setFillColor(fillColor);
+                bounds = fallbackText.getLocalBounds();
+            }
+            return;
         }
 
-        if (!font.loadFromFile("c:\\Pong\\images\\pixelart.ttf"))
+        // La primera línea base queda a characterSize del borde superior, como en sf::Text
+        float whitespaceWidth = font->getGlyph(' ', slot)->advance;
+        float x = 0.0f;
+        float y = (float)characterSize;
+        float minX = (float)characterSize, minY = (float)characterSize;
+        float maxX = 0.0f, maxY = 0.0f;
+        Uint32 previous = 0;
+        for (size_t i = 0; i < text.getSize(); i++)
         {
-            cout << "Error al cargar Fuente Pixel Art" << endl;
-        }
+            Uint32 c = text[i];
+            x += font->getKerning(previous, c, slot);
+            previous = c;
 
-        // Inicializar las paletas DESPUÉS de cargar las texturas
-        leftPaddle = Paddle(paddleTexture, true, false, EASY);
-        rightPaddle = Paddle(paddleTexture, false, true, menu->getAILevel1());
+            if (c == ' ' || c == '\t' || c == '\n')
+            {
+                minX = min(minX, x);
+                minY = min(minY, y);
+                if (c == ' ')
+                    x += whitespaceWidth;
+                else if (c == '\t')
+                    x += whitespaceWidth * 4;
+                else
+                {
+                    y += font->getLineSpacing(slot);
+                    x = 0.0f;
+                }
+                maxX = max(maxX, x);
+                maxY = max(maxY, y);
+                continue;
+            }
 
-        // Cargar texturas de power-ups (esto es un placeholder, necesitarías crear estas imágenes)
-        // En una implementación real, cargarías imágenes distintas para cada power-up
-        if (!powerUpTextures[BIGGER_PADDLE].loadFromFile("c:\\Pong\\imagesBri\\PaletaMasGrande.png"))
-        {
-            cout << "Error al cargar textura para BIGGER_PADDLE" << endl;
-        }
-        if (!powerUpTextures[SMALLER_OPPONENT].loadFromFile("c:\\Pong\\imagesBri\\PaletaMasPequena.png"))
-        {
-            cout << "Error al cargar textura para SMALLER_OPPONENT" << endl;
+            const BitmapFont::BakedGlyph &glyph = *font->getGlyph(c, slot);
+            if (glyph.textureRect.width > 0)
+                addQuad(x, y, glyph);
+            minX = min(minX, x + glyph.bounds.left);
+            maxX = max(maxX, x + glyph.bounds.left + glyph.bounds.width);
+            minY = min(minY, y + glyph.bounds.top);
+            maxY = max(maxY, y + glyph.bounds.top + glyph.bounds.height);
+            x += glyph.advance;
         }
-        if (!powerUpTextures[SLOW_BALL].loadFromFile("c:\\Pong\\imagesBri\\pelotaLenta.png"))
-        {
-            cout << "Error al cargar textura para SLOW_BALL" << endl;
-        }
-        if (!powerUpTextures[DOUBLE_BALL].loadFromFile("c:\\Pong\\imagesBri\\DoblePelota.png"))
-        {
-            cout << "Error al cargar textura para DOUBLE_BALL" << endl;
-        }
-        if (!powerUpTextures[BARRIER].loadFromFile("c:\\Pong\\imagesBri\\Barrera.png"))
-        {
-            cout << "Error al cargar textura para BARRIER" << endl;
-        }
-        if (!powerUpTextures[INVERT_CONTROLS].loadFromFile("c:\\Pong\\imagesBri\\CambioDeControles.png"))
-        {
-            cout << "Error al cargar textura para INVERT_CONTROLS" << endl;
-        }
-        if (!powerUpTextures[FLASHING_BALL].loadFromFile("c:\\Pong\\imagesBri\\PelotasFantasmas.png"))
-        {
-            cout << "Error al cargar textura para FLASHING_BALL" << endl;
-        }
-        if (!powerUpTextures[DOUBLE_POINTS].loadFromFile("c:\\Pong\\imagesBri\\PuntosDobles.png"))
-        {
-            cout << "Error al cargar textura para DOUBLE_POINTS" << endl;
-        }
-        if (!powerUpTextures[LESS_POINTS].loadFromFile("c:\\Pong\\imagesBri\\PuntosNegativos.png"))
-        {
-            cout << "Error al cargar textura para LESS_POINTS" << endl;
-        }
-        if (!powerUpTextures[FREEZE_OPPONENT].loadFromFile("c:\\Pong\\imagesBri\\BloqueoPaleta.png"))
-        {
-            cout << "Error al cargar textura para FREEZE_OPPONENT" << endl;
-        }
-        if (!powerUpTextures[INVISIBLE_OPPONENT].loadFromFile("c:\\Pong\\imagesBri\\VisionObstruida.png"))
-        {
-            cout << "Error al cargar textura para INVISIBLE_OPPONENT" << endl;
-        }
-
-        // Configurar la ventana
-        window.setFramerateLimit(120);
-
-        // Inicializar el estado del juego
-        state = MENU;
-
-        // Crear el menú
-        menu = new Menu(font);
-
-        // Actualizar el nivel de AI de la paleta derecha
-        rightPaddle = Paddle(paddleTexture, false, true, menu->getAILevel1());
-
-        // Inicializar la pelota
-        balls.push_back(Ball(ballTexture));
-
-        // Configurar el texto
-        scoreLeft.setFont(font);
-        scoreLeft.setCharacterSize(40);
-        scoreLeft.setPosition(200, 30); // Posición en la barra superior
+        bounds = FloatRect(minX, minY, maxX - minX, maxY - minY);
+    }
 
-        scoreRight.setFont(font);
-        scoreRight.setCharacterSize(40);
-        scoreRight.setPosition(650, 30); // Posición en la barra superior
+public:
+    BitmapText() : font(nullptr), characterSize(30), fillColor(Color::White), usesFallback(false)
+    {
+        vertices.reserve(BITMAP_TEXT_RESERVED_GLYPHS * 4);
+    }
 
-        // Crear barra de separación
-        headerBar.setSize(Vector2f(850, 70));      // Altura de la barra superior
-        headerBar.setFillColor(Color(20, 20, 20)); // Color ligeramente diferente al fondo
-        headerBar.setPosition(0, 0);
+    BitmapText(const String &string, const BitmapFont &bitmapFont, unsigned int size = 30)
+        : font(&bitmapFont), text(string), characterSize(size), fillColor(Color::White), usesFallback(false)
+    {
+        vertices.reserve(BITMAP_TEXT_RESERVED_GLYPHS * 4);
+        rebuild();
+    }
 
-        pauseText.setFont(font);
-        pauseText.setCharacterSize(50);
-        pauseText.setString("PAUSA");
-        pauseText.setPosition(250, 150);
-        pauseText.setFillColor(Color::White);
+    void setFont(const BitmapFont &bitmapFont)
+    {
+        font = &bitmapFont;
+        rebuild();
+    }
 
-        // En el constructor de Game, después de inicializar pauseText
-        pauseMenuOptions.clear();
-        selectedPauseOption = 0;
+    void setString(const String &string)
+    {
+        if (text == string)
+            return;
+        text = string;
+        rebuild();
+    }
 
-        Text resumeOption("Continuar", font, 30);
-        resumeOption.setPosition(350, 200);
-        pauseMenuOptions.push_back(resumeOption);
+    void setCharacterSize(unsigned int size)
+    {
+        if (characterSize == size)
+            return;
+        characterSize = size;
+        rebuild();
+    }
 
-        Text menuOption("Volver al Menu", font, 30);
-        menuOption.setPosition(350, 250);
-        pauseMenuOptions.push_back(menuOption);
+    void setFillColor(const Color &color)
+    {
+        fillColor = color;
+        for (auto &vertex : vertices)
+            vertex.color = color;
+        if (usesFallback)
+            fallbackText.setFillColor(color);
+    }
 
-        Text exitOption("Salir", font, 30);
-        exitOption.setPosition(350, 300);
-        pauseMenuOptions.push_back(exitOption);
+    const String &getString() const { return text; }
+    unsigned int getCharacterSize() const { return characterSize; }
+    const Color &getFillColor() const { return fillColor; }
+    FloatRect getLocalBounds() const { return bounds; }
+    FloatRect getGlobalBounds() const { return getTransform().transformRect(bounds); }
+    bool isUsingFallback() const { return usesFallback; }
 
-        // Centrar las opciones horizontalmente
-        for (auto &option : pauseMenuOptions)
+protected:
+    void draw(RenderTarget &target, RenderStates states) const
+    {
+        states.transform *= getTransform();
+        if (usesFallback)
         {
-            FloatRect bounds = option.getLocalBounds();
-            option.setOrigin(bounds.width / 2, 0);
-            option.setPosition(425, option.getPosition().y);
+            target.draw(fallbackText, states);
         }
+        else if (!vertices.empty())
+        {
+            states.texture = &font->getTexture();
+            target.draw(&vertices[0], vertices.size(), Quads, states);
+        }
+    }
+};
 
-        // Resaltar la opción seleccionada
-        pauseMenuOptions[selectedPauseOption].setFillColor(Color::Yellow);
-
-        gameOverText.setFont(font);
-        gameOverText.setCharacterSize(30); // Tamaño más pequeño
-        gameOverText.setFillColor(Color::White);
+// Clase para el temporizador
+class GameTimer
+{
+private:
+    SimulationTimer clock; // tiempo de juego: se detiene en pausa
+    int totalSeconds;
+    int shownSeconds; // segundos que muestra actualmente el texto
+    BitmapText display;
+    String timeText;  // "mm:ss", se modifica en el lugar para no reservar memoria cada segundo
 
-        // Centrar el texto horizontalmente
-        FloatRect textBounds = gameOverText.getLocalBounds();
-        gameOverText.setOrigin(textBounds.left + textBounds.width / 2.0f, textBounds.top + textBounds.height / 2.0f);
-        gameOverText.setPosition(425, 275); // Centro de la pantalla
+public:
+    GameTimer(BitmapFont &font, int minutes, const SimulationClock &simulationClock)
+        : clock(simulationClock)
+    {
+        totalSeconds = minutes * 60;
+        shownSeconds = -1;
+        display.setFont(font);
+        display.setCharacterSize(30);
+        display.setPosition(425, 30); // Centrado en la parte superior
 
-        // Inicializar la lógica del juego
-        leftScore = 0;
-        rightScore = 0;
-        doublePointsActive = false;
-        lessPointsActive = false;
-        freezeLeftActive = false;
-        freezeRightActive = false;
-        invisibleLeftActive = false;
-        invisibleRightActive = false;
-        biggerLeftActive = false;
-        biggerRightActive = false;
-        barrierLeftActive = false;
-        barrierRightActive = false;
-        smallerLeftActive = false;
-        smallerRightActive = false;
+        timeText = "00:00";
+        updateDisplay();
+    }
 
-        // Configurar las barreras
-        leftBarrier.setSize(Vector2f(10, 100));
-        leftBarrier.setFillColor(Color(255, 0, 0, 128)); // Rojo semi-transparente
-        leftBarrier.setPosition(100, 225);
+    // Devuelve true si el texto cambió (solo ocurre una vez por segundo)
+    bool updateDisplay()
+    {
+        int remainingSeconds = totalSeconds - (int)clock.getElapsedSeconds();
+        if (remainingSeconds < 0)
+            remainingSeconds = 0;
 
-        rightBarrier.setSize(Vector2f(10, 100));
-        rightBarrier.setFillColor(Color(255, 0, 0, 128)); // Rojo semi-transparente
-        rightBarrier.setPosition(740, 225);
+        if (remainingSeconds == shownSeconds)
+            return false;
+        shownSeconds = remainingSeconds;
 
-        rightBarrier.setSize(Vector2f(10, 100));
-        rightBarrier.setFillColor(Color(255, 0, 0, 128)); // Rojo semi-transparente
-        rightBarrier.setPosition(740, 225);
-        updateScoreDisplay();
+        int minutes = remainingSeconds / 60;
+        int seconds = remainingSeconds % 60;
 
-        // Crear el temporizador (3 minutos por defecto)
-        timer = new GameTimer(font, 3);
+        timeText[0] = '0' + minutes / 10 % 10;
+        timeText[1] = '0' + minutes % 10;
+        timeText[3] = '0' + seconds / 10;
+        timeText[4] = '0' + seconds % 10;
+        display.setString(timeText);
 
-        // Configuraciones por defecto
-        gameMode = PLAYER_VS_AI;
-        maxScore = 7;
-        powerUpsEnabled = true;
+        // Actualizar el origen para mantenerlo centrado cuando cambia el texto
+        display.setOrigin(display.getLocalBounds().width / 2, 0);
+        return true;
     }
 
-    ~Game()
+    float getRemainingFraction()
     {
-        delete timer;
-        delete menu;
+        float remaining = 1.0f - clock.getElapsedSeconds() / totalSeconds;
+        return max(0.0f, remaining);
     }
 
-    void run()
+    bool isTimeUp()
     {
-        while (window.isOpen())
-        {
-            handleEvents();
-            update();
-            render();
-        }
+        return clock.getElapsedSeconds() >= totalSeconds;
     }
 
-private:
-    void handleEvents()
+    void reset()
     {
-        Event event;
-        while (window.pollEvent(event))
-        {
-            if (event.type == Event::Closed)
-            {
-                window.close();
-            }
+        clock.restart();
+    }
 
-            if (event.type == Event::KeyPressed)
-            {
-                if (state == MENU)
-                {
-                    handleMenuInput(event.key.code);
-                }
-                else if (state == PLAYING)
-                {
-                    if (event.key.code == Keyboard::Escape)
-                    {
-                        state = PAUSED;
-                        // Resetear la selección al pausar
-                        selectedPauseOption = 0;
-                        // Actualizar colores de las opciones
-                        for (auto &option : pauseMenuOptions)
-                        {
-                            option.setFillColor(Color::White);
-                        }
-                        pauseMenuOptions[selectedPauseOption].setFillColor(Color::Yellow);
-                    }
-                }
-                else if (state == PAUSED)
-                {
-                    switch (event.key.code)
-                    {
-                    case Keyboard::Escape:
-                        // Volver al juego al presionar Escape nuevamente
-                        state = PLAYING;
-                        break;
+    BitmapText &getDisplay() { return display; }
+};
 
-                    case Keyboard::Up:
-                        // Navegar hacia arriba en el menú
-                        pauseMenuOptions[selectedPauseOption].setFillColor(Color::White);
-                        selectedPauseOption = (selectedPauseOption - 1 + pauseMenuOptions.size()) % pauseMenuOptions.size();
-                        pauseMenuOptions[selectedPauseOption].setFillColor(Color::Yellow);
-                        break;
+const int MAX_GAME_DURATION_MINUTES = 10; // tope de la duración en el menú de opciones
 
-                    case Keyboard::Down:
-                        // Navegar hacia abajo en el menú
-                        pauseMenuOptions[selectedPauseOption].setFillColor(Color::White);
-                        selectedPauseOption = (selectedPauseOption + 1) % pauseMenuOptions.size();
-                        pauseMenuOptions[selectedPauseOption].setFillColor(Color::Yellow);
-                        break;
+// Clase para el menú
+class Menu
+{
+private:
+    vector<BitmapText> options;
+    int selectedOption;
+    BitmapFont &font;
 
-                    case Keyboard::Return:
-                        // Seleccionar opción
-                        handlePauseMenuSelection();
-                        break;
-                    }
-                }
-                else if (state == GAME_OVER)
-                {
-                    if (event.key.code == Keyboard::R)
-                    {
-                        resetGame();
-                        state = PLAYING;
-                    }
-                    else if (event.key.code == Keyboard::M)
-                    {
-                        state = MENU;
-                    }
-                }
-            }
-        }
+    // Configuraciones del juego
+    GameMode gameMode;
+    AILevel aiLevel1;
+    AILevel aiLevel2;
+    int gameDuration; // en minutos
+    int maxScore;
+    bool powerUpsEnabled;
+    float initialBallSpeed;
+
+public:
+    Menu(BitmapFont &f) : font(f)
+    {
+        selectedOption = 0;
+
+        // Valores por defecto
+        gameMode = PLAYER_VS_AI;
+        aiLevel1 = MEDIUM;
+        aiLevel2 = MEDIUM;
+        gameDuration = 3;
+        maxScore = 7;
+        powerUpsEnabled = true;
+        initialBallSpeed = 3.0f;
+
+        // Crear opciones del menú
+        createMenuOptions();
     }
 
-    void handlePauseMenuSelection()
+    void createMenuOptions()
     {
-        switch (selectedPauseOption)
-        {
-        case 0: // Continuar
-            state = PLAYING;
-            break;
+        options.clear();
 
-        case 1: // Volver al menú
-            state = MENU;
-            break;
+        // Título
+        BitmapText title("PONG 2.0", font, 50);
 
-        case 2: // Salir
-            window.close();
-            break;
-        }
+        // Centrar el texto horizontalmente
+        FloatRect textBounds = title.getLocalBounds();
+        title.setOrigin(textBounds.left + textBounds.width / 2.0f, textBounds.top); // Centra horizontalmente el origen
+        title.setPosition(FIELD_WIDTH / 2.0f, 50);                                          // Posición centrada en X, Y fija
+
+        options.push_back(title);
+
+        // Opciones principales
+        addOption("Player vs IA", 200);
+        addOption("2 Player", 250);
+        addOption("IA vs IA", 300);
+        addOption("Opciones", 350);
+        addOption("Salir", 400);
+
+        // Resaltar la opción seleccionada
+        options[selectedOption + 1].setFillColor(Color::Yellow);
     }
 
-    void handleMenuInput(Keyboard::Key key)
+    void addOption(const std::string &text, float y)
     {
-        if (key == Keyboard::Up)
-        {
-            menu->moveUp();
-        }
-        else if (key == Keyboard::Down)
-        {
-            menu->moveDown();
-        }
-        else if (key == Keyboard::Return)
-        {
-            int option = menu->getSelectedOption();
-            switch (option)
-            {
-            case 0: // Un Jugador vs IA
-                // En lugar de iniciar el juego directamente, mostrar submenú de dificultad
-                showAIDifficultyMenu();
-                break;
-            case 1: // Dos Jugadores
-                gameMode = PLAYER_VS_PLAYER;
-                leftPaddle.setIsAI(false);
-                rightPaddle.setIsAI(false);
-                resetGame();
-                state = PLAYING;
-                break;
-            case 2: // IA vs IA
-                gameMode = AI_VS_AI;
-                leftPaddle.setIsAI(true);
-                rightPaddle.setIsAI(true);
-                leftPaddle.setAILevel(menu->getAILevel1());
-                rightPaddle.setAILevel(menu->getAILevel2());
-                resetGame();
-                state = PLAYING;
-                break;
-            case 3: // Opciones
-                // Mostrar menú de opciones
-                showOptionsMenu();
-                break;
-            case 4: // Salir
-                window.close();
-                break;
-            }
-        }
+        BitmapText option(text, font, 30);
+        FloatRect bounds = option.getLocalBounds();
+        option.setOrigin(bounds.left + bounds.width / 2.0f, bounds.top); // Centra horizontalmente
+        option.setPosition(FIELD_WIDTH / 2.0f, y);                               // Centra en X
+        options.push_back(option);
     }
 
-    void update()
+    void moveUp()
     {
-        if (state == PLAYING)
-        {
-            // Actualizar temporizador
-            timer->updateDisplay();
+        options[selectedOption + 1].setFillColor(Color::White);
+        selectedOption = (selectedOption - 1 + 5) % 5; // 5 opciones en total
+        options[selectedOption + 1].setFillColor(Color::Yellow);
+    }
 
-            // Verificar condiciones de fin de juego
-            if (timer->isTimeUp() || leftScore >= maxScore || rightScore >= maxScore)
-            {
-                // Configurar el texto de game over
-                gameOverText.setFont(font);
-                gameOverText.setString(leftScore > rightScore ? "JUGADOR 1 GANA!" : (rightScore > leftScore ? "JUGADOR 2 GANA!" : "EMPATE!"));
-                gameOverText.setCharacterSize(30); // Tamaño más pequeño
+    void moveDown()
+    {
+        options[selectedOption + 1].setFillColor(Color::White);
+        selectedOption = (selectedOption + 1) % 5; // 5 opciones en total
+        options[selectedOption + 1].setFillColor(Color::Yellow);
+    }
 
-                // Centrar el texto horizontalmente y verticalmente
-                FloatRect textBounds = gameOverText.getLocalBounds();
-                gameOverText.setOrigin(textBounds.left + textBounds.width / 2.0f, textBounds.top + textBounds.height / 2.0f);
-                gameOverText.setPosition(425, 200); // Posicionado más arriba en la pantalla
+    int getSelectedOption()
+    {
+        return selectedOption;
+    }
 
-                state = GAME_OVER;
-                return;
-            }
+    void draw(RenderWindow &window)
+    {
+        for (const auto &option : options)
+        {
+            window.draw(option);
+        }
+    }
 
-            // Verificar si los efectos de power-up han expirado
-            if (freezeLeftActive && freezeTimerLeft.getElapsedTime().asSeconds() >= 5.0f)
-            {
-                freezeLeftActive = false;
-            }
+    // Getters y setters para las configuraciones
+    GameMode getGameMode() { return gameMode; }
+    void setGameMode(GameMode mode) { gameMode = mode; }
 
-            if (freezeRightActive && freezeTimerRight.getElapsedTime().asSeconds() >= 5.0f)
-            {
-                freezeRightActive = false;
-            }
+    AILevel getAILevel1() { return aiLevel1; }
+    void setAILevel1(AILevel level) { aiLevel1 = level; }
 
-            if (doublePointsActive && doublePointsTimer.getElapsedTime().asSeconds() >= 5.0f)
-            {
-                doublePointsActive = false;
-            }
+    AILevel getAILevel2() { return aiLevel2; }
+    void setAILevel2(AILevel level) { aiLevel2 = level; }
 
-            if (lessPointsActive && lessPointsTimer.getElapsedTime().asSeconds() >= 5.0f)
-            {
-                lessPointsActive = false;
-            }
+    int getGameDuration() { return gameDuration; }
+    void setGameDuration(int minutes) { gameDuration = minutes; }
 
-            // Verificar si el efecto de barrera ha expirado
-            if (barrierLeftActive && barrierTimerLeft.getElapsedTime().asSeconds() >= 5.0f)
-            {
-                barrierLeftActive = false;
-            }
+    int getMaxScore() { return maxScore; }
+    void setMaxScore(int score) { maxScore = score; }
 
-            if (barrierRightActive && barrierTimerRight.getElapsedTime().asSeconds() >= 5.0f)
-            {
-                barrierRightActive = false;
-            }
+    bool arePowerUpsEnabled() { return powerUpsEnabled; }
+    void setPowerUpsEnabled(bool enabled) { powerUpsEnabled = enabled; }
 
-            // Verificar si el efecto de paleta más pequeña ha expirado
-            if (smallerLeftActive && smallerTimerLeft.getElapsedTime().asSeconds() >= 5.0f)
-            {
-                smallerLeftActive = false;
-                leftPaddle.resetSize();
-            }
+    float getInitialBallSpeed() { return initialBallSpeed; }
+    void setInitialBallSpeed(float speed) { initialBallSpeed = speed; }
+};
 
-            if (smallerRightActive && smallerTimerRight.getElapsedTime().asSeconds() >= 5.0f)
-            {
-                smallerRightActive = false;
-                rightPaddle.resetSize();
-            }
+// Eventos que publica la simulación. Los efectos (partículas, sonido, telemetría, interfaz)
+// no se ejecutan dentro del tick: cada consumidor tiene su propia cola y la procesa en su
+// fase o en su hilo, así el costo del tick no depende de cuántos consumidores haya.
+enum MatchEventType
+{
+    EVENT_MATCH_START,       // value1: puntaje máximo, detail: power-ups activados
+    EVENT_RALLY_START,       // x, y: pelota; value1, value2: velocidad de saque
+    EVENT_PADDLE_HIT,        // side: paleta; value1: velocidad de la pelota, value2: punto de contacto en [-1, 1]
+    EVENT_BARRIER_HIT,       // side: barrera
+    EVENT_WALL_BOUNCE,       // side: 0 arriba, 1 abajo
+    EVENT_GOAL,              // side: quien anota; value1: puntos, detail: bit 0 doble puntos, bit 1 menos puntos
+    EVENT_POWERUP_SPAWN,     // detail: PowerUpType
+    EVENT_POWERUP_COLLECTED, // detail: PowerUpType, side: beneficiario
+    EVENT_EFFECT_EXPIRED     // detail: PowerUpType, side: beneficiario
+};
 
-            // Actualizar pelotas
-            updateBalls();
+const Uint8 SIDE_LEFT = 0;
+const Uint8 SIDE_RIGHT = 1;
+const Uint8 SIDE_NONE = 255;
+
+struct MatchEvent
+{
+    Uint32 tick;
+    Uint8 type;
+    Uint8 side;
+    Uint8 detail;
+    Uint8 reserved;
+    float x, y; // posición donde ocurrió
+    float value1;
+    float value2;
+};
 
-            // Actualizar paletas
-            updatePaddles();
+// Cola acotada de un productor (la simulación) y un consumidor, sin bloqueos. Si el
+// consumidor se atrasa y la cola se llena, el evento se descarta y se cuenta.
+class MatchEventQueue
+{
+private:
+    static const unsigned int CAPACITY = 1024; // potencia de dos
 
-            // Manejar colisiones
-            handleCollisions();
+    MatchEvent events[CAPACITY];
+    atomic<unsigned int> head; // próximo a escribir (solo el productor)
+    atomic<unsigned int> tail; // próximo a leer (solo el consumidor)
+    unsigned int dropped;
 
-            // Generar power-ups
-            if (powerUpsEnabled && powerUpSpawnTimer.getElapsedTime().asSeconds() > 10)
-            { // Cada 10 segundos
-                spawnPowerUp();
-                powerUpSpawnTimer.restart();
-            }
+public:
+    MatchEventQueue() : head(0), tail(0), dropped(0) {}
 
-            // Actualizar power-ups
-            updatePowerUps();
+    bool push(const MatchEvent &event)
+    {
+        unsigned int position = head.load(memory_order_relaxed);
+        if (position - tail.load(memory_order_acquire) >= CAPACITY)
+        {
+            dropped++;
+            return false;
         }
+        events[position % CAPACITY] = event;
+        head.store(position + 1, memory_order_release);
+        return true;
     }
 
-    void updateBalls()
+    bool pop(MatchEvent &event)
     {
-        bool goalScored = false;
+        unsigned int position = tail.load(memory_order_relaxed);
+        if (position == head.load(memory_order_acquire))
+            return false;
+        event = events[position % CAPACITY];
+        tail.store(position + 1, memory_order_release);
+        return true;
+    }
 
-        // Actualizar posición de las pelotas
-        for (auto &ball : balls)
-        {
-            ball.updateFlashing(); // Actualizar estado de parpadeo
+    unsigned int getDropped() const { return dropped; }
+};
 
-            if (!ball.isActive())
-                continue;
+// Cantidad de núcleos disponibles para repartir simulaciones sin ventana
+int getCpuCount()
+{
+#ifdef _WIN32
+    const char *processors = getenv("NUMBER_OF_PROCESSORS");
+    int count = processors ? atoi(processors) : 1;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return max(1, count);
+}
 
-            ball.update();
+// Tiempo de CPU consumido por todo el proceso (todos los hilos), en microsegundos
+Int64 getProcessCpuMicroseconds()
+{
+#ifdef _WIN32
+    FILETIME creation, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exited, &kernel, &user))
+        return 0;
+    ULARGE_INTEGER kernelTime, userTime;
+    kernelTime.LowPart = kernel.dwLowDateTime;
+    kernelTime.HighPart = kernel.dwHighDateTime;
+    userTime.LowPart = user.dwLowDateTime;
+    userTime.HighPart = user.dwHighDateTime;
+    return (Int64)((kernelTime.QuadPart + userTime.QuadPart) / 10); // unidades de 100 ns
+#else
+    timespec now;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now) != 0)
+        return 0;
+    return (Int64)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+}
 
-            // Comprobar colisiones con las paletas
-            if (rightPaddle.getSprite().getGlobalBounds().contains(ball.getPosition()))
-            {
-                ball.reverseX();
-                ball.accelerate();
-            }
-            else if (leftPaddle.getSprite().getGlobalBounds().contains(ball.getPosition()))
-            {
-                ball.reverseX();
-                ball.accelerate();
-            }
-            // Comprobar colisiones con las barreras
-            else if (barrierLeftActive && leftBarrier.getGlobalBounds().contains(ball.getPosition()))
-            {
-                ball.reverseX();
-            }
-            else if (barrierRightActive && rightBarrier.getGlobalBounds().contains(ball.getPosition()))
-            {
-                ball.reverseX();
-            }
+// Reloj monótono en nanosegundos, el mismo para todos los procesos de la máquina (las
+// latencias entre el juego y los bots se miden con marcas de los dos lados)
+Int64 getMonotonicNanoseconds()
+{
+#ifdef _WIN32
+    static LARGE_INTEGER frequency = {};
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (Int64)(counter.QuadPart / frequency.QuadPart * 1000000000 + counter.QuadPart % frequency.QuadPart * 1000000000 / frequency.QuadPart);
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (Int64)now.tv_sec * 1000000000 + now.tv_nsec;
+#endif
+}
 
-            // Comprobar colisiones con los bordes superior e inferior
-            Vector2f pos = ball.getPosition();
-            FloatRect ballBounds = ball.getSprite().getGlobalBounds();
-            if (pos.y < 70 + ballBounds.height / 2 || pos.y > 550 - ballBounds.height / 2)
-            {
-                ball.reverseY();
-            }
+// Una tarea del sistema de trabajos: el rango [begin, end) de un parallelFor
+struct Job
+{
+    void (*function)(void *data, int begin, int end);
+    void *data;
+    int begin;
+    int end;
+    atomic<int> *pending; // tareas sin terminar del parallelFor que la creó
+};
 
-            // Comprobar si ha salido por los lados (gol)
-            if (pos.x < 0)
-            {
-                // Gol para el jugador derecho
-                if (doublePointsActive)
-                {
-                    rightScore += 2;
-                }
-                else if (lessPointsActive)
-                {
-                    rightScore += 0; // No dar puntos
-                }
-                else
-                {
-                    rightScore++;
-                }
-                updateScoreDisplay();
-                goalScored = true;
-                doublePointsActive = false;
-                lessPointsActive = false;
-                ball.reset();
+// Cola de tareas de un hilo. El dueño agrega y toma por atrás (la tarea más reciente,
+// todavía en caché); los demás hilos roban por adelante. Capacidad fija, sin reservas.
+class JobDeque
+{
+private:
+    static const int CAPACITY = 1024;
+    Job jobs[CAPACITY];
+    int head; // próxima tarea a robar
+    int tail; // próxima posición libre
+    Mutex mutex;
 
-                // No necesitamos comprobar victoria aquí, se hace en update()
+public:
+    JobDeque() : head(0), tail(0) {}
 
-                break; // Salir del bucle para evitar más procesamiento
-            }
-            else if (pos.x > 850)
-            {
-                // Gol para el jugador izquierdo
-                if (doublePointsActive)
-                {
-                    leftScore += 2;
-                }
-                else if (lessPointsActive)
-                {
-                    leftScore += 0; // No dar puntos
-                }
-                else
-                {
-                    leftScore++;
-                }
-                updateScoreDisplay();
-                goalScored = true;
-                doublePointsActive = false;
-                lessPointsActive = false;
-                ball.reset();
+    bool push(const Job &job)
+    {
+        Lock lock(mutex);
+        if (tail - head == CAPACITY)
+            return false;
+        jobs[tail % CAPACITY] = job;
+        tail++;
+        return true;
+    }
 
-                // No necesitamos comprobar victoria aquí, se hace en update()
+    bool pop(Job &job)
+    {
+        Lock lock(mutex);
+        if (tail == head)
+            return false;
+        tail--;
+        job = jobs[tail % CAPACITY];
+        if (tail == head)
+            head = tail = 0;
+        return true;
+    }
 
-                break; // Salir del bucle para evitar más procesamiento
-            }
-        }
+    bool steal(Job &job)
+    {
+        Lock lock(mutex);
+        if (tail == head)
+            return false;
+        job = jobs[head % CAPACITY];
+        head++;
+        return true;
+    }
+};
 
-        // Si se anotó un gol, reiniciar todas las pelotas
-        if (goalScored)
-        {
-            balls.clear();
-            Ball newBall(ballTexture);
-            newBall.reset();         // Asegurarse de que la pelota tenga una velocidad inicial
-            newBall.setActive(true); // Asegurar que esté visible
-            balls.push_back(newBall);
-            return;
-        }
+// Semáforo contador donde duermen los hilos de trabajo sin tareas. SFML no tiene variables
+// de condición, así que se usa el del sistema.
+class JobSemaphore
+{
+private:
+#ifdef _WIN32
+    HANDLE handle;
+#else
+    sem_t semaphore;
+#endif
 
-        // Eliminar pelotas inactivas
-        balls.erase(
-            remove_if(balls.begin(), balls.end(), [](const Ball &b)
-                      { return !b.isActive(); }),
-            balls.end());
+public:
+    JobSemaphore()
+    {
+#ifdef _WIN32
+        handle = CreateSemaphoreA(nullptr, 0, LONG_MAX, nullptr);
+#else
+        sem_init(&semaphore, 0, 0);
+#endif
     }
 
-    void updatePaddles()
+    ~JobSemaphore()
     {
-        // Actualizar congelamiento
-        if (freezeLeftActive && freezeTimerLeft.getElapsedTime().asSeconds() > 5.0f) // 5 segundos
+#ifdef _WIN32
+        CloseHandle(handle);
+#else
+        sem_destroy(&semaphore);
+#endif
+    }
+
+    // Despierta hasta count hilos (los permisos que sobran quedan para la próxima espera)
+    void post(int count)
+    {
+        if (count <= 0)
+            return;
+#ifdef _WIN32
+        ReleaseSemaphore(handle, count, nullptr);
+#else
+        for (int i = 0; i < count; i++)
+            sem_post(&semaphore);
+#endif
+    }
+
+    void wait()
+    {
+#ifdef _WIN32
+        WaitForSingleObject(handle, INFINITE);
+#else
+        while (sem_wait(&semaphore) != 0 && errno == EINTR)
         {
-            freezeLeftActive = false;
         }
-        if (freezeRightActive && freezeTimerRight.getElapsedTime().asSeconds() > 5.0f)
+#endif
+    }
+};
+
+thread_local int jobWorkerIndex = 0; // cola propia del hilo; el hilo principal usa la 0
+
+// Planificador con robo de trabajo para paralelizar partes independientes de un frame.
+// El hilo que llama a parallelFor reparte el rango en tareas en su propia cola, ejecuta la
+// primera y, hasta que terminan todas, sigue tomando tareas de su cola o robando de las
+// demás; los hilos de trabajo hacen lo mismo con sus colas. Al volver de parallelFor el
+// rango completo está hecho (es el punto de unión).
+class JobSystem
+{
+private:
+    int threadCount; // hilos de trabajo más el principal
+    vector<JobDeque *> deques;
+    vector<Thread *> workers;
+    atomic<int> nextWorkerIndex;
+    atomic<bool> stopping;
+    JobSemaphore wakeUp; // parallelFor lo señala al encolar tareas
+
+    template <typename Function>
+    static void invoke(void *data, int begin, int end)
+    {
+        (*static_cast<Function *>(data))(begin, end);
+    }
+
+    // Ejecuta una tarea propia o robada; false si no había ninguna
+    bool runOne(int index)
+    {
+        Job job;
+        bool found = deques[index]->pop(job);
+        for (int offset = 1; offset < threadCount && !found; offset++)
         {
-            freezeRightActive = false;
+            found = deques[(index + offset) % threadCount]->steal(job);
         }
-        // Actualizar invisibilidad
-        if (invisibleLeftActive && invisibleTimerLeft.getElapsedTime().asSeconds() > 5.0f) // 5 segundos
+        if (!found)
+            return false;
+
+        job.function(job.data, job.begin, job.end);
+        (*job.pending)--;
+        return true;
+    }
+
+    void worker()
+    {
+        jobWorkerIndex = nextWorkerIndex++;
+        while (!stopping)
         {
-            invisibleLeftActive = false;
-            leftPaddle.getSprite().setColor(Color(255, 255, 255, 255));
+            // Sin tareas en ninguna cola, el hilo duerme hasta el próximo parallelFor
+            if (!runOne(jobWorkerIndex))
+                wakeUp.wait();
         }
-        if (invisibleRightActive && invisibleTimerRight.getElapsedTime().asSeconds() > 5.0f)
+    }
+
+public:
+    explicit JobSystem(int threads) : threadCount(max(1, threads)), nextWorkerIndex(1), stopping(false)
+    {
+        for (int i = 0; i < threadCount; i++)
         {
-            invisibleRightActive = false;
-            rightPaddle.getSprite().setColor(Color(255, 255, 255, 255));
+            deques.push_back(new JobDeque());
         }
-        // Actualizar efecto de paleta más grande
-        if (biggerLeftActive && biggerTimerLeft.getElapsedTime().asSeconds() > 5.0f) // 5 segundos de duración
+        for (int i = 1; i < threadCount; i++)
         {
-            biggerLeftActive = false;
-            leftPaddle.resetSize();
+            workers.push_back(new Thread(&JobSystem::worker, this));
+            workers.back()->launch();
         }
-        if (biggerRightActive && biggerTimerRight.getElapsedTime().asSeconds() > 5.0f)
+    }
+
+    ~JobSystem()
+    {
+        stopping = true;
+        wakeUp.post((int)workers.size());
+        for (Thread *thread : workers)
         {
-            biggerRightActive = false;
-            rightPaddle.resetSize();
+            thread->wait();
+            delete thread;
         }
-        // Actualizar barreras
-        if (barrierLeftActive && barrierTimerLeft.getElapsedTime().asSeconds() > 5.0f) // 5 segundos
+        for (JobDeque *deque : deques)
         {
-            barrierLeftActive = false;
+            delete deque;
         }
-        if (barrierRightActive && barrierTimerRight.getElapsedTime().asSeconds() > 5.0f)
+    }
+
+    int getThreadCount() const { return threadCount; }
+
+    // Llama a function(begin, end) sobre [0, count) en tramos de hasta grain elementos,
+    // repartidos entre todos los hilos, y vuelve cuando terminaron todos
+    template <typename Function>
+    void parallelFor(int count, int grain, Function &function)
+    {
+        grain = max(1, grain);
+        if (count <= grain || threadCount == 1)
         {
-            barrierRightActive = false;
+            if (count > 0)
+                function(0, count);
+            return;
         }
 
-        // Controlar paleta izquierda (jugador 1 o IA)
-        if (!leftPaddle.getIsAI() && !freezeLeftActive)
+        int index = jobWorkerIndex;
+        atomic<int> pending(0);
+        int queued = 0;
+        for (int begin = grain; begin < count; begin += grain)
         {
-            if (Keyboard::isKeyPressed(Keyboard::W))
+            Job job = {&JobSystem::invoke<Function>, &function, begin, min(count, begin + grain), &pending};
+            pending++;
+            if (deques[index]->push(job))
             {
-                leftPaddle.move(-leftPaddle.getSpeed());
+                // Despertar un hilo por tarea, sin pasar de los que hay
+                if (queued++ < (int)workers.size())
+                    wakeUp.post(1);
             }
-            if (Keyboard::isKeyPressed(Keyboard::S))
+            else
             {
-                leftPaddle.move(leftPaddle.getSpeed());
+                // Cola llena: se hace aquí mismo
+                pending--;
+                function(job.begin, job.end);
             }
         }
-        else if (leftPaddle.getIsAI())
+
+        function(0, grain);
+        while (pending > 0)
         {
-            leftPaddle.update(balls, true);
+            if (!runOne(index))
+                sleep(Time::Zero);
         }
+    }
+};
 
-        else
+// Sistema de partículas para golpes, rebotes, goles y power-ups. Los datos se guardan
+// en arreglos separados por campo (SoA) con capacidad fija reservada al inicio, así
+// emitir una partícula nunca reserva memoria y la actualización recorre memoria contigua.
+class ParticleSystem
+{
+private:
+    int capacity;
+    int count;
+
+    vector<float> posX;
+    vector<float> posY;
+    vector<float> velX;
+    vector<float> velY;
+    vector<float> life;       // segundos restantes
+    vector<float> invMaxLife; // 1 / vida inicial, para calcular el desvanecimiento
+    vector<Color> color;
+
+    vector<Vertex> vertices; // 4 vértices por partícula, se dibujan en una sola llamada
+
+    unsigned int seed; // generador propio para no alterar la secuencia aleatoria del partido
+
+    float drag;    // factor de frenado por segundo
+    float gravity; // píxeles/s²
+    float size;    // lado del cuadrado en píxeles
+
+    // Con un sistema de trabajos, la integración y los vértices se reparten en tramos entre los hilos
+    static const int JOB_GRAIN = 4096;
+    JobSystem *jobs;
+
+    float random01()
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return (seed & 0xFFFFFF) / (float)0x1000000;
+    }
+
+public:
+    ParticleSystem(int maxParticles = 65536) : capacity(maxParticles), count(0), seed(2463534242u), jobs(nullptr)
+    {
+        posX.resize(capacity);
+        posY.resize(capacity);
+        velX.resize(capacity);
+        velY.resize(capacity);
+        life.resize(capacity);
+        invMaxLife.resize(capacity);
+        color.resize(capacity);
+        vertices.resize(capacity * 4);
+
+        drag = 0.05f;
+        gravity = 120.0f;
+        size = 3.0f;
+    }
+
+    // Emite una ráfaga de partículas en todas direcciones. Si el pool está lleno
+    // se descartan las partículas que no caben.
+    void burst(Vector2f position, int amount, Color c, float speed = 150.0f, float lifetime = 0.6f)
+    {
+        for (int n = 0; n < amount && count < capacity; n++)
         {
-            leftPaddle.update(balls, true);
+            float angle = random01() * 6.2831853f;
+            float magnitude = speed * (0.3f + 0.7f * random01());
+            float lifeTime = lifetime * (0.5f + 0.5f * random01());
+
+            posX[count] = position.x;
+            posY[count] = position.y;
+            velX[count] = cos(angle) * magnitude;
+            velY[count] = sin(angle) * magnitude;
+            life[count] = lifeTime;
+            invMaxLife[count] = 1.0f / lifeTime;
+            color[count] = c;
+            count++;
         }
+    }
 
-        // Controlar paleta derecha (jugador 2 o IA)
-        if (!rightPaddle.getIsAI() && !freezeRightActive)
+    // Convierte los eventos de la simulación en ráfagas
+    void consume(MatchEventQueue &queue)
+    {
+        MatchEvent event;
+        while (queue.pop(event))
         {
-            if (Keyboard::isKeyPressed(Keyboard::Up))
+            Vector2f position(event.x, event.y);
+            switch (event.type)
             {
-                rightPaddle.move(-rightPaddle.getSpeed());
+            case EVENT_PADDLE_HIT:
+                burst(position, 40, Color::White);
+                break;
+            case EVENT_BARRIER_HIT:
+                // Mismos colores que aplica el power-up BARRIER
+                burst(position, 30, event.side == SIDE_LEFT ? Color(100, 100, 255, 150) : Color(255, 100, 100, 150));
+                break;
+            case EVENT_WALL_BOUNCE:
+                burst(position, 12, Color(180, 180, 180), 90.0f, 0.4f);
+                break;
+            case EVENT_GOAL:
+                burst(Vector2f(max(0.0f, min((float)FIELD_WIDTH, event.x)), event.y), 300, Color::Yellow, 300.0f, 1.2f);
+                break;
+            case EVENT_POWERUP_COLLECTED:
+                burst(position, 120, Color(255, 200, 0), 200.0f, 0.9f);
+                break;
             }
-            if (Keyboard::isKeyPressed(Keyboard::Down))
+        }
+    }
+
+    void setJobSystem(JobSystem *jobSystem) { jobs = jobSystem; }
+
+    void update(float dt)
+    {
+        float damping = pow(drag, dt);
+        float gravityStep = gravity * dt;
+
+        // Cada partícula se integra por separado; la compactación de abajo es secuencial
+        auto integrateRange = [&](int begin, int end) { integrate(begin, end, dt, damping, gravityStep); };
+        if (jobs)
+            jobs->parallelFor(count, JOB_GRAIN, integrateRange);
+        else
+            integrateRange(0, count);
+
+        float *px = &posX[0];
+        float *py = &posY[0];
+        float *vx = &velX[0];
+        float *vy = &velY[0];
+        float *lf = &life[0];
+
+        // Compactar: las partículas muertas se reemplazan por la última viva
+        int i = 0;
+        while (i < count)
+        {
+            if (lf[i] > 0.0f)
             {
-                rightPaddle.move(rightPaddle.getSpeed());
+                i++;
+                continue;
             }
+            count--;
+            px[i] = px[count];
+            py[i] = py[count];
+            vx[i] = vx[count];
+            vy[i] = vy[count];
+            lf[i] = lf[count];
+            invMaxLife[i] = invMaxLife[count];
+            color[i] = color[count];
         }
-        else if (rightPaddle.getIsAI())
+    }
+
+    // Integra las partículas [begin, end)
+    void integrate(int begin, int end, float dt, float damping, float gravityStep)
+    {
+        float *px = &posX[0];
+        float *py = &posY[0];
+        float *vx = &velX[0];
+        float *vy = &velY[0];
+        float *lf = &life[0];
+
+        int i = begin;
+#ifdef PONG_SIMD_PARTICLES
+        // Núcleo vectorizado: 4 partículas por iteración
+        const __m128 vDamping = _mm_set1_ps(damping);
+        const __m128 vGravity = _mm_set1_ps(gravityStep);
+        const __m128 vDt = _mm_set1_ps(dt);
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(px + i);
+            __m128 y = _mm_loadu_ps(py + i);
+            __m128 velocityX = _mm_mul_ps(_mm_loadu_ps(vx + i), vDamping);
+            __m128 velocityY = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(vy + i), vDamping), vGravity);
+            _mm_storeu_ps(vx + i, velocityX);
+            _mm_storeu_ps(vy + i, velocityY);
+            _mm_storeu_ps(px + i, _mm_add_ps(x, _mm_mul_ps(velocityX, vDt)));
+            _mm_storeu_ps(py + i, _mm_add_ps(y, _mm_mul_ps(velocityY, vDt)));
+            _mm_storeu_ps(lf + i, _mm_sub_ps(_mm_loadu_ps(lf + i), vDt));
+        }
+#endif
+        for (; i < end; i++)
         {
-            rightPaddle.update(balls, false);
+            vx[i] *= damping;
+            vy[i] = vy[i] * damping + gravityStep;
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            lf[i] -= dt;
         }
     }
 
-    void spawnPowerUp()
+    // Rellena el arreglo de vértices con un cuadrado por partícula
+    void buildVertices()
     {
-        if (powerUps.size() >= 3)
-            return; // Máximo 3 power-ups a la vez
+        auto buildRange = [this](int begin, int end) { buildVertices(begin, end); };
+        if (jobs)
+            jobs->parallelFor(count, JOB_GRAIN, buildRange);
+        else
+            buildRange(0, count);
+    }
 
-        int typeIndex = rand() % 11; // Ahora son 9 tipos
-        PowerUpType type = static_cast<PowerUpType>(typeIndex);
+    void buildVertices(int begin, int end)
+    {
+        float half = size / 2;
+        for (int i = begin; i < end; i++)
+        {
+            Color c = color[i];
+            c.a = (Uint8)(255.0f * min(1.0f, life[i] * invMaxLife[i]));
+
+            Vertex *quad = &vertices[i * 4];
+            quad[0].position = Vector2f(posX[i] - half, posY[i] - half);
+            quad[1].position = Vector2f(posX[i] + half, posY[i] - half);
+            quad[2].position = Vector2f(posX[i] + half, posY[i] + half);
+            quad[3].position = Vector2f(posX[i] - half, posY[i] + half);
+            quad[0].color = c;
+            quad[1].color = c;
+            quad[2].color = c;
+            quad[3].color = c;
+        }
+    }
 
-        // Validar que LESS_POINTS solo salga si ambos tienen al menos 1 punto
-        if (type == LESS_POINTS && (leftScore < 1 || rightScore < 1))
+    void draw(RenderTarget &target)
+    {
+        if (count == 0)
+            return;
+        buildVertices();
+        target.draw(&vertices[0], count * 4, Quads);
+    }
+
+    void clear() { count = 0; }
+    int getCount() const { return count; }
+    int getCapacity() const { return capacity; }
+};
+
+// Banco de sonidos decodificados en memoria al inicio y un conjunto fijo de voces que se
+// reutilizan. La simulación solo encola disparos (sin reservar memoria ni bloquear); las
+// voces se inician en flush(), que se llama una vez por frame justo después de los ticks.
+class SoundBank
+{
+private:
+    static const int VOICE_COUNT = 8;
+    static const int MAX_PENDING = 32;
+
+    struct Voice
+    {
+        Sound sound;
+        int priority;
+        Int64 startTime;
+    };
+
+    struct Trigger
+    {
+        SoundEffect effect;
+        Int64 time;
+    };
+
+    SoundBuffer buffers[SOUND_COUNT];
+    int priorities[SOUND_COUNT];
+    Voice voices[VOICE_COUNT];
+
+    Trigger pending[MAX_PENDING];
+    int pendingCount;
+
+    Clock clock;
+
+    // Estadísticas de latencia entre el disparo y el inicio de la voz
+    Int64 latencyTotal;
+    Int64 latencyMax;
+    int played;
+    int dropped;
+
+    // Genera un tono corto con envolvente para cuando no existe el archivo .wav
+    void synthesize(SoundBuffer &buffer, float startFrequency, float endFrequency, float duration)
+    {
+        const unsigned int sampleRate = 44100;
+        vector<Int16> samples((size_t)(sampleRate * duration));
+        float phase = 0.0f;
+        for (size_t i = 0; i < samples.size(); i++)
         {
-            // No generar el LESS_POINTS, cambia el power-up a uno normal
-            type = static_cast<PowerUpType>(rand() % 10);
+            float t = (float)i / samples.size();
+            float frequency = startFrequency + (endFrequency - startFrequency) * t;
+            phase += 6.2831853f * frequency / sampleRate;
+            float envelope = (1.0f - t) * min(1.0f, i / 200.0f);
+            samples[i] = (Int16)(sin(phase) * envelope * 12000.0f);
         }
-        PowerUp newPowerUp(type, powerUpTextures[type]);
-        powerUps.push_back(newPowerUp);
+        buffer.loadFromSamples(&samples[0], samples.size(), 1, sampleRate);
     }
 
-    void updatePowerUps()
+    void load(SoundEffect effect, const string &name, int priority, float startFrequency, float endFrequency, float duration)
     {
-        for (auto &powerUp : powerUps)
+        priorities[effect] = priority;
+        if (!buffers[effect].loadFromFile("c:\\Pong\\sounds\\" + name + ".wav"))
         {
-            if (!powerUp.isActive())
-                continue;
+            synthesize(buffers[effect], startFrequency, endFrequency, duration);
+        }
+    }
 
-            powerUp.update();
+public:
+    SoundBank() : pendingCount(0), latencyTotal(0), latencyMax(0), played(0), dropped(0)
+    {
+        load(SOUND_PADDLE_HIT, "paddle", 1, 660.0f, 520.0f, 0.08f);
+        load(SOUND_WALL_BOUNCE, "wall", 0, 330.0f, 300.0f, 0.05f);
+        load(SOUND_GOAL, "goal", 3, 880.0f, 220.0f, 0.6f);
 
-            // Comprobar colisiones con las pelotas si no ha sido recogido
-            if (!powerUp.isCollected())
+        const char *powerUpNames[] = {"bigger", "smaller", "slow", "double_ball", "barrier", "invert",
+                                      "flashing", "double_points", "less_points", "freeze", "invisible"};
+        for (int i = 0; i <= INVISIBLE_OPPONENT; i++)
+        {
+            // Cada power-up suena con un barrido distinto
+            load(static_cast<SoundEffect>(SOUND_POWERUP + i), string("powerup_") + powerUpNames[i], 2,
+                 400.0f + i * 60.0f, 800.0f + i * 90.0f, 0.25f);
+        }
+
+        for (int i = 0; i < VOICE_COUNT; i++)
+        {
+            voices[i].priority = -1;
+            voices[i].startTime = 0;
+        }
+    }
+
+    // Encola los sonidos de los eventos de la simulación (se inician en flush)
+    void consume(MatchEventQueue &queue)
+    {
+        MatchEvent event;
+        while (queue.pop(event))
+        {
+            switch (event.type)
             {
-                for (auto &ball : balls)
-                {
-                    if (ball.isActive() && powerUp.getSprite().getGlobalBounds().contains(ball.getPosition()))
-                    {
-                        applyPowerUp(powerUp);
-                        powerUp.collect();
-                        break;
-                    }
-                }
+            case EVENT_PADDLE_HIT:
+            case EVENT_BARRIER_HIT:
+                trigger(SOUND_PADDLE_HIT);
+                break;
+            case EVENT_WALL_BOUNCE:
+                trigger(SOUND_WALL_BOUNCE);
+                break;
+            case EVENT_GOAL:
+                trigger(SOUND_GOAL);
+                break;
+            case EVENT_POWERUP_COLLECTED:
+                trigger(static_cast<SoundEffect>(SOUND_POWERUP + event.detail));
+                break;
             }
         }
-
-        // Eliminar power-ups inactivos
-        powerUps.erase(
-            remove_if(powerUps.begin(), powerUps.end(),
-                      [](const PowerUp &p)
-                      { return !p.isActive(); }),
-            powerUps.end());
     }
 
-    void applyPowerUp(PowerUp &powerUp)
+    // Solo copia el disparo en un arreglo fijo
+    void trigger(SoundEffect effect)
     {
-        bool isLeftPaddle = false;
-        if (!balls.empty() && balls[0].getVelocity().x > 0)
+        if (pendingCount == MAX_PENDING)
         {
-            isLeftPaddle = true;
+            dropped++;
+            return;
         }
+        pending[pendingCount].effect = effect;
+        pending[pendingCount].time = clock.getElapsedTime().asMicroseconds();
+        pendingCount++;
+    }
 
-        switch (powerUp.getType())
+    // Inicia las voces de los disparos pendientes. Si no hay voces libres se roba la de
+    // menor prioridad (la más antigua si empatan), nunca una de prioridad mayor.
+    void flush()
+    {
+        for (int p = 0; p < pendingCount; p++)
         {
-        case BIGGER_PADDLE:
-            // Determinar qué jugador recibe el power-up (el que golpeó la pelota)
-            if (isLeftPaddle)
-            {
-                leftPaddle.setSize(1.5f); // Aumentar tamaño en un 50%
-                biggerLeftActive = true;
-                biggerTimerLeft.restart();
-            }
-            else
+            SoundEffect effect = pending[p].effect;
+            int priority = priorities[effect];
+
+            int chosen = -1;
+            for (int i = 0; i < VOICE_COUNT; i++)
             {
-                rightPaddle.setSize(1.5f);
-                biggerRightActive = true;
-                biggerTimerRight.restart();
+                if (voices[i].sound.getStatus() == Sound::Stopped)
+                {
+                    chosen = i;
+                    break;
+                }
+                if (voices[i].priority <= priority &&
+                    (chosen == -1 || voices[i].priority < voices[chosen].priority ||
+                     (voices[i].priority == voices[chosen].priority && voices[i].startTime < voices[chosen].startTime)))
+                {
+                    chosen = i;
+                }
             }
-            break;
-        case SMALLER_OPPONENT:
-            if (isLeftPaddle)
+
+            if (chosen == -1)
             {
-                // Si el jugador izquierdo recoge el power-up, la paleta derecha se hace más pequeña
-                rightPaddle.setSize(0.5f);
-                smallerRightActive = true;
-                smallerTimerRight.restart();
+                dropped++;
+                continue;
             }
-            else
-            {
-                // Si el jugador derecho recoge el power-up, la paleta izquierda se hace más pequeña
-                leftPaddle.setSize(0.5f);
-                smallerLeftActive = true;
-                smallerTimerLeft.restart();
-            }
-            break;
-        case SLOW_BALL:
-            for (auto &ball : balls)
-            {
-                ball.slowDown(0.7f); // Reducir velocidad en un 30%
-            }
-            break;
-        case DOUBLE_BALL:
-            if (balls.size() < 2)
-            {
-                balls.push_back(Ball(ballTexture));
-                balls.back().reset();
-            }
-            break;
-        case BARRIER:
-            // Crear una barrera para el jugador que golpeó la pelota
-            if (isLeftPaddle)
-            {
-                barrierLeftActive = true;
-                barrierTimerLeft.restart();
-                leftBarrier.setSize(Vector2f(10, 100));
-                leftBarrier.setPosition(100, 250);
-                leftBarrier.setFillColor(Color(100, 100, 255, 150));
-            }
-            else
-            {
-                barrierRightActive = true;
-                barrierTimerRight.restart();
-                rightBarrier.setSize(Vector2f(10, 100));
-                rightBarrier.setPosition(750, 250);
-                rightBarrier.setFillColor(Color(255, 100, 100, 150));
-            }
-            break;
-        case INVERT_CONTROLS:
-            if (isLeftPaddle)
-            {
-                rightPaddle.setInvertedControls(true);
-            }
-            else
-            {
-                leftPaddle.setInvertedControls(true);
-            }
-            break;
-        case FLASHING_BALL:
-            // Hacer que todas las pelotas parpadeen durante 5 segundos
-            for (auto &ball : balls)
-            {
-                ball.startFlashing(5.0f); // 5 segundos de parpadeo
-            }
-            break;
-        case DOUBLE_POINTS:
-            doublePointsActive = true;
-            doublePointsTimer.restart();
-            break;
-        case LESS_POINTS:
-            lessPointsActive = true;
-            lessPointsTimer.restart();
-            break;
-        case FREEZE_OPPONENT:
-            if (isLeftPaddle)
-            {
-                freezeRightActive = true;
-                freezeTimerRight.restart();
-            }
-            else
-            {
-                freezeLeftActive = true;
-                freezeTimerLeft.restart();
-            }
-            break;
-        case INVISIBLE_OPPONENT:
-            if (isLeftPaddle)
-            {
-                invisibleRightActive = true;
-                invisibleTimerRight.restart();
-            }
-            else
-            {
-                invisibleLeftActive = true;
-                invisibleTimerLeft.restart();
-            }
-            break;
+
+            Voice &voice = voices[chosen];
+            voice.sound.stop();
+            voice.sound.setBuffer(buffers[effect]);
+            voice.priority = priority;
+            voice.startTime = clock.getElapsedTime().asMicroseconds();
+            voice.sound.play();
+
+            Int64 latency = voice.startTime - pending[p].time;
+            latencyTotal += latency;
+            latencyMax = max(latencyMax, latency);
+            played++;
         }
+        pendingCount = 0;
     }
 
-    void resetPowerUpEffects()
+    void printStats() const
     {
-        leftPaddle.resetSize();
-        rightPaddle.resetSize();
-        rightPaddle.setInvertedControls(false);
-
-        // Mantener solo una pelota
-        while (balls.size() > 1)
-        {
-            balls.pop_back();
-        }
-
-        // Eliminar todos los power-ups
-        powerUps.clear();
+        if (played == 0)
+            return;
+        cout << "Sonidos: " << played << " reproducidos, " << dropped << " descartados, latencia disparo->voz promedio "
+             << latencyTotal / played << " us, maxima " << latencyMax << " us" << endl;
     }
+};
 
-    void render()
-    {
-        window.clear(Color(0, 0, 0));
+// Música de fondo por capas (tranquila, media, intensa) que se reproducen sincronizadas y
+// se mezclan según la intensidad del partido. Cada capa es un sf::Music, que decodifica
+// el archivo por bloques en su propio hilo con buffers pequeños, así la memoria no depende
+// de la duración de las pistas.
+class MusicMixer
+{
+private:
+    static const int LAYER_COUNT = 3;
 
-        if (state == MENU)
-        {
-            menu->draw(window);
-        }
-        else
-        {
-            // Dibujar elementos del juego (barra superior, paletas, pelota, etc.)
-            window.draw(headerBar);
+    Music layers[LAYER_COUNT];
+    bool loaded[LAYER_COUNT];
+    float volumes[LAYER_COUNT];
+    bool playing;
+    bool settled;      // todas las capas llegaron a su volumen objetivo
 
-            // Dibujar línea central
-            RectangleShape centerLine(Vector2f(2, 480));
-            centerLine.setPosition(425, 70);
-            centerLine.setFillColor(Color(255, 255, 255, 100));
-            window.draw(centerLine);
+    float fadeSpeed;   // fracción del volumen máximo por segundo
+    float maxVolume;
 
-            // Dibujar pelotas
-            for (const auto &ball : balls)
+public:
+    MusicMixer() : playing(false), settled(false), fadeSpeed(0.6f), maxVolume(60.0f)
+    {
+        const char *names[LAYER_COUNT] = {"calm", "medium", "intense"};
+        for (int i = 0; i < LAYER_COUNT; i++)
+        {
+            loaded[i] = layers[i].openFromFile(string("c:\\Pong\\music\\") + names[i] + ".ogg");
+            if (!loaded[i])
             {
-                if (ball.isActive() && ball.isVisible())
-                {
-                    window.draw(ball.getSprite());
-                }
+                cout << "Error al abrir musica " << names[i] << endl;
             }
+            layers[i].setLoop(true);
+            layers[i].setVolume(0.0f);
+            volumes[i] = 0.0f;
+        }
+    }
 
-            // Dibujar paletas
-            if (!invisibleLeftActive)
-                window.draw(leftPaddle.getSprite());
-            if (!invisibleRightActive)
-                window.draw(rightPaddle.getSprite());
-
-            // Dibujar barreras si están activas
-            if (barrierLeftActive)
-                window.draw(leftBarrier);
-            if (barrierRightActive)
-                window.draw(rightBarrier);
-
-            // Dibujar power-ups
-            for (const auto &powerUp : powerUps)
+    // intensity en [0, 1]; dt en segundos desde la última llamada
+    void update(float intensity, float dt, bool ducked)
+    {
+        if (!playing)
+        {
+            // Iniciar todas las capas a la vez para que queden alineadas
+            for (int i = 0; i < LAYER_COUNT; i++)
             {
-                if (powerUp.isActive() && !powerUp.isCollected())
-                {
-                    window.draw(powerUp.getSprite());
-                }
+                if (loaded[i])
+                    layers[i].play();
             }
+            playing = true;
+        }
 
-            // Dibujar puntuación y temporizador
-            window.draw(scoreLeft);
-            window.draw(scoreRight);
-            window.draw(timer->getDisplay());
-
-            // Menú de pausa
-            if (state == PAUSED)
-            {
-                // Fondo semitransparente oscuro
-                RectangleShape overlay(Vector2f(window.getSize().x, window.getSize().y));
-                overlay.setFillColor(Color(0, 0, 0, 180));
-                window.draw(overlay);
-
-                // Texto "PAUSA" centrado
-                Text pauseText("PAUSA", font, 60);
-                FloatRect pauseBounds = pauseText.getLocalBounds();
-                pauseText.setOrigin(pauseBounds.left + pauseBounds.width / 2.0f,
-                                    pauseBounds.top + pauseBounds.height / 2.0f);
-                pauseText.setPosition(850 / 2.0f, 50);
-                pauseText.setFillColor(Color::White);
-                window.draw(pauseText);
-
-                // Dibujar opciones del menú de pausa
-                for (const auto &option : pauseMenuOptions)
-                {
-                    window.draw(option);
-                }
-            }
+        float position = max(0.0f, min(1.0f, intensity)) * (LAYER_COUNT - 1);
+        settled = true;
+        for (int i = 0; i < LAYER_COUNT; i++)
+        {
+            if (!loaded[i])
+                continue;
 
-            // Pantalla de fin de juego
-            if (state == GAME_OVER)
-            {
-                RectangleShape overlay(Vector2f(window.getSize().x, window.getSize().y));
-                overlay.setFillColor(Color(0, 0, 0, 180));
-                window.draw(overlay);
+            // Peso triangular: cada capa domina alrededor de su punto de intensidad
+            float target = max(0.0f, 1.0f - fabs(position - i));
+            if (ducked)
+                target *= 0.3f;
 
-                window.draw(gameOverText);
+            float step = fadeSpeed * dt;
+            if (volumes[i] < target)
+                volumes[i] = min(target, volumes[i] + step);
+            else
+                volumes[i] = max(target, volumes[i] - step);
 
-                // Instrucciones para continuar
-                Text instructions("Presiona R para reiniciar o M para menu", font, 14);
-                FloatRect instrBounds = instructions.getLocalBounds();
-                instructions.setOrigin(instrBounds.left + instrBounds.width / 2.0f,
-                                       instrBounds.top + instrBounds.height / 2.0f);
-                instructions.setPosition(850 / 2.0f, 50);
-                instructions.setFillColor(Color::White);
-                window.draw(instructions);
-            }
+            layers[i].setVolume(volumes[i] * maxVolume);
+            if (volumes[i] != target)
+                settled = false;
         }
-
-        window.display();
     }
 
-    void resetGame()
-    {
-        // Limpiar pelotas y power-ups
-        balls.clear();
-        powerUps.clear();
-
-        // Crear una nueva pelota con velocidad inicial
-        balls.push_back(Ball(ballTexture));
-
-        // Asegurarse de que la pelota tenga una velocidad inicial
-        balls[0].reset();
-
-        // Reiniciar puntuaciones
-        leftScore = 0;
-        rightScore = 0;
-        doublePointsActive = false;
-        lessPointsActive = false;
-        freezeLeftActive = false;
-        freezeRightActive = false;
-        invisibleLeftActive = false;
-        invisibleRightActive = false;
-        biggerLeftActive = false;
-        biggerRightActive = false;
-        barrierLeftActive = false;
-        barrierRightActive = false;
-        smallerLeftActive = false;
-        smallerRightActive = false;
-        doublePointsActive = false;
-        lessPointsActive = false;
-        updateScoreDisplay();
+    // Sin fundidos en curso: mientras la intensidad no cambie, update no tiene nada que hacer
+    bool isSettled() const { return playing && settled; }
+};
 
-        // Reiniciar temporizador
-        timer->reset();
+// Mide el costo del sistema de partículas manteniendo el pool con la cantidad pedida de
+// partículas vivas. No dibuja: solo actualización y construcción de vértices (CPU).
+void benchmarkParticles(int liveParticles, int frames)
+{
+    const float dt = 1.0f / 120.0f;
+    ParticleSystem particles(liveParticles + 1024);
+    Int64 updateTime = 0;
+    Int64 buildTime = 0;
 
-        // Reiniciar paletas
-        leftPaddle.resetSize();
-        rightPaddle.resetSize();
-        leftPaddle.setInvertedControls(false);
-        rightPaddle.setInvertedControls(false);
+    Clock clock;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        // Reponer las partículas que murieron para mantener el pool lleno
+        while (particles.getCount() < liveParticles)
+        {
+            particles.burst(Vector2f(425, 300), min(256, liveParticles - particles.getCount()), Color::White, 150.0f, 2.0f);
+        }
 
-        // Aplicar configuraciones del menú
-        maxScore = menu->getMaxScore();
-        powerUpsEnabled = menu->arePowerUpsEnabled();
+        clock.restart();
+        particles.update(dt);
+        updateTime += clock.getElapsedTime().asMicroseconds();
 
-        // Reiniciar temporizador de power-ups
-        powerUpSpawnTimer.restart();
+        clock.restart();
+        particles.buildVertices();
+        buildTime += clock.getElapsedTime().asMicroseconds();
     }
 
-    void updateScoreDisplay()
-    {
-        scoreLeft.setString(to_string(leftScore));
-        scoreRight.setString(to_string(rightScore));
-    }
+    cout << "Particulas vivas: " << liveParticles << ", frames: " << frames << endl;
+    cout << "  update:   " << (double)updateTime / frames << " us/frame" << endl;
+    cout << "  vertices: " << (double)buildTime / frames << " us/frame" << endl;
+    cout << "  total:    " << (double)(updateTime + buildTime) / frames << " us/frame (presupuesto a 120 Hz: 8333 us)" << endl;
+}
 
-    void handlePlayerInput()
+// Búferes de píxeles (PBO) de OpenGL 2.1. opengl32.dll solo exporta OpenGL 1.1, así que
+// las constantes y las funciones se piden al contexto en tiempo de ejecución.
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_READ_ONLY
+#define GL_READ_ONLY 0x88B8
+#endif
+
+typedef void(APIENTRY *GlGenBuffersFunc)(GLsizei count, GLuint *buffers);
+typedef void(APIENTRY *GlDeleteBuffersFunc)(GLsizei count, const GLuint *buffers);
+typedef void(APIENTRY *GlBindBufferFunc)(GLenum target, GLuint buffer);
+typedef void(APIENTRY *GlBufferDataFunc)(GLenum target, ptrdiff_t size, const void *data, GLenum usage);
+typedef void *(APIENTRY *GlMapBufferFunc)(GLenum target, GLenum access);
+typedef GLboolean(APIENTRY *GlUnmapBufferFunc)(GLenum target);
+
+// Grabación de la partida a un video Y4M (YUV 4:2:0, lo abre ffmpeg) o a una secuencia de
+// PNG. En el hilo principal capture() pide el frame a un PBO, sin esperar a la GPU, y copia
+// a un búfer libre de un anillo reservado al inicio el frame que se pidió PBO_COUNT - 1
+// capturas antes, que ya está listo. Sin PBO (contextos anteriores a OpenGL 2.1) el frame
+// se lee directamente al anillo. La conversión de color y la escritura al disco las hace un
+// hilo en segundo plano. Si el escritor se atrasa y el anillo se llena, el frame se
+// descarta y se cuenta en lugar de frenar el juego.
+class FrameRecorder
+{
+private:
+    static const int SLOT_COUNT = 8;
+    static const int PBO_COUNT = 3;
+
+    unsigned int width;
+    unsigned int height;
+    string path;
+    bool png; // secuencia de PNG en lugar de Y4M
+    ofstream file;
+    int frameInterval; // grabar uno de cada frameInterval frames
+    int frameCounter;
+
+    // Anillo de un productor (hilo principal) y un consumidor (escritor). Los índices solo
+    // crecen; el slot es el índice módulo SLOT_COUNT.
+    vector<Uint8> slots[SLOT_COUNT]; // RGBA de abajo hacia arriba, como lo entrega OpenGL
+    atomic<unsigned int> writeIndex;
+    atomic<unsigned int> readIndex;
+    atomic<bool> running;
+    Thread writerThread;
+
+    // Búferes de trabajo del escritor
+    vector<Uint8> converted;
+
+    // Lecturas asíncronas del framebuffer. Se crean en la primera captura, con el contexto
+    // de la ventana ya activo; pixelBuffersChecked evita volver a intentarlo si no hay PBO.
+    bool pixelBuffersChecked;
+    bool pixelBuffersReady;
+    GLuint pixelBuffers[PBO_COUNT];
+    unsigned int pixelBuffersIssued; // lecturas pedidas
+    unsigned int pixelBuffersCopied; // lecturas ya copiadas al anillo
+    GlGenBuffersFunc glGenBuffersPtr;
+    GlDeleteBuffersFunc glDeleteBuffersPtr;
+    GlBindBufferFunc glBindBufferPtr;
+    GlBufferDataFunc glBufferDataPtr;
+    GlMapBufferFunc glMapBufferPtr;
+    GlUnmapBufferFunc glUnmapBufferPtr;
+
+    // Estadísticas
+    unsigned int capturedFrames;
+    unsigned int droppedFrames;
+    atomic<unsigned int> writtenFrames;
+    Int64 captureTotal; // microsegundos
+    Int64 captureMax;
+
+    void writer()
     {
-        // Controles para la paleta izquierda (si no es IA)
-        if (!leftPaddle.getIsAI())
+        while (running || readIndex != writeIndex)
         {
-            if (Keyboard::isKeyPressed(Keyboard::W))
-            {
-                leftPaddle.move(-leftPaddle.getSpeed()); // Move up
-            }
-            if (Keyboard::isKeyPressed(Keyboard::S))
+            if (readIndex == writeIndex)
             {
-                leftPaddle.move(leftPaddle.getSpeed()); // Move down
+                sleep(milliseconds(1));
+                continue;
             }
+
+            const vector<Uint8> &frame = slots[readIndex % SLOT_COUNT];
+            if (png)
+                writePng(frame);
+            else
+                writeY4m(frame);
+            writtenFrames++;
+
+            // Liberar el slot para el hilo principal
+            readIndex++;
         }
+    }
 
-        // Controles para la paleta derecha (si no es IA)
-        if (!rightPaddle.getIsAI())
+    void writeY4m(const vector<Uint8> &rgba)
+    {
+        // BT.601 rango completo en enteros; el croma se promedia en bloques de 2x2
+        Uint8 *yPlane = &converted[0];
+        Uint8 *uPlane = yPlane + width * height;
+        Uint8 *vPlane = uPlane + (width / 2) * (height / 2);
+        for (unsigned int y = 0; y < height; y++)
         {
-            if (Keyboard::isKeyPressed(Keyboard::Up))
+            const Uint8 *row = &rgba[(height - 1 - y) * width * 4];
+            for (unsigned int x = 0; x < width; x++)
             {
-                rightPaddle.move(-rightPaddle.getSpeed()); // Move up
+                const Uint8 *p = row + x * 4;
+                yPlane[y * width + x] = (Uint8)((77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8);
             }
-            if (Keyboard::isKeyPressed(Keyboard::Down))
+        }
+        for (unsigned int y = 0; y < height / 2; y++)
+        {
+            const Uint8 *row0 = &rgba[(height - 1 - y * 2) * width * 4];
+            const Uint8 *row1 = row0 - width * 4;
+            for (unsigned int x = 0; x < width / 2; x++)
             {
-                rightPaddle.move(rightPaddle.getSpeed()); // Move down
+                const Uint8 *a = row0 + x * 8;
+                const Uint8 *b = row1 + x * 8;
+                int r = a[0] + a[4] + b[0] + b[4];
+                int g = a[1] + a[5] + b[1] + b[5];
+                int bl = a[2] + a[6] + b[2] + b[6];
+                uPlane[y * (width / 2) + x] = (Uint8)(((-43 * r - 85 * g + 128 * bl) >> 10) + 128);
+                vPlane[y * (width / 2) + x] = (Uint8)(((128 * r - 107 * g - 21 * bl) >> 10) + 128);
             }
         }
+
+        file << "FRAME\n";
+        file.write((const char *)&converted[0], width * height * 3 / 2);
     }
 
-    void showOptionsMenu()
+    void writePng(const vector<Uint8> &rgba)
     {
-        // Crear un menú de opciones simple
-        bool optionsMenuOpen = true;
-        int selectedOption = 0;
-        vector<string> options = {
-            "Dificultad IA 1: " + to_string(static_cast<int>(menu->getAILevel1())),
-            "Dificultad IA 2: " + to_string(static_cast<int>(menu->getAILevel2())),
-            "Duracion Partida: " + to_string(menu->getGameDuration()) + " min",
-            "Puntuacion Maxima: " + to_string(menu->getMaxScore()),
-            "Power-Ups: " + string(menu->arePowerUpsEnabled() ? "Activados" : "Desactivados"),
-            "Volver"};
+        // Dar vuelta las filas y dejar el alfa opaco
+        for (unsigned int y = 0; y < height; y++)
+        {
+            memcpy(&converted[y * width * 4], &rgba[(height - 1 - y) * width * 4], width * 4);
+        }
+        for (unsigned int i = 3; i < width * height * 4; i += 4)
+        {
+            converted[i] = 255;
+        }
 
-        while (optionsMenuOpen && window.isOpen())
+        char number[16];
+        snprintf(number, sizeof(number), "_%06u.png", (unsigned int)writtenFrames);
+        Image image;
+        image.create(width, height, &converted[0]);
+        if (!image.saveToFile(path + number))
         {
-            Event event;
-            while (window.pollEvent(event))
-            {
-                if (event.type == Event::Closed)
-                {
-                    window.close();
-                    return;
-                }
+            cout << "Error al guardar " << path + number << endl;
+        }
+    }
 
-                if (event.type == Event::KeyPressed)
-                {
-                    if (event.key.code == Keyboard::Up)
-                    {
-                        selectedOption = (selectedOption - 1 + options.size()) % options.size();
-                    }
-                    else if (event.key.code == Keyboard::Down)
-                    {
-                        selectedOption = (selectedOption + 1) % options.size();
-                    }
-                    else if (event.key.code == Keyboard::Left)
-                    {
-                        // Disminuir valor
-                        switch (selectedOption)
-                        {
-                        case 0: // Nivel IA 1
-                            if (menu->getAILevel1() > EASY)
-                                menu->setAILevel1(static_cast<AILevel>(static_cast<int>(menu->getAILevel1()) - 1));
-                            break;
-                        case 1: // Nivel IA 2
-                            if (menu->getAILevel2() > EASY)
-                                menu->setAILevel2(static_cast<AILevel>(static_cast<int>(menu->getAILevel2()) - 1));
-                            break;
-                        case 2: // Duración del juego
-                            if (menu->getGameDuration() > 1)
-                                menu->setGameDuration(menu->getGameDuration() - 1);
-                            break;
-                        case 3: // Puntuación máxima
-                            if (menu->getMaxScore() > 3)
-                                menu->setMaxScore(menu->getMaxScore() - 2);
-                            break;
-                        case 4: // Power-Ups
-                            menu->setPowerUpsEnabled(!menu->arePowerUpsEnabled());
-                            break;
-                        }
-                    }
-                    else if (event.key.code == Keyboard::Right)
-                    {
-                        // Aumentar valor
-                        switch (selectedOption)
-                        {
-                        case 0: // Nivel IA 1
-                            if (menu->getAILevel1() < IMPOSSIBLE)
-                                menu->setAILevel1(static_cast<AILevel>(static_cast<int>(menu->getAILevel1()) + 1));
-                            break;
-                        case 1: // Nivel IA 2
-                            if (menu->getAILevel2() < IMPOSSIBLE)
-                                menu->setAILevel2(static_cast<AILevel>(static_cast<int>(menu->getAILevel2()) + 1));
-                            break;
-                        case 2: // Duración del juego
-                            if (menu->getGameDuration() < 10)
-                                menu->setGameDuration(menu->getGameDuration() + 1);
-                            break;
-                        case 3: // Puntuación máxima
-                            if (menu->getMaxScore() < 21)
-                                menu->setMaxScore(menu->getMaxScore() + 2);
-                            break;
-                        case 4: // Power-Ups
-                            menu->setPowerUpsEnabled(!menu->arePowerUpsEnabled());
-                            break;
-                        }
-                    }
-                    else if (event.key.code == Keyboard::Return)
-                    {
-                        if (selectedOption == 5) // Volver
-                        {
-                            optionsMenuOpen = false;
-                        }
-                    }
-                    else if (event.key.code == Keyboard::Escape)
-                    {
-                        optionsMenuOpen = false;
-                    }
+    bool initPixelBuffers()
+    {
+        if (pixelBuffersChecked)
+            return pixelBuffersReady;
+        pixelBuffersChecked = true;
+
+        glGenBuffersPtr = (GlGenBuffersFunc)Context::getFunction("glGenBuffers");
+        glDeleteBuffersPtr = (GlDeleteBuffersFunc)Context::getFunction("glDeleteBuffers");
+        glBindBufferPtr = (GlBindBufferFunc)Context::getFunction("glBindBuffer");
+        glBufferDataPtr = (GlBufferDataFunc)Context::getFunction("glBufferData");
+        glMapBufferPtr = (GlMapBufferFunc)Context::getFunction("glMapBuffer");
+        glUnmapBufferPtr = (GlUnmapBufferFunc)Context::getFunction("glUnmapBuffer");
+        if (!glGenBuffersPtr || !glDeleteBuffersPtr || !glBindBufferPtr || !glBufferDataPtr || !glMapBufferPtr || !glUnmapBufferPtr)
+        {
+            cout << "OpenGL sin PBO: la grabacion lee cada frame de forma sincronica" << endl;
+            return false;
+        }
 
-                    // Actualizar texto de opciones
-                    options[0] = "Dificultad IA 1: " + to_string(static_cast<int>(menu->getAILevel1()));
-                    options[1] = "Dificultad IA 2: " + to_string(static_cast<int>(menu->getAILevel2()));
-                    options[2] = "Duracion Partida: " + to_string(menu->getGameDuration()) + " min";
-                    options[3] = "Puntuacion Maxima: " + to_string(menu->getMaxScore());
-                    options[4] = "Power-Ups: " + string(menu->arePowerUpsEnabled() ? "Activados" : "Desactivados");
-                }
-            }
+        glGenBuffersPtr(PBO_COUNT, pixelBuffers);
+        for (int i = 0; i < PBO_COUNT; i++)
+        {
+            glBindBufferPtr(GL_PIXEL_PACK_BUFFER, pixelBuffers[i]);
+            glBufferDataPtr(GL_PIXEL_PACK_BUFFER, width * height * 4, nullptr, GL_STREAM_READ);
+        }
+        glBindBufferPtr(GL_PIXEL_PACK_BUFFER, 0);
+        pixelBuffersReady = true;
+        return true;
+    }
 
-            // Renderizar menú de opciones
-            window.clear(Color(0, 0, 0));
+    // Copia al anillo la lectura pendiente más vieja. Hay lugar en el anillo: lo comprueba
+    // quien llama.
+    void copyOldestPixelBuffer()
+    {
+        glBindBufferPtr(GL_PIXEL_PACK_BUFFER, pixelBuffers[pixelBuffersCopied % PBO_COUNT]);
+        const Uint8 *pixels = (const Uint8 *)glMapBufferPtr(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (pixels)
+        {
+            memcpy(&slots[writeIndex % SLOT_COUNT][0], pixels, width * height * 4);
+            glUnmapBufferPtr(GL_PIXEL_PACK_BUFFER);
+            writeIndex++;
+        }
+        else
+        {
+            droppedFrames++;
+        }
+        glBindBufferPtr(GL_PIXEL_PACK_BUFFER, 0);
+        pixelBuffersCopied++;
+    }
 
-            Text title("OPCIONES", font, 50);
-            FloatRect titleBounds = title.getLocalBounds();
-            title.setOrigin(titleBounds.left + titleBounds.width / 2.0f, titleBounds.top);
-            title.setPosition(850 / 2.0f, 50);
+public:
+    // path terminado en .y4m graba video; cualquier otro es el prefijo de los PNG
+    FrameRecorder(unsigned int w, unsigned int h, const string &outputPath, int fps, int frameRate)
+        : width(w & ~1u), height(h & ~1u), path(outputPath), frameCounter(0), writeIndex(0), readIndex(0),
+          running(true), writerThread(&FrameRecorder::writer, this), pixelBuffersChecked(false), pixelBuffersReady(false),
+          pixelBuffersIssued(0), pixelBuffersCopied(0), capturedFrames(0), droppedFrames(0), writtenFrames(0),
+          captureTotal(0), captureMax(0)
+    {
+        fps = max(1, min(frameRate, fps));
+        frameInterval = frameRate / fps;
 
-            window.draw(title);
+        for (int i = 0; i < SLOT_COUNT; i++)
+        {
+            slots[i].resize(w * h * 4);
+        }
 
-            for (size_t i = 0; i < options.size(); i++)
+        png = path.size() < 4 || path.compare(path.size() - 4, 4, ".y4m") != 0;
+        if (png)
+        {
+            converted.resize(width * height * 4);
+        }
+        else
+        {
+            converted.resize(width * height * 3 / 2);
+            file.open(path.c_str(), ios::binary);
+            if (!file)
             {
-                Text optionText(options[i], font, 30);
-                FloatRect optionBounds = optionText.getLocalBounds();
-                optionText.setOrigin(optionBounds.left + optionBounds.width / 2.0f, optionBounds.top);
-                optionText.setPosition(850 / 2.0f, 150 + i * 50);
-
-                // Resaltar opción seleccionada
-                if (i == selectedOption)
-                    optionText.setFillColor(Color::Yellow);
-                else
-                    optionText.setFillColor(Color::White);
-
-                window.draw(optionText);
+                cout << "Error al crear " << path << endl;
             }
-
-            window.display();
+            file << "YUV4MPEG2 W" << width << " H" << height << " F" << frameRate / frameInterval << ":1 Ip A1:1 C420jpeg\n";
         }
+
+        writerThread.launch();
     }
 
-    void checkPowerUpCollisions()
+    ~FrameRecorder()
     {
-        for (auto &ball : balls)
-        {
-            if (!ball.isActive())
-                continue;
+        finish();
+    }
 
-            for (auto it = powerUps.begin(); it != powerUps.end();)
+    // Pasa al anillo las lecturas que quedan en los PBO y espera a que el escritor termine
+    // con los frames pendientes. Necesita activo el contexto de las capturas.
+    void finish()
+    {
+        while (pixelBuffersCopied != pixelBuffersIssued)
+        {
+            if (writeIndex - readIndex >= (unsigned int)SLOT_COUNT)
             {
-                if (!it->isActive() || it->isCollected())
-                {
-                    it = powerUps.erase(it);
-                    continue;
-                }
-
-                if (it->getSprite().getGlobalBounds().contains(ball.getPosition()))
-                {
-                    applyPowerUp(*it);
-                    it->collect();
-                    it = powerUps.erase(it);
-                }
-                else
-                {
-                    ++it;
-                }
+                sleep(milliseconds(1));
+                continue;
             }
+            copyOldestPixelBuffer();
+        }
+        if (pixelBuffersReady)
+        {
+            glDeleteBuffersPtr(PBO_COUNT, pixelBuffers);
+            pixelBuffersReady = false;
         }
+
+        running = false;
+        writerThread.wait();
     }
 
-    // Método para mostrar el menú de dificultad de la IA
-    void showAIDifficultyMenu()
+    // Lee el framebuffer activo (la ventana antes de display(), o una RenderTexture
+    // después de setActive()). No reserva memoria ni escribe al disco.
+    void capture()
     {
-        // Crear un menú temporal para la selección de dificultad
-        RenderWindow difficultyWindow(VideoMode(600, 300), "Seleccionar Dificultad");
-        difficultyWindow.setFramerateLimit(60);
-
-        // Opciones de dificultad
-        vector<Text> options;
-        vector<string> difficultyNames = {"FACIL", "MEDIA", "DIFICIL", "IMPOSIBLE"};
-        vector<AILevel> difficultyLevels = {EASY, MEDIUM, HARD, IMPOSSIBLE};
+        if (++frameCounter < frameInterval)
+            return;
+        frameCounter = 0;
 
-        int selectedOption = 0;
+        if (writeIndex - readIndex >= (unsigned int)SLOT_COUNT)
+        {
+            droppedFrames++;
+            return;
+        }
 
-        // Crear las opciones de texto
-        for (int i = 0; i < 4; i++)
+        Clock clock;
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        if (initPixelBuffers())
         {
-            Text option(difficultyNames[i], font, 30);
-            option.setPosition(150, 80 + i * 50);
-            if (i == selectedOption)
-            {
-                option.setFillColor(Color::Yellow);
-            }
-            else
-            {
-                option.setFillColor(Color::White);
-            }
-            options.push_back(option);
+            // La lectura queda en cola en la GPU; el último argumento es el desplazamiento en el PBO
+            glBindBufferPtr(GL_PIXEL_PACK_BUFFER, pixelBuffers[pixelBuffersIssued % PBO_COUNT]);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBufferPtr(GL_PIXEL_PACK_BUFFER, 0);
+            pixelBuffersIssued++;
+
+            // Con todos los PBO ocupados, el más viejo se pidió PBO_COUNT - 1 capturas atrás
+            if (pixelBuffersIssued - pixelBuffersCopied == (unsigned int)PBO_COUNT)
+                copyOldestPixelBuffer();
+        }
+        else
+        {
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &slots[writeIndex % SLOT_COUNT][0]);
+            writeIndex++;
         }
+        capturedFrames++;
 
-        // Título
-        Text title("SELECCIONA DIFICULTAD", font, 24);
-        title.setPosition(80, 30);
+        Int64 elapsed = clock.getElapsedTime().asMicroseconds();
+        captureTotal += elapsed;
+        captureMax = max(captureMax, elapsed);
+    }
 
-        // Loop principal del menú de dificultad
-        while (difficultyWindow.isOpen())
-        {
-            Event event;
-            while (difficultyWindow.pollEvent(event))
-            {
-                if (event.type == Event::Closed)
-                {
-                    difficultyWindow.close();
-                }
+    void printStats() const
+    {
+        if (capturedFrames == 0)
+            return;
+        cout << "Grabacion: " << capturedFrames << " frames capturados, " << writtenFrames << " escritos, " << droppedFrames
+             << " descartados, copia por frame promedio " << captureTotal / capturedFrames << " us, maxima " << captureMax << " us" << endl;
+    }
+};
 
-                if (event.type == Event::KeyPressed)
-                {
-                    if (event.key.code == Keyboard::Up)
-                    {
-                        options[selectedOption].setFillColor(Color::White);
-                        selectedOption = (selectedOption - 1 + 4) % 4;
-                        options[selectedOption].setFillColor(Color::Yellow);
-                    }
-                    else if (event.key.code == Keyboard::Down)
-                    {
-                        options[selectedOption].setFillColor(Color::White);
-                        selectedOption = (selectedOption + 1) % 4;
-                        options[selectedOption].setFillColor(Color::Yellow);
-                    }
-                    else if (event.key.code == Keyboard::Return)
-                    {
-                        // Configurar el juego con la dificultad seleccionada
-                        gameMode = PLAYER_VS_AI;
-                        leftPaddle.setIsAI(false);
-                        rightPaddle.setIsAI(true);
-                        rightPaddle.setAILevel(difficultyLevels[selectedOption]);
-                        menu->setAILevel1(difficultyLevels[selectedOption]); // Guardar la selección
-                        resetGame();
-                        state = PLAYING;
-                        difficultyWindow.close();
-                    }
-                    else if (event.key.code == Keyboard::Escape)
-                    {
-                        difficultyWindow.close();
-                    }
-                }
-            }
+// Telemetría del partido. Un hilo en segundo plano consume los eventos de la simulación
+// cada pocos milisegundos y los escribe como registros binarios de 16 bytes. Si la cola
+// de eventos se llena el evento se descarta y se cuenta, así la simulación nunca espera
+// al disco.
+enum TelemetryEvent
+{
+    TELEMETRY_MATCH_START,   // value1: puntaje máximo, detail: power-ups activados
+    TELEMETRY_RALLY_START,   // value1, value2: velocidad inicial de la pelota (x, y)
+    TELEMETRY_RALLY_END,     // value1: golpes de paleta, value2: duración en ticks
+    TELEMETRY_PADDLE_HIT,    // side: paleta, value1: velocidad de la pelota, value2: punto de contacto en [-1, 1]
+    TELEMETRY_WALL_BOUNCE,   // side: 0 arriba, 1 abajo, value1: x de la pelota
+    TELEMETRY_POWERUP_SPAWN, // detail: PowerUpType, value1, value2: posición
+    TELEMETRY_POWERUP_COLLECT, // detail: PowerUpType, side: beneficiario
+    TELEMETRY_POWERUP_EXPIRE,  // detail: PowerUpType, side: beneficiario
+    TELEMETRY_GOAL,          // side: quien anota, value1: puntos, detail: bit 0 doble puntos, bit 1 menos puntos
+    TELEMETRY_EVENT_COUNT
+};
 
-            // Dibujar
-            difficultyWindow.clear(Color(0, 0, 0));
-            difficultyWindow.draw(title);
-            for (const auto &option : options)
-            {
-                difficultyWindow.draw(option);
-            }
-            difficultyWindow.display();
-        }
+const Uint8 TELEMETRY_LEFT = 0;
+const Uint8 TELEMETRY_RIGHT = 1;
+const Uint8 TELEMETRY_NONE = 255;
+
+struct TelemetryRecord
+{
+    Uint32 tick;
+    Uint8 type;
+    Uint8 side;
+    Uint8 detail;
+    Uint8 reserved;
+    float value1;
+    float value2;
+};
+
+class Telemetry
+{
+private:
+    static const unsigned int FLUSH_BATCH = 512;
+
+    MatchEventQueue events; // la simulación publica aquí; solo la lee el hilo de vaciado
+    atomic<bool> running;
+    Thread flushThread;
+    ofstream file;
+    unsigned int written;
+
+    // Estado del rally, calculado aquí a partir de los eventos para no hacerlo en el tick
+    Uint32 rallyStartTick;
+    int rallyHits;
+
+    TelemetryRecord batch[FLUSH_BATCH];
+    unsigned int batchCount;
+
+    void add(Uint32 tick, TelemetryEvent type, Uint8 side, Uint8 detail, float value1, float value2)
+    {
+        TelemetryRecord &r = batch[batchCount++];
+        r.tick = tick;
+        r.type = (Uint8)type;
+        r.side = side;
+        r.detail = detail;
+        r.reserved = 0;
+        r.value1 = value1;
+        r.value2 = value2;
+        if (batchCount == FLUSH_BATCH)
+            writeBatch();
     }
 
-    void applyPowerUp(const PowerUp &powerUp)
+    void writeBatch()
     {
-        bool isLeftPaddle = false;
-        if (!balls.empty() && balls[0].getVelocity().x > 0)
+        file.write((const char *)batch, batchCount * sizeof(TelemetryRecord));
+        written += batchCount;
+        batchCount = 0;
+    }
+
+    void convert(const MatchEvent &e)
+    {
+        switch (e.type)
         {
-            isLeftPaddle = true;
+        case EVENT_MATCH_START:
+            add(e.tick, TELEMETRY_MATCH_START, TELEMETRY_NONE, e.detail, e.value1, 0.0f);
+            break;
+        case EVENT_RALLY_START:
+            rallyStartTick = e.tick;
+            rallyHits = 0;
+            add(e.tick, TELEMETRY_RALLY_START, TELEMETRY_NONE, 0, e.value1, e.value2);
+            break;
+        case EVENT_PADDLE_HIT:
+            rallyHits++;
+            add(e.tick, TELEMETRY_PADDLE_HIT, e.side, 0, e.value1, e.value2);
+            break;
+        case EVENT_WALL_BOUNCE:
+            add(e.tick, TELEMETRY_WALL_BOUNCE, e.side, 0, e.x, 0.0f);
+            break;
+        case EVENT_GOAL:
+            add(e.tick, TELEMETRY_RALLY_END, TELEMETRY_NONE, 0, (float)rallyHits, (float)(e.tick - rallyStartTick));
+            add(e.tick, TELEMETRY_GOAL, e.side, e.detail, e.value1, 0.0f);
+            break;
+        case EVENT_POWERUP_SPAWN:
+            add(e.tick, TELEMETRY_POWERUP_SPAWN, TELEMETRY_NONE, e.detail, e.x, e.y);
+            break;
+        case EVENT_POWERUP_COLLECTED:
+            add(e.tick, TELEMETRY_POWERUP_COLLECT, e.side, e.detail, 0.0f, 0.0f);
+            break;
+        case EVENT_EFFECT_EXPIRED:
+            add(e.tick, TELEMETRY_POWERUP_EXPIRE, e.side, e.detail, 0.0f, 0.0f);
+            break;
         }
+    }
 
-        switch (powerUp.getType())
+    void flushLoop()
+    {
+        MatchEvent event;
+        while (true)
         {
-        case BIGGER_PADDLE:
-            // Determinar qué jugador recibe el power-up (el que golpeó la pelota)
-            if (isLeftPaddle)
-            {
-                leftPaddle.setSize(1.5f); // Aumentar tamaño en 50%
-                biggerLeftActive = true;
-                biggerTimerLeft.restart();
-            }
-            else
+            bool stopping = !running;
+            bool any = false;
+            while (events.pop(event))
             {
-                rightPaddle.setSize(1.5f);
-                biggerRightActive = true;
-                biggerTimerRight.restart();
+                convert(event);
+                any = true;
             }
-            break;
 
-        case SMALLER_OPPONENT:
-            // Reducir el tamaño del oponente
-            if (isLeftPaddle)
+            if (batchCount > 0)
             {
-                // Si el jugador izquierdo recoge el power-up, la paleta derecha se hace más pequeña
-                rightPaddle.setSize(0.5f);
-                smallerRightActive = true;
-                smallerTimerRight.restart();
+                writeBatch();
             }
-            else
+            else if (!any && stopping)
             {
-                // Si el jugador derecho recoge el power-up, la paleta izquierda se hace más pequeña
-                leftPaddle.setSize(0.5f);
-                smallerLeftActive = true;
-                smallerTimerLeft.restart();
+                break;
             }
-            break;
-
-        case SLOW_BALL:
-            // Reducir velocidad de todas las pelotas
-            for (auto &ball : balls)
+            else if (!any)
             {
-                ball.slowDown(0.7f); // Reducir velocidad en 30%
+                sleep(milliseconds(5));
             }
-            break;
+        }
+        file.flush();
+    }
 
-        case DOUBLE_BALL:
-            // Añadir una segunda pelota
-            if (balls.size() < 2)
-            { // Máximo 2 pelotas
-                balls.push_back(Ball(ballTexture));
-            }
-            break;
+public:
+    Telemetry(const string &path)
+        : running(true), flushThread(&Telemetry::flushLoop, this), written(0), rallyStartTick(0), rallyHits(0), batchCount(0)
+    {
+        file.open(path.c_str(), ios::binary);
+        if (!file)
+        {
+            cout << "Error al crear " << path << endl;
+        }
+        // Cabecera: identificador y tamaño del registro
+        Uint32 recordSize = sizeof(TelemetryRecord);
+        file.write("PONGTLM1", 8);
+        file.write((const char *)&recordSize, sizeof(recordSize));
+        flushThread.launch();
+    }
 
-        case BARRIER:
-            // Crear una barrera para el jugador que golpeó la pelota
-            if (isLeftPaddle)
-            {
-                barrierLeftActive = true;
-                barrierTimerLeft.restart();
-                leftBarrier.setSize(Vector2f(10, 100));
-                leftBarrier.setPosition(100, 250);
-                leftBarrier.setFillColor(Color(100, 100, 255, 150));
-            }
-            else
-            {
-                barrierRightActive = true;
-                barrierTimerRight.restart();
-                rightBarrier.setSize(Vector2f(10, 100));
-                rightBarrier.setPosition(750, 250);
-                rightBarrier.setFillColor(Color(255, 100, 100, 150));
-            }
-            break;
+    ~Telemetry()
+    {
+        finish();
+    }
 
-        case INVERT_CONTROLS:
-            // Invertir controles del oponente
-            if (isLeftPaddle)
-            {
-                rightPaddle.setInvertedControls(true);
-            }
-            else
-            {
-                leftPaddle.setInvertedControls(true);
-            }
-            break;
+    // Cola a suscribir en el partido con Match::subscribe
+    MatchEventQueue &getQueue() { return events; }
 
-        case FLASHING_BALL:
-            // Hacer que todas las pelotas parpadeen durante 5 segundos
-            for (auto &ball : balls)
-            {
-                ball.startFlashing(5.0f);
-            }
-            break;
+    // Vacía los registros pendientes y detiene el hilo
+    void finish()
+    {
+        running = false;
+        flushThread.wait();
+    }
 
-        case DOUBLE_POINTS:
-            doublePointsActive = true;
-            doublePointsTimer.restart();
-            break;
+    void printStats() const
+    {
+        if (written == 0 && events.getDropped() == 0)
+            return;
+        cout << "Telemetria: " << written << " registros escritos, " << events.getDropped() << " eventos descartados" << endl;
+    }
+};
 
-        case LESS_POINTS:
-            lessPointsActive = true;
-            lessPointsTimer.restart();
-            break;
+// Convierte un archivo de telemetría binario a CSV. Devuelve false si no se pudo leer.
+bool exportTelemetryCsv(const string &inputPath, const string &outputPath)
+{
+    static const char *eventNames[TELEMETRY_EVENT_COUNT] = {
+        "match_start", "rally_start", "rally_end", "paddle_hit", "wall_bounce",
+        "powerup_spawn", "powerup_collect", "powerup_expire", "goal"};
+
+    ifstream input(inputPath.c_str(), ios::binary);
+    char magic[8];
+    Uint32 recordSize = 0;
+    input.read(magic, 8);
+    input.read((char *)&recordSize, sizeof(recordSize));
+    if (!input || memcmp(magic, "PONGTLM1", 8) != 0 || recordSize != sizeof(TelemetryRecord))
+    {
+        cout << "Error: " << inputPath << " no es un archivo de telemetria valido" << endl;
+        return false;
+    }
 
-        case FREEZE_OPPONENT:
-            if (isLeftPaddle)
+    ofstream output(outputPath.c_str());
+    if (!output)
+    {
+        cout << "Error al crear " << outputPath << endl;
+        return false;
+    }
+
+    output << "tick,seconds,event,side,detail,value1,value2" << endl;
+    TelemetryRecord r;
+    int rows = 0;
+    while (input.read((char *)&r, sizeof(r)))
+    {
+        const char *side = r.side == TELEMETRY_LEFT ? "left" : (r.side == TELEMETRY_RIGHT ? "right" : "");
+        if (r.type == TELEMETRY_WALL_BOUNCE)
+            side = r.side == 0 ? "top" : "bottom";
+        bool powerUpEvent = r.type == TELEMETRY_POWERUP_SPAWN || r.type == TELEMETRY_POWERUP_COLLECT || r.type == TELEMETRY_POWERUP_EXPIRE;
+
+        output << r.tick << ',' << (double)r.tick / TICK_RATE << ','
+               << (r.type < TELEMETRY_EVENT_COUNT ? eventNames[r.type] : "unknown") << ',' << side << ',';
+        if (powerUpEvent && r.detail <= INVISIBLE_OPPONENT)
+            output << POWER_UP_NAMES[r.detail];
+        else
+            output << (int)r.detail;
+        output << ',' << r.value1 << ',' << r.value2 << '\n';
+        rows++;
+    }
+
+    cout << rows << " registros exportados a " << outputPath << endl;
+    return true;
+}
+
+// Cola de eventos de teclado con marca de tiempo. Cada tick de simulación consulta
+// durante cuánto tiempo estuvo realmente presionada cada tecla dentro de su intervalo,
+// así un toque más corto que un frame no se pierde y no se cuantiza al frame.
+class InputQueue
+{
+private:
+    struct KeyEvent
+    {
+        Keyboard::Key key;
+        bool pressed;
+        Int64 time; // microsegundos
+    };
+
+    static const int MAX_EVENTS = 256;
+    KeyEvent events[MAX_EVENTS];
+    int head;
+    int count;
+
+    bool held[Keyboard::KeyCount];
+    Int64 heldSince[Keyboard::KeyCount];
+    float heldFraction[Keyboard::KeyCount];
+
+public:
+    InputQueue() : head(0), count(0)
+    {
+        for (int i = 0; i < Keyboard::KeyCount; i++)
+        {
+            held[i] = false;
+            heldSince[i] = 0;
+            heldFraction[i] = 0.0f;
+        }
+    }
+
+    void push(Keyboard::Key key, bool pressed, Int64 time)
+    {
+        if (key < 0 || key >= Keyboard::KeyCount)
+            return;
+
+        // Si la cola está llena se descarta el evento más antiguo
+        if (count == MAX_EVENTS)
+        {
+            head = (head + 1) % MAX_EVENTS;
+            count--;
+        }
+
+        KeyEvent &e = events[(head + count) % MAX_EVENTS];
+        e.key = key;
+        e.pressed = pressed;
+        e.time = time;
+        count++;
+    }
+
+    // Suelta todas las teclas (por ejemplo al perder el foco, cuando no llegan los KeyReleased)
+    void releaseAll(Int64 time)
+    {
+        for (int i = 0; i < Keyboard::KeyCount; i++)
+        {
+            if (held[i])
+                push(static_cast<Keyboard::Key>(i), false, time);
+        }
+    }
+
+    // Consume los eventos del intervalo [tickStart, tickEnd) y calcula la fracción
+    // del tick que cada tecla estuvo presionada
+    void integrate(Int64 tickStart, Int64 tickEnd)
+    {
+        Int64 heldTime[Keyboard::KeyCount] = {};
+
+        for (int i = 0; i < Keyboard::KeyCount; i++)
+        {
+            if (held[i] && heldSince[i] < tickStart)
+                heldSince[i] = tickStart;
+        }
+
+        while (count > 0 && events[head].time < tickEnd)
+        {
+            const KeyEvent &e = events[head];
+            Int64 t = max(e.time, tickStart);
+
+            if (e.pressed && !held[e.key])
             {
-                freezeRightActive = true;
-                freezeTimerRight.restart();
+                held[e.key] = true;
+                heldSince[e.key] = t;
             }
-            else
+            else if (!e.pressed && held[e.key])
             {
-                freezeLeftActive = true;
-                freezeTimerLeft.restart();
+                held[e.key] = false;
+                heldTime[e.key] += t - heldSince[e.key];
             }
-            break;
 
-        case INVISIBLE_OPPONENT:
-            if (isLeftPaddle)
-            {
-                invisibleRightActive = true;
-                invisibleTimerRight.restart();
-            }
-            else
+            head = (head + 1) % MAX_EVENTS;
+            count--;
+        }
+
+        for (int i = 0; i < Keyboard::KeyCount; i++)
+        {
+            if (held[i])
             {
-                invisibleLeftActive = true;
-                invisibleTimerLeft.restart();
+                heldTime[i] += tickEnd - heldSince[i];
+                heldSince[i] = tickEnd;
             }
-            break;
+            heldFraction[i] = (float)heldTime[i] / (float)(tickEnd - tickStart);
         }
     }
 
-    void handleCollisions()
+    float getHeldFraction(Keyboard::Key key) const { return heldFraction[key]; }
+};
+
+// Texturas que necesita un partido. Se cargan una sola vez y se comparten entre todos
+// los partidos (también los que se simulan sin ventana)
+struct MatchTextures
+{
+    Texture ball;
+    Texture paddle;
+    Texture powerUps[11]; // Una textura para cada tipo de power-up
+
+    void load()
     {
-        // Colisión con las barreras
-        if (barrierLeftActive)
+        if (!ball.loadFromFile("c:\\Pong\\imagesBri\\Pelota.png"))
         {
-            FloatRect barrierBounds = leftBarrier.getGlobalBounds();
-            for (auto &ball : balls)
-            {
-                if (!ball.isActive())
-                    continue;
-
-                FloatRect ballBounds = ball.getSprite().getGlobalBounds();
-                if (ballBounds.intersects(barrierBounds))
-                {
-                    // Invertir la dirección horizontal de la pelota
-                    ball.reverseX();
-                    // Mover la pelota fuera de la barrera para evitar colisiones múltiples
-                    Vector2f ballPos = ball.getPosition();
-                    if (ball.getVelocity().x < 0)
-                    {
-                        ball.getSprite().setPosition(barrierBounds.left + barrierBounds.width + ballBounds.width / 2, ballPos.y);
-                    }
-                    else
-                    {
-                        ball.getSprite().setPosition(barrierBounds.left - ballBounds.width / 2, ballPos.y);
-                    }
-                }
-            }
+            cout << "Error al cargar textura Bola" << endl;
         }
 
-        if (barrierRightActive)
+        if (!paddle.loadFromFile("c:\\Pong\\imagesBri\\Paleta.png"))
         {
-            FloatRect barrierBounds = rightBarrier.getGlobalBounds();
-            for (auto &ball : balls)
+            cout << "Error al cargar textura Paleta" << endl;
+        }
+
+        // Cargar texturas de power-ups (esto es un placeholder, necesitarías crear estas imágenes)
+        // En una implementación real, cargarías imágenes distintas para cada power-up
+        if (!powerUps[BIGGER_PADDLE].loadFromFile("c:\\Pong\\imagesBri\\PaletaMasGrande.png"))
+        {
+            cout << "Error al cargar textura para BIGGER_PADDLE" << endl;
+        }
+        if (!powerUps[SMALLER_OPPONENT].loadFromFile("c:\\Pong\\imagesBri\\PaletaMasPequena.png"))
+        {
+            cout << "Error al cargar textura para SMALLER_OPPONENT" << endl;
+        }
+        if (!powerUps[SLOW_BALL].loadFromFile("c:\\Pong\\imagesBri\\pelotaLenta.png"))
+        {
+            cout << "Error al cargar textura para SLOW_BALL" << endl;
+        }
+        if (!powerUps[DOUBLE_BALL].loadFromFile("c:\\Pong\\imagesBri\\DoblePelota.png"))
+        {
+            cout << "Error al cargar textura para DOUBLE_BALL" << endl;
+        }
+        if (!powerUps[BARRIER].loadFromFile("c:\\Pong\\imagesBri\\Barrera.png"))
+        {
+            cout << "Error al cargar textura para BARRIER" << endl;
+        }
+        if (!powerUps[INVERT_CONTROLS].loadFromFile("c:\\Pong\\imagesBri\\CambioDeControles.png"))
+        {
+            cout << "Error al cargar textura para INVERT_CONTROLS" << endl;
+        }
+        if (!powerUps[FLASHING_BALL].loadFromFile("c:\\Pong\\imagesBri\\PelotasFantasmas.png"))
+        {
+            cout << "Error al cargar textura para FLASHING_BALL" << endl;
+        }
+        if (!powerUps[DOUBLE_POINTS].loadFromFile("c:\\Pong\\imagesBri\\PuntosDobles.png"))
+        {
+            cout << "Error al cargar textura para DOUBLE_POINTS" << endl;
+        }
+        if (!powerUps[LESS_POINTS].loadFromFile("c:\\Pong\\imagesBri\\PuntosNegativos.png"))
+        {
+            cout << "Error al cargar textura para LESS_POINTS" << endl;
+        }
+        if (!powerUps[FREEZE_OPPONENT].loadFromFile("c:\\Pong\\imagesBri\\BloqueoPaleta.png"))
+        {
+            cout << "Error al cargar textura para FREEZE_OPPONENT" << endl;
+        }
+        if (!powerUps[INVISIBLE_OPPONENT].loadFromFile("c:\\Pong\\imagesBri\\VisionObstruida.png"))
+        {
+            cout << "Error al cargar textura para INVISIBLE_OPPONENT" << endl;
+        }
+    }
+};
+
+// Instantánea completa de un partido en un tick. Restaurarla y seguir simulando con la misma
+// entrada da exactamente los mismos ticks; las repeticiones la guardan como keyframe.
+const int SNAPSHOT_EFFECT_COUNT = 12;
+const int SNAPSHOT_TIMER_COUNT = 13;
+
+struct MatchSnapshot
+{
+    Uint32 tick;
+    Uint32 rngState;
+    BallState balls[2];
+    PaddleState paddles[2];
+    PowerUpState powerUps[3];
+    Uint8 ballCount, powerUpCount, powerUpsEnabled, fixedPoint;
+    Uint8 effects[SNAPSHOT_EFFECT_COUNT];
+    Uint32 timerStartTicks[SNAPSHOT_TIMER_COUNT];
+    float barrierPositions[4]; // x, y de la barrera izquierda y de la derecha
+    Uint32 barrierColors[2];
+    int leftScore, rightScore, maxScore;
+};
+
+// Estado y reglas de un partido: pelotas, paletas, power-ups, efectos y marcador. No
+// depende de la ventana, así Game lo dibuja y los modos sin interfaz (por ejemplo el
+// ajuste automático de la IA) pueden simular partidos completos, incluso en paralelo.
+class Match
+{
+private:
+    MatchTextures &textures;
+    Random rng;
+
+    // Colas de los consumidores de eventos (ninguna cuando se simula sin ventana)
+    static const int MAX_SUBSCRIBERS = 4;
+    MatchEventQueue *subscribers[MAX_SUBSCRIBERS];
+    int subscriberCount;
+
+    // Ticks desde el inicio del partido; todos los temporizadores del partido derivan de él
+    SimulationClock clock;
+    bool eventsMuted; // sin publicar eventos (p. ej. al re-simular para buscar en una repetición)
+
+    // Memoria del partido: las pelotas y los power-ups salen de un solo bloque reservado al crearlo
+    static const int MAX_BALLS = 2;
+    static const int MAX_POWER_UPS = 3;
+    BumpArena memory;
+
+    // Elementos del juego
+    BallList balls;
+    Paddle leftPaddle;
+    Paddle rightPaddle;
+    PowerUpList powerUps;
+    bool freezeLeftActive;
+    bool freezeRightActive;
+    SimulationTimer freezeTimerLeft;
+    SimulationTimer freezeTimerRight;
+    bool invisibleLeftActive;
+    bool invisibleRightActive;
+    SimulationTimer invisibleTimerLeft;
+    SimulationTimer invisibleTimerRight;
+    bool biggerLeftActive;
+    bool biggerRightActive;
+    SimulationTimer biggerTimerLeft;
+    SimulationTimer biggerTimerRight;
+    bool barrierLeftActive;
+    bool barrierRightActive;
+    SimulationTimer barrierTimerLeft;
+    SimulationTimer barrierTimerRight;
+    RectangleShape leftBarrier;
+    RectangleShape rightBarrier;
+    CollisionBoxes collisionBoxes; // se arma una vez por tick con las cajas guardadas de cada objeto
+    FloatRect leftBarrierBounds;
+    FloatRect rightBarrierBounds;
+    bool smallerLeftActive;
+    bool smallerRightActive;
+    SimulationTimer smallerTimerLeft;
+    SimulationTimer smallerTimerRight;
+    SimulationTimer doublePointsTimer;
+    SimulationTimer lessPointsTimer;
+    SimulationTimer powerUpSpawnTimer;
+    bool doublePointsActive;
+    bool lessPointsActive;
+
+    // Marcador y configuración
+    int leftScore;
+    int rightScore;
+    int maxScore;
+    bool powerUpsEnabled;
+    bool fixedPoint;
+
+public:
+    Match(MatchTextures &t, unsigned int seed)
+        : textures(t), rng(seed), subscriberCount(0), eventsMuted(false),
+          memory(MAX_BALLS * sizeof(Ball) + MAX_POWER_UPS * sizeof(PowerUp) + alignof(Ball) + alignof(PowerUp)),
+          balls(ArenaAllocator<Ball>(&memory)),
+          leftPaddle(t.paddle, true, false, EASY), rightPaddle(t.paddle, false, true, EASY),
+          powerUps(ArenaAllocator<PowerUp>(&memory)),
+          freezeTimerLeft(clock), freezeTimerRight(clock),
+          invisibleTimerLeft(clock), invisibleTimerRight(clock),
+          biggerTimerLeft(clock), biggerTimerRight(clock),
+          barrierTimerLeft(clock), barrierTimerRight(clock),
+          smallerTimerLeft(clock), smallerTimerRight(clock),
+          doublePointsTimer(clock), lessPointsTimer(clock),
+          powerUpSpawnTimer(clock)
+    {
+        // Configurar las barreras
+        leftBarrier.setSize(Vector2f(BARRIER_WIDTH, BARRIER_HEIGHT));
+        leftBarrier.setFillColor(Color(255, 0, 0, 128)); // Rojo semi-transparente
+        leftBarrier.setPosition(BARRIER_MARGIN, BARRIER_Y);
+
+        rightBarrier.setSize(Vector2f(BARRIER_WIDTH, BARRIER_HEIGHT));
+        rightBarrier.setFillColor(Color(255, 0, 0, 128)); // Rojo semi-transparente
+        rightBarrier.setPosition(FIELD_WIDTH - BARRIER_MARGIN, BARRIER_Y);
+        refreshBarrierBounds();
+
+        maxScore = 7;
+        powerUpsEnabled = true;
+        fixedPoint = false;
+        reset();
+    }
+
+    const SimulationClock &getClock() const { return clock; }
+    void setEventsMuted(bool muted) { eventsMuted = muted; }
+
+    void saveSnapshot(MatchSnapshot &snapshot) const
+    {
+        memset(&snapshot, 0, sizeof(snapshot));
+        snapshot.tick = clock.getTicks();
+        snapshot.rngState = rng.getState();
+        snapshot.ballCount = (Uint8)balls.size();
+        for (size_t i = 0; i < balls.size(); i++)
+        {
+            balls[i].saveState(snapshot.balls[i]);
+        }
+        leftPaddle.saveState(snapshot.paddles[0]);
+        rightPaddle.saveState(snapshot.paddles[1]);
+        snapshot.powerUpCount = (Uint8)powerUps.size();
+        for (size_t i = 0; i < powerUps.size(); i++)
+        {
+            powerUps[i].saveState(snapshot.powerUps[i]);
+        }
+        snapshot.powerUpsEnabled = powerUpsEnabled;
+        snapshot.fixedPoint = fixedPoint;
+        for (int i = 0; i < SNAPSHOT_EFFECT_COUNT; i++)
+        {
+            snapshot.effects[i] = this->*effectFlag(i);
+        }
+        for (int i = 0; i < SNAPSHOT_TIMER_COUNT; i++)
+        {
+            snapshot.timerStartTicks[i] = (this->*effectTimer(i)).getStartTick();
+        }
+        snapshot.barrierPositions[0] = leftBarrier.getPosition().x;
+        snapshot.barrierPositions[1] = leftBarrier.getPosition().y;
+        snapshot.barrierPositions[2] = rightBarrier.getPosition().x;
+        snapshot.barrierPositions[3] = rightBarrier.getPosition().y;
+        snapshot.barrierColors[0] = leftBarrier.getFillColor().toInteger();
+        snapshot.barrierColors[1] = rightBarrier.getFillColor().toInteger();
+        snapshot.leftScore = leftScore;
+        snapshot.rightScore = rightScore;
+        snapshot.maxScore = maxScore;
+    }
+
+    // Un snapshot leído de un archivo solo se carga si sus cantidades y tipos caben en el partido
+    static bool isValidSnapshot(const MatchSnapshot &snapshot)
+    {
+        if (snapshot.ballCount > MAX_BALLS || snapshot.powerUpCount > MAX_POWER_UPS)
+            return false;
+        for (int i = 0; i < snapshot.powerUpCount; i++)
+        {
+            if (snapshot.powerUps[i].type > INVISIBLE_OPPONENT)
+                return false;
+        }
+        return true;
+    }
+
+    void loadSnapshot(const MatchSnapshot &snapshot)
+    {
+        assert(isValidSnapshot(snapshot));
+        clock.setTicks(snapshot.tick);
+        fixedPoint = snapshot.fixedPoint != 0;
+        powerUpsEnabled = snapshot.powerUpsEnabled != 0;
+
+        resetMemory();
+        for (int i = 0; i < snapshot.ballCount && i < MAX_BALLS; i++)
+        {
+            balls.emplace_back(textures.ball, rng, clock, fixedPoint);
+            balls.back().loadState(snapshot.balls[i]);
+        }
+        leftPaddle.loadState(snapshot.paddles[0]);
+        rightPaddle.loadState(snapshot.paddles[1]);
+        for (int i = 0; i < snapshot.powerUpCount && i < MAX_POWER_UPS; i++)
+        {
+            PowerUpType type = static_cast<PowerUpType>(snapshot.powerUps[i].type);
+            powerUps.emplace_back(type, textures.powerUps[type], rng, clock);
+            powerUps.back().loadState(snapshot.powerUps[i]);
+        }
+
+        for (int i = 0; i < SNAPSHOT_EFFECT_COUNT; i++)
+        {
+            this->*effectFlag(i) = snapshot.effects[i] != 0;
+        }
+        for (int i = 0; i < SNAPSHOT_TIMER_COUNT; i++)
+        {
+            (this->*effectTimer(i)).setStartTick(snapshot.timerStartTicks[i]);
+        }
+        leftBarrier.setPosition(snapshot.barrierPositions[0], snapshot.barrierPositions[1]);
+        rightBarrier.setPosition(snapshot.barrierPositions[2], snapshot.barrierPositions[3]);
+        refreshBarrierBounds();
+        leftBarrier.setFillColor(Color(snapshot.barrierColors[0]));
+        rightBarrier.setFillColor(Color(snapshot.barrierColors[1]));
+        leftScore = snapshot.leftScore;
+        rightScore = snapshot.rightScore;
+        maxScore = snapshot.maxScore;
+
+        // Al final: construir pelotas y power-ups consume números del generador
+        rng.setSeed(snapshot.rngState);
+    }
+
+    // Agrega una cola de consumidor; cada evento se copia a todas las colas suscritas
+    void subscribe(MatchEventQueue *queue)
+    {
+        for (int i = 0; i < subscriberCount; i++)
+        {
+            if (subscribers[i] == queue)
+                return;
+        }
+        if (subscriberCount < MAX_SUBSCRIBERS)
+            subscribers[subscriberCount++] = queue;
+    }
+
+    void unsubscribe(MatchEventQueue *queue)
+    {
+        for (int i = 0; i < subscriberCount; i++)
+        {
+            if (subscribers[i] == queue)
+            {
+                subscribers[i] = subscribers[--subscriberCount];
+                return;
+            }
+        }
+    }
+
+    void reset()
+    {
+        // Limpiar pelotas y power-ups
+        resetMemory();
+
+        // Crear una nueva pelota con velocidad inicial
+        balls.emplace_back(textures.ball, rng, clock, fixedPoint);
+
+        // Reiniciar puntuaciones y efectos
+        leftScore = 0;
+        rightScore = 0;
+        doublePointsActive = false;
+        lessPointsActive = false;
+        freezeLeftActive = false;
+        freezeRightActive = false;
+        invisibleLeftActive = false;
+        invisibleRightActive = false;
+        biggerLeftActive = false;
+        biggerRightActive = false;
+        barrierLeftActive = false;
+        barrierRightActive = false;
+        smallerLeftActive = false;
+        smallerRightActive = false;
+
+        // Reiniciar paletas
+        leftPaddle.resetSize();
+        rightPaddle.resetSize();
+        leftPaddle.setInvertedControls(false);
+        rightPaddle.setInvertedControls(false);
+
+        // Reiniciar el reloj del partido y el temporizador de power-ups
+        clock.reset();
+        powerUpSpawnTimer.restart();
+
+        publish(EVENT_MATCH_START, SIDE_NONE, powerUpsEnabled, 0.0f, 0.0f, (float)maxScore);
+        startRally();
+    }
+
+    // Un tick de simulación. leftAxis y rightAxis son la entrada de los jugadores humanos
+    // en [-1, 1] (negativo hacia arriba); se ignoran para las paletas controladas por IA.
+    void tick(float leftAxis, float rightAxis)
+    {
+        clock.advance();
+
+        // Posiciones al comenzar el tick: Game dibuja interpolando entre ellas y las nuevas
+        for (auto &ball : balls)
+        {
+            ball.storePreviousPosition();
+        }
+        leftPaddle.storePreviousPosition();
+        rightPaddle.storePreviousPosition();
+
+        // Verificar si los efectos de power-up han expirado
+        if (freezeLeftActive && freezeTimerLeft.getElapsedSeconds() >= 5.0f)
+        {
+            freezeLeftActive = false;
+            publish(EVENT_EFFECT_EXPIRED, SIDE_RIGHT, FREEZE_OPPONENT);
+        }
+
+        if (freezeRightActive && freezeTimerRight.getElapsedSeconds() >= 5.0f)
+        {
+            freezeRightActive = false;
+            publish(EVENT_EFFECT_EXPIRED, SIDE_LEFT, FREEZE_OPPONENT);
+        }
+
+        if (doublePointsActive && doublePointsTimer.getElapsedSeconds() >= 5.0f)
+        {
+            doublePointsActive = false;
+            publish(EVENT_EFFECT_EXPIRED, SIDE_NONE, DOUBLE_POINTS);
+        }
+
+        if (lessPointsActive && lessPointsTimer.getElapsedSeconds() >= 5.0f)
+        {
+            lessPointsActive = false;
+            publish(EVENT_EFFECT_EXPIRED, SIDE_NONE, LESS_POINTS);
+        }
+
+        // Verificar si el efecto de barrera ha expirado
+        if (barrierLeftActive && barrierTimerLeft.getElapsedSeconds() >= 5.0f)
+        {
+            barrierLeftActive = false;
+            publish(EVENT_EFFECT_EXPIRED, SIDE_LEFT, BARRIER);
+        }
+
+        if (barrierRightActive && barrierTimerRight.getElapsedSeconds() >= 5.0f)
+        {
+            barrierRightActive = false;
+            publish(EVENT_EFFECT_EXPIRED, SIDE_RIGHT, BARRIER);
+        }
+
+        // Verificar si el efecto de paleta más pequeña ha expirado
+        if (smallerLeftActive && smallerTimerLeft.getElapsedSeconds() >= 5.0f)
+        {
+            smallerLeftActive = false;
+            leftPaddle.resetSize();
+            publish(EVENT_EFFECT_EXPIRED, SIDE_RIGHT, SMALLER_OPPONENT);
+        }
+
+        if (smallerRightActive && smallerTimerRight.getElapsedSeconds() >= 5.0f)
+        {
+            smallerRightActive = false;
+            rightPaddle.resetSize();
+            publish(EVENT_EFFECT_EXPIRED, SIDE_LEFT, SMALLER_OPPONENT);
+        }
+
+        // Actualizar pelotas
+        updateBalls();
+
+        // Actualizar paletas
+        updatePaddles(leftAxis, rightAxis);
+
+        // Manejar colisiones
+        handleCollisions();
+
+        // Generar power-ups
+        if (powerUpsEnabled && powerUpSpawnTimer.getElapsedSeconds() > 10)
+        { // Cada 10 segundos
+            spawnPowerUp();
+            powerUpSpawnTimer.restart();
+        }
+
+        // Actualizar power-ups
+        updatePowerUps();
+    }
+
+    bool isScoreLimitReached() const { return leftScore >= maxScore || rightScore >= maxScore; }
+
+    const BallList &getBalls() const { return balls; }
+    const PowerUpList &getPowerUps() const { return powerUps; }
+    const BumpArena &getMemory() const { return memory; }
+    Paddle &getLeftPaddle() { return leftPaddle; }
+    Paddle &getRightPaddle() { return rightPaddle; }
+    const Paddle &getLeftPaddle() const { return leftPaddle; }
+    const Paddle &getRightPaddle() const { return rightPaddle; }
+    const RectangleShape &getLeftBarrier() const { return leftBarrier; }
+    const RectangleShape &getRightBarrier() const { return rightBarrier; }
+    bool isBarrierLeftActive() const { return barrierLeftActive; }
+    bool isBarrierRightActive() const { return barrierRightActive; }
+    bool isInvisibleLeftActive() const { return invisibleLeftActive; }
+    bool isInvisibleRightActive() const { return invisibleRightActive; }
+    int getLeftScore() const { return leftScore; }
+    int getRightScore() const { return rightScore; }
+    int getMaxScore() const { return maxScore; }
+    void setMaxScore(int score) { maxScore = score; }
+    void setPowerUpsEnabled(bool enabled) { powerUpsEnabled = enabled; }
+
+    // Hace aparecer ya un power-up del tipo dado, con la misma regla que la aparición normal para
+    // LESS_POINTS (la prueba de estrés lo usa para sortear el momento y el tipo)
+    bool forcePowerUp(PowerUpType type)
+    {
+        if (powerUps.size() >= MAX_POWER_UPS || (type == LESS_POINTS && (leftScore < 1 || rightScore < 1)))
+            return false;
+        addPowerUp(type);
+        return true;
+    }
+
+    // Condiciones que valen después de cualquier tick; devuelve la primera que no se cumple o
+    // nulo. Las que dependen de varios ticks (pelotas atrapadas) las sigue la prueba de estrés.
+    const char *checkInvariants() const
+    {
+        if (leftScore < 0 || rightScore < 0)
+            return "marcador negativo";
+        if (balls.empty() || balls.size() > MAX_BALLS)
+            return "cantidad de pelotas fuera de rango";
+        if (powerUps.size() > MAX_POWER_UPS)
+            return "demasiados power-ups";
+
+        for (const Ball &ball : balls)
+        {
+            Vector2f position = ball.getPosition();
+            Vector2f velocity = ball.getVelocity();
+            if (!isfinite(position.x) || !isfinite(position.y) || !isfinite(velocity.x) || !isfinite(velocity.y))
+                return "posicion o velocidad de la pelota no finita";
+            if (ball.getSpeed() > ball.getMaxSpeed() * 1.01f)
+                return "pelota mas rapida que su maximo";
+
+            // Un gol reinicia la pelota en el mismo tick; contra las paredes puede pasarse a lo
+            // sumo un tick de recorrido antes de que el rebote la devuelva
+            float margin = ball.getMaxSpeed() + ball.getSprite().getGlobalBounds().height;
+            if (position.x < 0 || position.x > FIELD_WIDTH)
+                return "pelota fuera del campo sin gol";
+            if (position.y < HEADER_HEIGHT - margin || position.y > FIELD_HEIGHT + margin)
+                return "pelota atraveso una pared";
+        }
+
+        const Paddle *paddles[2] = {&leftPaddle, &rightPaddle};
+        for (const Paddle *paddle : paddles)
+        {
+            const FloatRect &bounds = paddle->getBounds();
+            if (bounds.top < HEADER_HEIGHT - 0.01f || bounds.top + bounds.height > FIELD_HEIGHT + 0.01f)
+                return "paleta fuera de 70-550";
+        }
+
+        // Los efectos duran 5 segundos; uno activo que empezó en el futuro o con el temporizador
+        // más allá está colgado. El inicio se compara en ticks: la diferencia sin signo da la vuelta.
+        for (int i = 0; i < SNAPSHOT_EFFECT_COUNT; i++)
+        {
+            const SimulationTimer &timer = this->*effectTimer(i);
+            if (this->*effectFlag(i) &&
+                (timer.getStartTick() > clock.getTicks() || timer.getElapsedSeconds() > 5.0f + 2.0f / TICK_RATE))
+                return "efecto activo fuera de su duracion";
+        }
+        for (const PowerUp &powerUp : powerUps)
+        {
+            if (powerUp.getType() == LESS_POINTS && !powerUp.isCollected() && (leftScore < 1 || rightScore < 1))
+                return "LESS_POINTS en juego con un marcador en 0";
+        }
+        return nullptr;
+    }
+
+    // Física de pelotas y predicción de la IA en punto fijo (se aplica en el próximo reset)
+    void setFixedPoint(bool enabled) { fixedPoint = enabled; }
+    bool isFixedPoint() const { return fixedPoint; }
+
+    // Mezcla el estado de las pelotas, paletas y marcador en un hash FNV-1a para
+    // comparar simulaciones bit a bit
+    unsigned int hashState(unsigned int hash) const
+    {
+        for (const Ball &ball : balls)
+        {
+            hash = hashWord(hash, ball.isFixedPoint() ? ball.getFixedX().raw : floatBits(ball.getPosition().x));
+            hash = hashWord(hash, ball.isFixedPoint() ? ball.getFixedY().raw : floatBits(ball.getPosition().y));
+            hash = hashWord(hash, ball.isFixedPoint() ? ball.getFixedVelocityX().raw : floatBits(ball.getVelocity().x));
+            hash = hashWord(hash, ball.isFixedPoint() ? ball.getFixedVelocityY().raw : floatBits(ball.getVelocity().y));
+        }
+        hash = hashWord(hash, floatBits(leftPaddle.getSprite().getPosition().y));
+        hash = hashWord(hash, floatBits(rightPaddle.getSprite().getPosition().y));
+        hash = hashWord(hash, leftScore);
+        return hashWord(hash, rightScore);
+    }
+
+private:
+    static unsigned int hashWord(unsigned int hash, int word)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            hash ^= (word >> (i * 8)) & 0xFF;
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    static int floatBits(float value)
+    {
+        int bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    // Banderas de efectos y temporizadores en el orden en que los guarda MatchSnapshot
+    static bool Match::*effectFlag(int index)
+    {
+        static bool Match::*const flags[SNAPSHOT_EFFECT_COUNT] = {
+            &Match::freezeLeftActive, &Match::freezeRightActive, &Match::invisibleLeftActive,
+            &Match::invisibleRightActive, &Match::biggerLeftActive, &Match::biggerRightActive,
+            &Match::barrierLeftActive, &Match::barrierRightActive, &Match::smallerLeftActive,
+            &Match::smallerRightActive, &Match::doublePointsActive, &Match::lessPointsActive};
+        return flags[index];
+    }
+
+    static SimulationTimer Match::*effectTimer(int index)
+    {
+        static SimulationTimer Match::*const timers[SNAPSHOT_TIMER_COUNT] = {
+            &Match::freezeTimerLeft, &Match::freezeTimerRight, &Match::invisibleTimerLeft,
+            &Match::invisibleTimerRight, &Match::biggerTimerLeft, &Match::biggerTimerRight,
+            &Match::barrierTimerLeft, &Match::barrierTimerRight, &Match::smallerTimerLeft,
+            &Match::smallerTimerRight, &Match::doublePointsTimer, &Match::lessPointsTimer,
+            &Match::powerUpSpawnTimer};
+        return timers[index];
+    }
+
+    // Copia el evento a la cola de cada consumidor; el tick nunca espera a un consumidor
+    void publish(MatchEventType type, Uint8 side = SIDE_NONE, Uint8 detail = 0, float x = 0.0f, float y = 0.0f,
+                 float value1 = 0.0f, float value2 = 0.0f)
+    {
+        if (subscriberCount == 0 || eventsMuted)
+            return;
+
+        MatchEvent event;
+        event.tick = clock.getTicks();
+        event.type = (Uint8)type;
+        event.side = side;
+        event.detail = detail;
+        event.reserved = 0;
+        event.x = x;
+        event.y = y;
+        event.value1 = value1;
+        event.value2 = value2;
+        for (int i = 0; i < subscriberCount; i++)
+        {
+            subscribers[i]->push(event);
+        }
+    }
+
+    // Destruye las pelotas y los power-ups y devuelve la memoria del partido de una vez;
+    // después vuelve a tomar la capacidad máxima para no pedir memoria durante el partido
+    void resetMemory()
+    {
+        BallList(balls.get_allocator()).swap(balls);
+        PowerUpList(powerUps.get_allocator()).swap(powerUps);
+        memory.reset();
+        balls.reserve(MAX_BALLS);
+        powerUps.reserve(MAX_POWER_UPS);
+    }
+
+    void startRally()
+    {
+        if (subscriberCount > 0 && !eventsMuted && !balls.empty())
+        {
+            Vector2f position = balls[0].getPosition();
+            Vector2f velocity = balls[0].getVelocity();
+            publish(EVENT_RALLY_START, SIDE_NONE, 0, position.x, position.y, velocity.x, velocity.y);
+        }
+    }
+
+    // Golpe de paleta: velocidad de la pelota y punto de contacto (-1 borde superior, 1 inferior)
+    void publishPaddleHit(const Paddle &paddle, const Ball &ball, Uint8 side)
+    {
+        if (subscriberCount == 0 || eventsMuted)
+            return;
+        float halfHeight = paddle.getBounds().height / 2;
+        float offset = (ball.getPosition().y - paddle.getSprite().getPosition().y) / halfHeight;
+        publish(EVENT_PADDLE_HIT, side, 0, ball.getPosition().x, ball.getPosition().y, ball.getSpeed(), max(-1.0f, min(1.0f, offset)));
+    }
+
+    void publishGoal(Uint8 scorer, Vector2f position)
+    {
+        int points = doublePointsActive ? 2 : (lessPointsActive ? 0 : 1);
+        Uint8 multipliers = (doublePointsActive ? 1 : 0) | (lessPointsActive ? 2 : 0);
+        publish(EVENT_GOAL, scorer, multipliers, position.x, position.y, (float)points);
+    }
+
+    // Las barreras solo cambian al salir el power-up o al cargar una foto del partido
+    void refreshBarrierBounds()
+    {
+        leftBarrierBounds = leftBarrier.getGlobalBounds();
+        rightBarrierBounds = rightBarrier.getGlobalBounds();
+    }
+
+    // Cajas de las paletas y barreras para las pruebas de este tick (las de los power-ups las
+    // pone updatePowerUps). Las barreras inactivas quedan vacías.
+    void buildCollisionBoxes()
+    {
+        collisionBoxes.set(SLOT_RIGHT_PADDLE, rightPaddle.getBounds());
+        collisionBoxes.set(SLOT_LEFT_PADDLE, leftPaddle.getBounds());
+        if (barrierLeftActive)
+            collisionBoxes.set(SLOT_LEFT_BARRIER, leftBarrierBounds);
+        else
+            collisionBoxes.clear(SLOT_LEFT_BARRIER);
+        if (barrierRightActive)
+            collisionBoxes.set(SLOT_RIGHT_BARRIER, rightBarrierBounds);
+        else
+            collisionBoxes.clear(SLOT_RIGHT_BARRIER);
+    }
+
+    // Pruebas de colisión: una pasada del núcleo por pelota da todas las cajas que la tocan.
+    // Con pelotas en punto fijo las paletas y barreras se prueban solo con enteros para no
+    // depender del redondeo de las transformaciones en float de SFML.
+    unsigned int paddlesAndBarriersContaining(const Ball &ball) const
+    {
+        PONG_COUNT_COLLISION();
+        if (!ball.isFixedPoint())
+            return collisionBoxes.containsMask(ball.getPosition().x, ball.getPosition().y);
+
+        Fixed x = ball.getFixedX();
+        Fixed y = ball.getFixedY();
+        unsigned int mask = 0;
+        if (rightPaddle.getFixedBounds().contains(x, y))
+            mask |= 1u << SLOT_RIGHT_PADDLE;
+        if (leftPaddle.getFixedBounds().contains(x, y))
+            mask |= 1u << SLOT_LEFT_PADDLE;
+        if (barrierLeftActive && FixedRect::fromShape(leftBarrier).contains(x, y))
+            mask |= 1u << SLOT_LEFT_BARRIER;
+        if (barrierRightActive && FixedRect::fromShape(rightBarrier).contains(x, y))
+            mask |= 1u << SLOT_RIGHT_BARRIER;
+        return mask;
+    }
+
+    unsigned int barriersIntersecting(const Ball &ball) const
+    {
+        PONG_COUNT_COLLISION();
+        if (!ball.isFixedPoint())
+            return collisionBoxes.intersectsMask(ball.getSprite().getGlobalBounds());
+
+        FixedRect ballBounds = ball.getFixedBounds();
+        unsigned int mask = 0;
+        if (barrierLeftActive && ballBounds.intersects(FixedRect::fromShape(leftBarrier)))
+            mask |= 1u << SLOT_LEFT_BARRIER;
+        if (barrierRightActive && ballBounds.intersects(FixedRect::fromShape(rightBarrier)))
+            mask |= 1u << SLOT_RIGHT_BARRIER;
+        return mask;
+    }
+
+    bool touchesWall(const Ball &ball) const
+    {
+        PONG_COUNT_COLLISION();
+        if (ball.isFixedPoint())
+        {
+            Fixed half = ball.getFixedHalfSize();
+            return ball.getFixedY() < Fixed::fromInt(HEADER_HEIGHT) + half || ball.getFixedY() > Fixed::fromInt(FIELD_HEIGHT) - half;
+        }
+        Vector2f pos = ball.getPosition();
+        FloatRect ballBounds = ball.getSprite().getGlobalBounds();
+        return pos.y < HEADER_HEIGHT + ballBounds.height / 2 || pos.y > FIELD_HEIGHT - ballBounds.height / 2;
+    }
+
+    // Coloca la pelota junto a la barrera, del lado hacia el que se mueve
+    void pushOutOfBarrier(Ball &ball, const RectangleShape &barrier)
+    {
+        if (ball.isFixedPoint())
+        {
+            FixedRect barrierBounds = FixedRect::fromShape(barrier);
+            Fixed half = ball.getFixedHalfSize();
+            if (ball.getFixedVelocityX() < Fixed::fromRaw(0))
+                ball.setFixedPosition(barrierBounds.left + barrierBounds.width + half, ball.getFixedY());
+            else
+                ball.setFixedPosition(barrierBounds.left - half, ball.getFixedY());
+            return;
+        }
+
+        FloatRect barrierBounds = barrier.getGlobalBounds();
+        FloatRect ballBounds = ball.getSprite().getGlobalBounds();
+        Vector2f ballPos = ball.getPosition();
+        if (ball.getVelocity().x < 0)
+        {
+            ball.setPosition(barrierBounds.left + barrierBounds.width + ballBounds.width / 2, ballPos.y);
+        }
+        else
+        {
+            ball.setPosition(barrierBounds.left - ballBounds.width / 2, ballPos.y);
+        }
+    }
+
+    void updateBalls()
+    {
+        bool goalScored = false;
+        buildCollisionBoxes();
+
+        // Actualizar posición de las pelotas
+        for (auto &ball : balls)
+        {
+            ball.updateFlashing(); // Actualizar estado de parpadeo
+
+            if (!ball.isActive())
+                continue;
+
+            ball.update();
+            unsigned int hits = paddlesAndBarriersContaining(ball);
+
+            // Comprobar colisiones con las paletas
+            if (hits & (1u << SLOT_RIGHT_PADDLE))
+            {
+                publishPaddleHit(rightPaddle, ball, SIDE_RIGHT);
+                ball.reverseX();
+                ball.accelerate();
+            }
+            else if (hits & (1u << SLOT_LEFT_PADDLE))
+            {
+                publishPaddleHit(leftPaddle, ball, SIDE_LEFT);
+                ball.reverseX();
+                ball.accelerate();
+            }
+            // Comprobar colisiones con las barreras
+            else if (hits & (1u << SLOT_LEFT_BARRIER))
+            {
+                ball.reverseX();
+                publish(EVENT_BARRIER_HIT, SIDE_LEFT, 0, ball.getPosition().x, ball.getPosition().y);
+            }
+            else if (hits & (1u << SLOT_RIGHT_BARRIER))
+            {
+                ball.reverseX();
+                publish(EVENT_BARRIER_HIT, SIDE_RIGHT, 0, ball.getPosition().x, ball.getPosition().y);
+            }
+
+            // Comprobar colisiones con los bordes superior e inferior
+            Vector2f pos = ball.getPosition();
+            if (touchesWall(ball))
+            {
+                publish(EVENT_WALL_BOUNCE, pos.y < PLAY_CENTER_Y ? 0 : 1, 0, pos.x, pos.y);
+                ball.reverseY();
+            }
+
+            // Comprobar si ha salido por los lados (gol)
+            if (pos.x < 0)
+            {
+                // Gol para el jugador derecho
+                if (doublePointsActive)
+                {
+                    rightScore += 2;
+                }
+                else if (lessPointsActive)
+                {
+                    rightScore += 0; // No dar puntos
+                }
+                else
+                {
+                    rightScore++;
+                }
+                publishGoal(SIDE_RIGHT, pos);
+                goalScored = true;
+                doublePointsActive = false;
+                lessPointsActive = false;
+                ball.reset();
+
+                // No necesitamos comprobar victoria aquí, se hace en update()
+
+                break; // Salir del bucle para evitar más procesamiento
+            }
+            else if (pos.x > FIELD_WIDTH)
+            {
+                // Gol para el jugador izquierdo
+                if (doublePointsActive)
+                {
+                    leftScore += 2;
+                }
+                else if (lessPointsActive)
+                {
+                    leftScore += 0; // No dar puntos
+                }
+                else
+                {
+                    leftScore++;
+                }
+                publishGoal(SIDE_LEFT, pos);
+                goalScored = true;
+                doublePointsActive = false;
+                lessPointsActive = false;
+                ball.reset();
+
+                // No necesitamos comprobar victoria aquí, se hace en update()
+
+                break; // Salir del bucle para evitar más procesamiento
+            }
+        }
+
+        // Si se anotó un gol, reiniciar todas las pelotas
+        if (goalScored)
+        {
+            balls.clear();
+            balls.emplace_back(textures.ball, rng, clock, fixedPoint);
+            balls.back().reset();         // Asegurarse de que la pelota tenga una velocidad inicial
+            balls.back().setActive(true); // Asegurar que esté visible
+            startRally();
+            return;
+        }
+
+        // Eliminar pelotas inactivas
+        balls.erase(
+            remove_if(balls.begin(), balls.end(), [](const Ball &b)
+                      { return !b.isActive(); }),
+            balls.end());
+    }
+
+    void updatePaddles(float leftAxis, float rightAxis)
+    {
+        // Actualizar congelamiento
+        if (freezeLeftActive && freezeTimerLeft.getElapsedSeconds() > 5.0f) // 5 segundos
+        {
+            freezeLeftActive = false;
+        }
+        if (freezeRightActive && freezeTimerRight.getElapsedSeconds() > 5.0f)
+        {
+            freezeRightActive = false;
+        }
+        // Actualizar invisibilidad
+        if (invisibleLeftActive && invisibleTimerLeft.getElapsedSeconds() > 5.0f) // 5 segundos
+        {
+            invisibleLeftActive = false;
+            publish(EVENT_EFFECT_EXPIRED, SIDE_RIGHT, INVISIBLE_OPPONENT);
+        }
+        if (invisibleRightActive && invisibleTimerRight.getElapsedSeconds() > 5.0f)
+        {
+            invisibleRightActive = false;
+            publish(EVENT_EFFECT_EXPIRED, SIDE_LEFT, INVISIBLE_OPPONENT);
+        }
+        // Actualizar efecto de paleta más grande
+        if (biggerLeftActive && biggerTimerLeft.getElapsedSeconds() > 5.0f) // 5 segundos de duración
+        {
+            biggerLeftActive = false;
+            leftPaddle.resetSize();
+            publish(EVENT_EFFECT_EXPIRED, SIDE_LEFT, BIGGER_PADDLE);
+        }
+        if (biggerRightActive && biggerTimerRight.getElapsedSeconds() > 5.0f)
+        {
+            biggerRightActive = false;
+            rightPaddle.resetSize();
+            publish(EVENT_EFFECT_EXPIRED, SIDE_RIGHT, BIGGER_PADDLE);
+        }
+        // Actualizar barreras
+        if (barrierLeftActive && barrierTimerLeft.getElapsedSeconds() > 5.0f) // 5 segundos
+        {
+            barrierLeftActive = false;
+        }
+        if (barrierRightActive && barrierTimerRight.getElapsedSeconds() > 5.0f)
+        {
+            barrierRightActive = false;
+        }
+
+        // Controlar paleta izquierda (jugador 1 o IA). El eje en [-1, 1] es la fracción del
+        // tick que estuvo presionada cada tecla (abajo menos arriba)
+        if (!leftPaddle.getIsAI() && !freezeLeftActive)
+        {
+            if (leftAxis != 0.0f)
+            {
+                leftPaddle.move(leftAxis * leftPaddle.getSpeed());
+            }
+        }
+        else if (leftPaddle.getIsAI())
+        {
+            leftPaddle.update(balls, true, rng);
+        }
+
+        else
+        {
+            leftPaddle.update(balls, true, rng);
+        }
+
+        // Controlar paleta derecha (jugador 2 o IA)
+        if (!rightPaddle.getIsAI() && !freezeRightActive)
+        {
+            if (rightAxis != 0.0f)
+            {
+                rightPaddle.move(rightAxis * rightPaddle.getSpeed());
+            }
+        }
+        else if (rightPaddle.getIsAI())
+        {
+            rightPaddle.update(balls, false, rng);
+        }
+    }
+
+    void spawnPowerUp()
+    {
+        if (powerUps.size() >= MAX_POWER_UPS)
+            return; // Máximo 3 power-ups a la vez
+
+        int typeIndex = rng.next() % 11; // Ahora son 9 tipos
+        PowerUpType type = static_cast<PowerUpType>(typeIndex);
+
+        // Validar que LESS_POINTS solo salga si ambos tienen al menos 1 punto
+        if (type == LESS_POINTS && (leftScore < 1 || rightScore < 1))
+        {
+            // No generar el LESS_POINTS, cambia el power-up a uno normal
+            type = static_cast<PowerUpType>(rng.next() % 10);
+        }
+        addPowerUp(type);
+    }
+
+    void addPowerUp(PowerUpType type)
+    {
+        powerUps.emplace_back(type, textures.powerUps[type], rng, clock);
+        const PowerUp &newPowerUp = powerUps.back();
+        publish(EVENT_POWERUP_SPAWN, SIDE_NONE, type, newPowerUp.getSprite().getPosition().x, newPowerUp.getSprite().getPosition().y);
+    }
+
+    void updatePowerUps()
+    {
+        static_assert(SLOT_FIRST_POWER_UP + MAX_POWER_UPS <= COLLISION_SLOT_COUNT, "no caben los power-ups en CollisionBoxes");
+        for (int i = 0; i < MAX_POWER_UPS; i++)
+        {
+            if (i < (int)powerUps.size())
+                collisionBoxes.set(SLOT_FIRST_POWER_UP + i, powerUps[i].getBounds());
+            else
+                collisionBoxes.clear(SLOT_FIRST_POWER_UP + i);
+        }
+
+        // Cada pelota se prueba una vez contra todos los power-ups, la primera vez que hace
+        // falta; recoger uno no mueve las pelotas y la de DOUBLE_BALL se prueba al aparecer
+        unsigned int ballHits[MAX_BALLS];
+        size_t testedBalls = 0;
+        for (size_t i = 0; i < powerUps.size(); i++)
+        {
+            PowerUp &powerUp = powerUps[i];
+            if (!powerUp.isActive())
+                continue;
+
+            powerUp.update();
+
+            // Comprobar colisiones con las pelotas si no ha sido recogido
+            if (!powerUp.isCollected())
+            {
+                size_t ballCount = balls.size();
+                for (size_t b = 0; b < ballCount; b++)
+                {
+                    if (b == testedBalls)
+                    {
+                        PONG_COUNT_COLLISION();
+                        ballHits[b] = collisionBoxes.containsMask(balls[b].getPosition().x, balls[b].getPosition().y);
+                        testedBalls++;
+                    }
+                    if (balls[b].isActive() && (ballHits[b] & (1u << (SLOT_FIRST_POWER_UP + i))))
+                    {
+                        applyPowerUp(powerUp);
+                        powerUp.collect();
+                        break;
+                    }
+                }
+            }
+        }
+
+        // Eliminar power-ups inactivos
+        powerUps.erase(
+            remove_if(powerUps.begin(), powerUps.end(),
+                      [](const PowerUp &p)
+                      { return !p.isActive(); }),
+            powerUps.end());
+    }
+
+    void applyPowerUp(PowerUp &powerUp)
+    {
+
+        bool isLeftPaddle = false;
+        if (!balls.empty() && balls[0].getVelocity().x > 0)
+        {
+            isLeftPaddle = true;
+        }
+        publish(EVENT_POWERUP_COLLECTED, isLeftPaddle ? SIDE_LEFT : SIDE_RIGHT, powerUp.getType(),
+                powerUp.getSprite().getPosition().x, powerUp.getSprite().getPosition().y);
+
+        switch (powerUp.getType())
+        {
+        case BIGGER_PADDLE:
+            // Determinar qué jugador recibe el power-up (el que golpeó la pelota)
+            if (isLeftPaddle)
+            {
+                leftPaddle.setSize(1.5f); // Aumentar tamaño en un 50%
+                biggerLeftActive = true;
+                biggerTimerLeft.restart();
+            }
+            else
+            {
+                rightPaddle.setSize(1.5f);
+                biggerRightActive = true;
+                biggerTimerRight.restart();
+            }
+            break;
+        case SMALLER_OPPONENT:
+            if (isLeftPaddle)
+            {
+                // Si el jugador izquierdo recoge el power-up, la paleta derecha se hace más pequeña
+                rightPaddle.setSize(0.5f);
+                smallerRightActive = true;
+                smallerTimerRight.restart();
+            }
+            else
+            {
+                // Si el jugador derecho recoge el power-up, la paleta izquierda se hace más pequeña
+                leftPaddle.setSize(0.5f);
+                smallerLeftActive = true;
+                smallerTimerLeft.restart();
+            }
+            break;
+        case SLOW_BALL:
+            for (auto &ball : balls)
+            {
+                ball.slowDown(0.7f); // Reducir velocidad en un 30%
+            }
+            break;
+        case DOUBLE_BALL:
+            if (balls.size() < MAX_BALLS)
+            {
+                balls.emplace_back(textures.ball, rng, clock, fixedPoint);
+                balls.back().reset();
+            }
+            break;
+        case BARRIER:
+            // Crear una barrera para el jugador que golpeó la pelota
+            if (isLeftPaddle)
+            {
+                barrierLeftActive = true;
+                barrierTimerLeft.restart();
+                leftBarrier.setSize(Vector2f(BARRIER_WIDTH, BARRIER_HEIGHT));
+                leftBarrier.setPosition(BARRIER_MARGIN, BARRIER_Y);
+                leftBarrier.setFillColor(Color(100, 100, 255, 150));
+            }
+            else
+            {
+                barrierRightActive = true;
+                barrierTimerRight.restart();
+                rightBarrier.setSize(Vector2f(BARRIER_WIDTH, BARRIER_HEIGHT));
+                rightBarrier.setPosition(FIELD_WIDTH - BARRIER_MARGIN, BARRIER_Y);
+                rightBarrier.setFillColor(Color(255, 100, 100, 150));
+            }
+            refreshBarrierBounds();
+            break;
+        case INVERT_CONTROLS:
+            if (isLeftPaddle)
+            {
+                rightPaddle.setInvertedControls(true);
+            }
+            else
+            {
+                leftPaddle.setInvertedControls(true);
+            }
+            break;
+        case FLASHING_BALL:
+            // Hacer que todas las pelotas parpadeen durante 5 segundos
+            for (auto &ball : balls)
+            {
+                ball.startFlashing(5.0f); // 5 segundos de parpadeo
+            }
+            break;
+        case DOUBLE_POINTS:
+            doublePointsActive = true;
+            doublePointsTimer.restart();
+            break;
+        case LESS_POINTS:
+            lessPointsActive = true;
+            lessPointsTimer.restart();
+            break;
+        case FREEZE_OPPONENT:
+            if (isLeftPaddle)
+            {
+                freezeRightActive = true;
+                freezeTimerRight.restart();
+            }
+            else
+            {
+                freezeLeftActive = true;
+                freezeTimerLeft.restart();
+            }
+            break;
+        case INVISIBLE_OPPONENT:
+            if (isLeftPaddle)
+            {
+                invisibleRightActive = true;
+                invisibleTimerRight.restart();
+            }
+            else
+            {
+                invisibleLeftActive = true;
+                invisibleTimerLeft.restart();
+            }
+            break;
+        }
+    }
+
+    void handleCollisions()
+    {
+        // Colisión con las barreras
+        if (barrierLeftActive)
+        {
+            for (auto &ball : balls)
+            {
+                if (!ball.isActive())
+                    continue;
+
+                if (barriersIntersecting(ball) & (1u << SLOT_LEFT_BARRIER))
+                {
+                    // Invertir la dirección horizontal de la pelota
+                    ball.reverseX();
+                    publish(EVENT_BARRIER_HIT, SIDE_LEFT, 0, ball.getPosition().x, ball.getPosition().y);
+                    // Mover la pelota fuera de la barrera para evitar colisiones múltiples
+                    pushOutOfBarrier(ball, leftBarrier);
+                }
+            }
+        }
+
+        if (barrierRightActive)
+        {
+            for (auto &ball : balls)
+            {
+                if (!ball.isActive())
+                    continue;
+
+                if (barriersIntersecting(ball) & (1u << SLOT_RIGHT_BARRIER))
+                {
+                    // Invertir la dirección horizontal de la pelota
+                    ball.reverseX();
+                    publish(EVENT_BARRIER_HIT, SIDE_RIGHT, 0, ball.getPosition().x, ball.getPosition().y);
+                    // Mover la pelota fuera de la barrera para evitar colisiones múltiples
+                    pushOutOfBarrier(ball, rightBarrier);
+                }
+            }
+        }
+    }
+};
+
+// Resultado de un partido simulado sin ventana
+struct HeadlessResult
+{
+    int leftScore;
+    int rightScore;
+    int ticks;
+    unsigned int stateHash; // hash del estado de todos los ticks (solo si se pidió)
+};
+
+// Juega un partido IA contra IA sin ventana ni power-ups (para medir solo la IA)
+HeadlessResult playHeadlessMatch(MatchTextures &textures, const AIParams &left, const AIParams &right,
+                                 unsigned int seed, int maxScore, int maxTicks,
+                                 bool fixedPoint = false, bool hashTicks = false)
+{
+    Match match(textures, seed);
+    match.setFixedPoint(fixedPoint);
+    match.setPowerUpsEnabled(false);
+    match.setMaxScore(maxScore);
+    match.getLeftPaddle().setIsAI(true);
+    match.getRightPaddle().setIsAI(true);
+    match.getLeftPaddle().setAIParams(left);
+    match.getRightPaddle().setAIParams(right);
+    match.reset();
+
+    HeadlessResult result;
+    result.ticks = 0;
+    result.stateHash = 2166136261u;
+    while (result.ticks < maxTicks && !match.isScoreLimitReached())
+    {
+        match.tick(0.0f, 0.0f);
+        result.ticks++;
+        if (hashTicks)
+            result.stateHash = match.hashState(result.stateHash);
+    }
+    result.leftScore = match.getLeftScore();
+    result.rightScore = match.getRightScore();
+    return result;
+}
+
+// Prueba secuencial de razón de probabilidades (SPRT) sobre una proporción de victorias:
+// H0: p = p0 contra H1: p = p1. Cada partido suma su log-verosimilitud y la prueba
+// termina en cuanto cruza uno de los dos límites, así cada candidato juega solo los
+// partidos necesarios para decidir.
+class Sprt
+{
+private:
+    double winStep;
+    double lossStep;
+    double lowerBound;
+    double upperBound;
+    double llr;
+
+public:
+    enum Decision
+    {
+        CONTINUE,
+        ACCEPT_H0,
+        ACCEPT_H1
+    };
+
+    Sprt(double p0, double p1, double alpha, double beta)
+    {
+        winStep = log(p1 / p0);
+        lossStep = log((1.0 - p1) / (1.0 - p0));
+        lowerBound = log(beta / (1.0 - alpha));
+        upperBound = log((1.0 - beta) / alpha);
+        llr = 0.0;
+    }
+
+    Decision add(bool win)
+    {
+        llr += win ? winStep : lossStep;
+        if (llr >= upperBound)
+            return ACCEPT_H1;
+        if (llr <= lowerBound)
+            return ACCEPT_H0;
+        return CONTINUE;
+    }
+};
+
+// Enfrenta una IA de referencia contra una candidata en partidos sin ventana repartidos
+// entre varios hilos, hasta que la SPRT decide o se alcanza el máximo de partidos. Los
+// resultados entran a la SPRT en el orden de los partidos, no en el que terminan, así la
+// decisión no depende de los hilos ni de cuánto tarda cada partido.
+class TuningBatch
+{
+private:
+    MatchTextures &textures;
+    AIParams reference;
+    AIParams candidate;
+    unsigned int seedBase;
+    int maxScore;
+    int maxTicks;
+    int maxGames;
+
+    atomic<int> nextMatch;
+    atomic<bool> stop;
+    Mutex mutex;
+    vector<HeadlessResult> results; // por índice de partido
+    vector<char> finished;          // 1 si results[índice] ya está
+
+    void worker()
+    {
+        while (!stop)
+        {
+            int index = nextMatch++;
+            if (index >= maxGames)
+                break;
+
+            // Alternar lados para cancelar cualquier ventaja de un lado de la cancha
+            bool referenceLeft = index % 2 == 0;
+            HeadlessResult result = playHeadlessMatch(textures, referenceLeft ? reference : candidate,
+                                                      referenceLeft ? candidate : reference,
+                                                      seedBase + index, maxScore, maxTicks);
+            Lock lock(mutex);
+            results[index] = result;
+            finished[index] = 1;
+        }
+    }
+
+public:
+    int games;
+    int referenceWins;
+    int draws;
+
+    TuningBatch(MatchTextures &t, const AIParams &referenceParams, const AIParams &candidateParams,
+                unsigned int seed, int score, int ticks)
+        : textures(t), reference(referenceParams), candidate(candidateParams), seedBase(seed),
+          maxScore(score), maxTicks(ticks), maxGames(0), nextMatch(0), stop(false), games(0), referenceWins(0), draws(0)
+    {
+    }
+
+    Sprt::Decision run(Sprt &sprt, int gameLimit, int threadCount)
+    {
+        maxGames = gameLimit;
+        results.assign(maxGames, HeadlessResult());
+        finished.assign(maxGames, 0);
+
+        vector<Thread *> threads;
+        for (int i = 0; i < threadCount; i++)
+        {
+            threads.push_back(new Thread(&TuningBatch::worker, this));
+            threads.back()->launch();
+        }
+
+        Sprt::Decision decision = Sprt::CONTINUE;
+        while (decision == Sprt::CONTINUE && games < maxGames)
+        {
+            // El siguiente partido en orden; los que terminaron antes esperan su turno
+            HeadlessResult result;
+            bool ready;
+            {
+                Lock lock(mutex);
+                ready = finished[games] != 0;
+                if (ready)
+                    result = results[games];
+            }
+            if (!ready)
+            {
+                sleep(milliseconds(1));
+                continue;
+            }
+
+            bool referenceLeft = games % 2 == 0;
+            int referenceScore = referenceLeft ? result.leftScore : result.rightScore;
+            int candidateScore = referenceLeft ? result.rightScore : result.leftScore;
+
+            // "Ganarle" es ganar el partido: un empate cuenta como no ganar
+            games++;
+            if (referenceScore == candidateScore)
+                draws++;
+            if (referenceScore > candidateScore)
+                referenceWins++;
+            decision = sprt.add(referenceScore > candidateScore);
+        }
+
+        stop = true;
+        for (Thread *thread : threads)
+        {
+            thread->wait();
+            delete thread;
+        }
+        return decision;
+    }
+};
+
+// Parámetros de la IA sobre una curva de "fuerza" en [0, 1]: 0 es la IA más torpe
+// considerada y 1 es IMPOSSIBLE. Buscar sobre esta curva reduce el ajuste a una bisección.
+AIParams interpolateAIParams(float strength)
+{
+    const AIParams weakest = {0.95f, 0.05f, 150.0f};
+    const AIParams &strongest = AI_LEVEL_PARAMS[IMPOSSIBLE];
+    AIParams params;
+    params.errorChance = weakest.errorChance + (strongest.errorChance - weakest.errorChance) * strength;
+    params.speedFactor = weakest.speedFactor + (strongest.speedFactor - weakest.speedFactor) * strength;
+    params.errorAmount = weakest.errorAmount + (strongest.errorAmount - weakest.errorAmount) * strength;
+    return params;
+}
+
+// Ajusta EASY, MEDIUM y HARD para que cada nivel le gane al inmediato inferior con la
+// proporción objetivo (IMPOSSIBLE queda fijo como referencia). Imprime la tabla lista
+// para reemplazar AI_LEVEL_PARAMS.
+void tuneAILevels(float targetWinRate, int maxGamesPerCandidate)
+{
+    MatchTextures textures;
+    textures.load();
+
+    const float margin = 0.05f;
+    const int maxScore = 7;
+    const int maxTicks = 3 * 60 * TICK_RATE; // partido de 3 minutos
+    const int bisectionSteps = 8;
+    int threadCount = getCpuCount();
+
+    cout << "Ajuste de IA: objetivo " << targetWinRate * 100 << "% contra el nivel inferior, "
+         << threadCount << " hilos" << endl;
+
+    AIParams tuned[4];
+    tuned[IMPOSSIBLE] = AI_LEVEL_PARAMS[IMPOSSIBLE];
+    const char *names[4] = {"EASY", "MEDIUM", "HARD", "IMPOSSIBLE"};
+    unsigned int seed = 12345;
+    Clock clock;
+
+    for (int level = HARD; level >= EASY; level--)
+    {
+        float low = 0.0f;
+        float high = 1.0f;
+        float strength = 0.5f;
+        int totalGames = 0;
+
+        for (int step = 0; step < bisectionSteps; step++)
+        {
+            strength = (low + high) / 2;
+            Sprt sprt(targetWinRate - margin, targetWinRate + margin, 0.05, 0.05);
+            TuningBatch batch(textures, tuned[level + 1], interpolateAIParams(strength), seed, maxScore, maxTicks);
+            Sprt::Decision decision = batch.run(sprt, maxGamesPerCandidate, threadCount);
+            seed += batch.games + 1000;
+            totalGames += batch.games;
+
+            cout << "  " << names[level] << " fuerza " << strength << ": " << batch.games << " partidos, "
+                 << batch.referenceWins << " victorias de " << names[level + 1] << ", " << batch.draws << " empates -> ";
+
+            if (decision == Sprt::ACCEPT_H1)
+            {
+                // El nivel superior gana demasiado: la candidata es demasiado débil
+                cout << "debil" << endl;
+                low = strength;
+            }
+            else if (decision == Sprt::ACCEPT_H0)
+            {
+                cout << "fuerte" << endl;
+                high = strength;
+            }
+            else
+            {
+                // Sin decisión dentro del máximo de partidos: no prueba que esté dentro del
+                // margen, así que se sigue bisecando según la proporción observada
+                float observed = (float)batch.referenceWins / max(1, batch.games);
+                cout << "sin decision (" << observed * 100 << "% observado)" << endl;
+                if (observed > targetWinRate)
+                    low = strength;
+                else
+                    high = strength;
+            }
+        }
+        strength = (low + high) / 2;
+
+        tuned[level] = interpolateAIParams(strength);
+        cout << names[level] << ": fuerza " << strength << " tras " << totalGames << " partidos" << endl;
+    }
+
+    cout << "Tiempo total: " << clock.getElapsedTime().asSeconds() << " s" << endl << endl;
+    cout << fixed << setprecision(3) << "constexpr AIParams AI_LEVEL_PARAMS[4] = {" << endl;
+    for (int level = EASY; level <= IMPOSSIBLE; level++)
+    {
+        cout << "    {" << tuned[level].errorChance << "f, " << tuned[level].speedFactor << "f, "
+             << tuned[level].errorAmount << "f}, // " << names[level] << endl;
+    }
+    cout << "};" << endl;
+}
+
+// Partidos de la verificación de punto fijo: combina todos los niveles de IA entre sí
+HeadlessResult playFixedCheckMatch(MatchTextures &textures, int index, bool fixedPoint, bool hashTicks)
+{
+    return playHeadlessMatch(textures, AI_LEVEL_PARAMS[index % 4], AI_LEVEL_PARAMS[(index / 4) % 4],
+                             1 + index, 7, TICK_RATE * 60 * 5, fixedPoint, hashTicks);
+}
+
+// Repite los partidos de la verificación en varios hilos para detectar estado compartido
+class FixedPointCheckWorkers
+{
+private:
+    MatchTextures &textures;
+    atomic<int> nextMatch;
+
+    void worker()
+    {
+        int index;
+        while ((index = nextMatch++) < (int)hashes.size())
+        {
+            hashes[index] = playFixedCheckMatch(textures, index, true, true).stateHash;
+        }
+    }
+
+public:
+    vector<unsigned int> hashes;
+
+    FixedPointCheckWorkers(MatchTextures &t, int matchCount) : textures(t), nextMatch(0), hashes(matchCount, 0) {}
+
+    void run(int threadCount)
+    {
+        vector<Thread *> threads;
+        for (int i = 0; i < threadCount; i++)
+        {
+            threads.push_back(new Thread(&FixedPointCheckWorkers::worker, this));
+            threads.back()->launch();
+        }
+        for (Thread *thread : threads)
+        {
+            thread->wait();
+            delete thread;
+        }
+    }
+};
+
+// Verificación bit a bit de la física en punto fijo. Simula los mismos partidos en serie y
+// en paralelo, exige que coincidan tick a tick e imprime un hash del conjunto. Para comparar
+// entre compilaciones (otro compilador, -O0, -ffast-math...) se ejecuta en cada una y se pasa
+// el hash de la de referencia como segundo argumento. Devuelve el código de salida.
+int checkFixedPoint(int matchCount, const char *expectedHash)
+{
+    MatchTextures textures;
+    textures.load();
+
+    vector<unsigned int> hashes;
+    unsigned int combined = 2166136261u;
+    int ticks = 0;
+    for (int i = 0; i < matchCount; i++)
+    {
+        HeadlessResult result = playFixedCheckMatch(textures, i, true, true);
+        hashes.push_back(result.stateHash);
+        combined = (combined ^ result.stateHash) * 16777619u;
+        ticks += result.ticks;
+    }
+
+    FixedPointCheckWorkers workers(textures, matchCount);
+    workers.run(getCpuCount());
+
+    int failures = 0;
+    for (int i = 0; i < matchCount; i++)
+    {
+        if (workers.hashes[i] != hashes[i])
+        {
+            cout << "Partido " << i << ": la simulacion en paralelo no coincide con la serie" << endl;
+            failures++;
+        }
+    }
+
+    cout << matchCount << " partidos, " << ticks << " ticks" << endl;
+    cout << "Hash de la fisica en punto fijo: " << hex << setw(8) << setfill('0') << combined << dec << endl;
+
+    if (expectedHash)
+    {
+        unsigned int expected = (unsigned int)strtoul(expectedHash, nullptr, 16);
+        if (expected != combined)
+        {
+            cout << "FALLO: se esperaba " << hex << setw(8) << setfill('0') << expected << dec << endl;
+            failures++;
+        }
+    }
+
+    cout << (failures == 0 ? "OK" : "FALLO") << endl;
+    return failures == 0 ? 0 : 1;
+}
+
+// Compara el costo por tick de la física en float y en punto fijo con los mismos partidos
+void benchmarkPhysics(int matchCount)
+{
+    MatchTextures textures;
+    textures.load();
+
+    double microsecondsPerTick[2];
+    for (int mode = 0; mode < 2; mode++)
+    {
+        bool fixedPoint = mode == 1;
+        long long ticks = 0;
+        Clock clock;
+        for (int i = 0; i < matchCount; i++)
+        {
+            ticks += playFixedCheckMatch(textures, i, fixedPoint, false).ticks;
+        }
+        double seconds = clock.getElapsedTime().asSeconds();
+        microsecondsPerTick[mode] = seconds * 1000000.0 / max(1LL, ticks);
+
+        cout << (fixedPoint ? "Punto fijo: " : "Float:      ") << ticks << " ticks en " << fixed << setprecision(3)
+             << seconds << " s (" << microsecondsPerTick[mode] << " us/tick)" << endl;
+    }
+    cout << "Punto fijo / float: " << setprecision(2) << microsecondsPerTick[1] / microsecondsPerTick[0] << "x" << endl;
+}
+
+// Pruebas de una pelota contra paletas, barreras y power-ups: el camino anterior, con una
+// llamada a getGlobalBounds por prueba, contra las cajas guardadas en CollisionBoxes, probadas
+// de a una (escalar) y de a cuatro (SSE). Todos los caminos tienen que dar las mismas máscaras.
+void benchmarkCollisions(int ticks)
+{
+    const int BALLS_PER_TICK = 2;
+    MatchTextures textures;
+    textures.load();
+    Random rng(1);
+    SimulationClock clock;
+
+    Paddle leftPaddle(textures.paddle, true);
+    Paddle rightPaddle(textures.paddle, false);
+    RectangleShape barriers[2];
+    barriers[0].setSize(Vector2f(BARRIER_WIDTH, BARRIER_HEIGHT));
+    barriers[0].setPosition(BARRIER_MARGIN, BARRIER_Y);
+    barriers[1].setSize(Vector2f(BARRIER_WIDTH, BARRIER_HEIGHT));
+    barriers[1].setPosition(FIELD_WIDTH - BARRIER_MARGIN, BARRIER_Y);
+    FloatRect barrierBounds[2] = {barriers[0].getGlobalBounds(), barriers[1].getGlobalBounds()}; // como Match, al aparecer
+    vector<PowerUp> powerUps;
+    for (int i = 0; i < 3; i++)
+    {
+        powerUps.emplace_back(static_cast<PowerUpType>(i), textures.powerUps[i], rng, clock);
+    }
+
+    // Pelotas repartidas por todo el campo; casi todas las pruebas fallan, como en un partido
+    vector<Vector2f> positions(ticks * BALLS_PER_TICK);
+    for (auto &position : positions)
+    {
+        position = Vector2f((float)(rng.next() % FIELD_WIDTH), (float)(HEADER_HEIGHT + rng.next() % (FIELD_HEIGHT - HEADER_HEIGHT)));
+    }
+
+    const char *names[3] = {"getGlobalBounds", "cajas, escalar ", "cajas, SSE     "};
+    double nanosecondsPerBall[3];
+    unsigned long long checksums[3];
+    for (int mode = 0; mode < 3; mode++)
+    {
+        CollisionBoxes boxes;
+        unsigned long long checksum = 0;
+        Clock timer;
+        for (int t = 0; t < ticks; t++)
+        {
+            // Las paletas se mueven en cada tick; con cajas guardadas eso cuesta un refreshBounds
+            float y = (float)(150 + t % 300);
+            leftPaddle.getSprite().setPosition(leftPaddle.getSprite().getPosition().x, y);
+            rightPaddle.getSprite().setPosition(rightPaddle.getSprite().getPosition().x, 600 - y);
+            if (mode > 0)
+            {
+                leftPaddle.refreshBounds();
+                rightPaddle.refreshBounds();
+                boxes.set(SLOT_RIGHT_PADDLE, rightPaddle.getBounds());
+                boxes.set(SLOT_LEFT_PADDLE, leftPaddle.getBounds());
+                boxes.set(SLOT_LEFT_BARRIER, barrierBounds[0]);
+                boxes.set(SLOT_RIGHT_BARRIER, barrierBounds[1]);
+                for (int i = 0; i < (int)powerUps.size(); i++)
+                {
+                    boxes.set(SLOT_FIRST_POWER_UP + i, powerUps[i].getBounds());
+                }
+            }
+
+            for (int b = 0; b < BALLS_PER_TICK; b++)
+            {
+                Vector2f position = positions[t * BALLS_PER_TICK + b];
+                unsigned int mask = 0;
+                if (mode == 0)
+                {
+                    mask |= rightPaddle.getSprite().getGlobalBounds().contains(position) ? 1u << SLOT_RIGHT_PADDLE : 0;
+                    mask |= leftPaddle.getSprite().getGlobalBounds().contains(position) ? 1u << SLOT_LEFT_PADDLE : 0;
+                    mask |= barriers[0].getGlobalBounds().contains(position) ? 1u << SLOT_LEFT_BARRIER : 0;
+                    mask |= barriers[1].getGlobalBounds().contains(position) ? 1u << SLOT_RIGHT_BARRIER : 0;
+                    for (int i = 0; i < (int)powerUps.size(); i++)
+                    {
+                        mask |= powerUps[i].getSprite().getGlobalBounds().contains(position) ? 1u << (SLOT_FIRST_POWER_UP + i) : 0;
+                    }
+                }
+                else if (mode == 1)
+                {
+                    mask = boxes.containsMaskScalar(position.x, position.y);
+                }
+                else
+                {
+                    mask = boxes.containsMask(position.x, position.y);
+                }
+                checksum = checksum * 31 + mask;
+            }
+        }
+        nanosecondsPerBall[mode] = timer.getElapsedTime().asMicroseconds() * 1000.0 / max(1, ticks * BALLS_PER_TICK);
+        checksums[mode] = checksum;
+
+        cout << names[mode] << ": " << fixed << setprecision(1) << nanosecondsPerBall[mode] << " ns por pelota ("
+             << setprecision(2) << nanosecondsPerBall[0] / max(0.001, nanosecondsPerBall[mode]) << "x)" << endl;
+    }
+#ifndef PONG_SIMD_COLLISIONS
+    cout << "Compilado sin SSE: el camino SSE usa el núcleo escalar" << endl;
+#endif
+    if (checksums[1] != checksums[0] || checksums[2] != checksums[0])
+    {
+        cout << "Las cajas guardadas no dan los mismos golpes que getGlobalBounds" << endl;
+    }
+}
+
+// Reinicios de partido por segundo y memoria de cada partido. Con -DPONG_INSTRUMENT también
+// cuenta las operaciones del heap global al crear partidos, al reiniciarlos y en los goles.
+void benchmarkMatchMemory(int resets)
+{
+    MatchTextures textures;
+    textures.load();
+    instrumentBegin();
+
+    long long heapStart = instrumentHeapOperations();
+    Match *match = new Match(textures, 1234);
+    long long heapCreate = instrumentHeapOperations() - heapStart;
+    match->getLeftPaddle().setIsAI(true);
+    match->getRightPaddle().setIsAI(true);
+    match->setMaxScore(1000);
+
+    heapStart = instrumentHeapOperations();
+    Clock clock;
+    for (int i = 0; i < resets; i++)
+    {
+        match->reset();
+    }
+    double seconds = max(clock.getElapsedTime().asSeconds(), 1e-6f);
+
+    // Partidos con power-ups hasta 20 goles, para pasar por el camino que recrea las pelotas
+    int goals = 0;
+    for (int i = 0; i < 100; i++)
+    {
+        match->reset();
+        while (match->getLeftScore() + match->getRightScore() < 20 && match->getClock().getTicks() < (Uint32)TICK_RATE * 600)
+        {
+            match->tick(0.0f, 0.0f);
+        }
+        goals += match->getLeftScore() + match->getRightScore();
+    }
+    long long heapPlay = instrumentHeapOperations() - heapStart;
+
+    const BumpArena &memory = match->getMemory();
+    cout << "Reinicios: " << resets << " en " << seconds * 1000 << " ms (" << (Uint64)(resets / seconds) << " reinicios/s, "
+         << seconds * 1e9 / max(1, resets) << " ns cada uno)" << endl;
+    cout << "Memoria del partido: un bloque de " << memory.getCapacity() << " bytes (maximo usado " << memory.getHighWater()
+         << ") para pelotas y power-ups" << endl;
+    if (instrumentHeapOperations() < 0)
+    {
+        cout << "Operaciones del heap: compilar con -DPONG_INSTRUMENT para contarlas" << endl;
+    }
+    else
+    {
+        cout << "Operaciones del heap: " << heapCreate << " al crear el partido, " << heapPlay << " en " << resets + 100
+             << " reinicios y " << goals << " goles" << endl;
+    }
+    delete match;
+}
+
+// Costo de la telemetría: los mismos partidos IA contra IA (con power-ups) con y sin registro.
+// Se alternan las dos variantes tres veces y se toma la mejor de cada una.
+void benchmarkTelemetry(int matchCount)
+{
+    MatchTextures textures;
+    textures.load();
+
+    double microsecondsPerTick[2] = {1e9, 1e9};
+    for (int run = 0; run < 6; run++)
+    {
+        int mode = run % 2;
+        Telemetry *telemetry = mode == 1 ? new Telemetry("bench_telemetria.bin") : nullptr;
+        long long ticks = 0;
+        Clock clock;
+        for (int i = 0; i < matchCount; i++)
+        {
+            Match match(textures, 1 + i);
+            if (telemetry)
+                match.subscribe(&telemetry->getQueue());
+            match.getLeftPaddle().setIsAI(true);
+            match.getRightPaddle().setIsAI(true);
+            match.getLeftPaddle().setAILevel(static_cast<AILevel>(i % 4));
+            match.getRightPaddle().setAILevel(static_cast<AILevel>((i / 4) % 4));
+            match.reset();
+            for (int t = 0; t < TICK_RATE * 60 * 3 && !match.isScoreLimitReached(); t++)
+            {
+                match.tick(0.0f, 0.0f);
+                ticks++;
+            }
+        }
+        double seconds = clock.getElapsedTime().asSeconds();
+        microsecondsPerTick[mode] = min(microsecondsPerTick[mode], seconds * 1000000.0 / max(1LL, ticks));
+
+        if (telemetry)
+        {
+            telemetry->finish();
+            if (run == 5)
+                telemetry->printStats();
+            delete telemetry;
+        }
+    }
+    remove("bench_telemetria.bin");
+    cout << fixed << setprecision(3) << "Sin telemetria: " << microsecondsPerTick[0] << " us/tick" << endl;
+    cout << "Con telemetria: " << microsecondsPerTick[1] << " us/tick" << endl;
+    cout << "Sobrecosto: " << setprecision(2) << (microsecondsPerTick[1] / microsecondsPerTick[0] - 1.0) * 100.0 << " %" << endl;
+}
+
+// Prueba de estrés: partidos al azar (configuración, entradas de los jugadores humanos y
+// power-ups forzados) con las invariantes del partido verificadas después de cada tick.
+// Todo sale de la semilla del caso, así que una semilla que falla se puede reproducir y
+// reducir quitando acciones mientras siga fallando de la misma manera.
+const int SOAK_MAX_TICKS = TICK_RATE * 60 * 3; // partido de 3 minutos
+const int SOAK_STUCK_TICKS = TICK_RATE / 4;     // más que esto dentro de una paleta o una pared es estar atrapada
+const int SOAK_MAX_REDUCED = 8;                 // fallos distintos que se reducen al final
+
+enum SoakActionType
+{
+    SOAK_LEFT_AXIS,
+    SOAK_RIGHT_AXIS,
+    SOAK_POWER_UP
+};
+
+struct SoakAction
+{
+    int tick;
+    SoakActionType type;
+    float axis;          // SOAK_LEFT_AXIS y SOAK_RIGHT_AXIS: eje hasta la próxima acción de ese lado
+    PowerUpType powerUp; // SOAK_POWER_UP
+};
+
+struct SoakCase
+{
+    unsigned int seed;
+    unsigned int matchSeed;
+    bool fixedPoint;
+    bool powerUps; // aparición normal cada 10 segundos, además de las forzadas
+    bool leftAI;
+    bool rightAI;
+    AILevel leftLevel;
+    AILevel rightLevel;
+    int maxScore;
+    vector<SoakAction> actions; // ordenadas por tick
+};
+
+struct SoakFailure
+{
+    bool failed;
+    int tick;
+    const char *message;
+};
+
+SoakCase makeSoakCase(unsigned int seed)
+{
+    Random random(seed * 2654435761u + 1);
+    SoakCase soakCase;
+    soakCase.seed = seed;
+    soakCase.matchSeed = (unsigned int)random.next();
+    soakCase.fixedPoint = random.next() % 2 == 0;
+    soakCase.powerUps = random.next() % 4 != 0;
+    soakCase.leftAI = random.next() % 2 == 0;
+    soakCase.rightAI = random.next() % 2 == 0;
+    soakCase.leftLevel = static_cast<AILevel>(random.next() % 4);
+    soakCase.rightLevel = static_cast<AILevel>(random.next() % 4);
+    soakCase.maxScore = 1 + random.next() % 15;
+
+    // Pulsaciones de duración al azar (ejes parciales incluidos) y power-ups cada pocos segundos
+    const float axes[] = {-1.0f, -0.5f, 0.0f, 0.0f, 0.5f, 1.0f};
+    for (int tick = random.next() % TICK_RATE; tick < SOAK_MAX_TICKS; tick += 1 + random.next() % TICK_RATE)
+    {
+        SoakAction action;
+        action.tick = tick;
+        action.type = static_cast<SoakActionType>(random.next() % 3);
+        action.axis = axes[random.next() % 6];
+        action.powerUp = static_cast<PowerUpType>(random.next() % (INVISIBLE_OPPONENT + 1));
+        if (action.type == SOAK_POWER_UP && random.next() % 2 == 0)
+            continue; // menos power-ups que pulsaciones
+        soakCase.actions.push_back(action);
+    }
+    return soakCase;
+}
+
+// Juega el caso con las acciones habilitadas y devuelve la primera invariante que falla
+SoakFailure runSoakCase(MatchTextures &textures, const SoakCase &soakCase, const vector<bool> &enabled, long long &ticks)
+{
+    Match match(textures, soakCase.matchSeed);
+    match.setFixedPoint(soakCase.fixedPoint);
+    match.setPowerUpsEnabled(soakCase.powerUps);
+    match.setMaxScore(soakCase.maxScore);
+    match.getLeftPaddle().setIsAI(soakCase.leftAI);
+    match.getRightPaddle().setIsAI(soakCase.rightAI);
+    match.getLeftPaddle().setAILevel(soakCase.leftLevel);
+    match.getRightPaddle().setAILevel(soakCase.rightLevel);
+    match.reset();
+
+    SoakFailure failure = {false, 0, nullptr};
+    float leftAxis = 0.0f;
+    float rightAxis = 0.0f;
+    int insidePaddleTicks[2] = {0, 0}; // por índice de pelota
+    int insideWallTicks[2] = {0, 0};
+    size_t next = 0;
+    for (int tick = 0; tick < SOAK_MAX_TICKS && !match.isScoreLimitReached(); tick++)
+    {
+        for (; next < soakCase.actions.size() && soakCase.actions[next].tick <= tick; next++)
+        {
+            if (!enabled[next])
+                continue;
+            const SoakAction &action = soakCase.actions[next];
+            if (action.type == SOAK_LEFT_AXIS)
+                leftAxis = action.axis;
+            else if (action.type == SOAK_RIGHT_AXIS)
+                rightAxis = action.axis;
+            else
+                match.forcePowerUp(action.powerUp);
+        }
+
+        match.tick(leftAxis, rightAxis);
+        ticks++;
+
+        failure.tick = tick;
+        failure.message = match.checkInvariants();
+
+        // Un rebote normal deja la pelota uno o dos ticks dentro de la paleta o pasada de la pared
+        const BallList &balls = match.getBalls();
+        for (size_t i = 0; i < balls.size() && i < 2 && !failure.message; i++)
+        {
+            Vector2f position = balls[i].getPosition();
+            float half = balls[i].getSprite().getGlobalBounds().height / 2;
+            bool inPaddle = match.getLeftPaddle().getSprite().getGlobalBounds().contains(position) ||
+                            match.getRightPaddle().getSprite().getGlobalBounds().contains(position);
+            bool inWall = position.y < HEADER_HEIGHT + half || position.y > FIELD_HEIGHT - half;
+            insidePaddleTicks[i] = inPaddle ? insidePaddleTicks[i] + 1 : 0;
+            insideWallTicks[i] = inWall ? insideWallTicks[i] + 1 : 0;
+            if (insidePaddleTicks[i] > SOAK_STUCK_TICKS)
+                failure.message = "pelota atrapada dentro de una paleta";
+            else if (insideWallTicks[i] > SOAK_STUCK_TICKS)
+                failure.message = "pelota atrapada en una pared";
+        }
+        if (failure.message)
+        {
+            failure.failed = true;
+            return failure;
+        }
+    }
+    return failure;
+}
+
+// Quita acciones (mitades, cuartos... hasta de a una) y la aparición normal de power-ups
+// mientras el caso siga fallando con la misma invariante
+vector<bool> reduceSoakCase(MatchTextures &textures, SoakCase &soakCase, SoakFailure &failure, int &runs)
+{
+    long long ticks = 0;
+    vector<bool> enabled(soakCase.actions.size(), true);
+    for (size_t i = 0; i < enabled.size(); i++)
+    {
+        if (soakCase.actions[i].tick > failure.tick)
+            enabled[i] = false; // las acciones posteriores al fallo no pueden causarlo
+    }
+
+    if (soakCase.powerUps)
+    {
+        soakCase.powerUps = false;
+        SoakFailure result = runSoakCase(textures, soakCase, enabled, ticks);
+        runs++;
+        if (result.failed && strcmp(result.message, failure.message) == 0)
+            failure = result;
+        else
+            soakCase.powerUps = true;
+    }
+
+    vector<size_t> active;
+    for (size_t i = 0; i < enabled.size(); i++)
+    {
+        if (enabled[i])
+            active.push_back(i);
+    }
+    size_t chunk = max((size_t)1, active.size() / 2);
+    while (!active.empty())
+    {
+        bool removed = false;
+        for (size_t start = 0; start < active.size();)
+        {
+            vector<bool> candidate = enabled;
+            size_t end = min(active.size(), start + chunk);
+            for (size_t i = start; i < end; i++)
+                candidate[active[i]] = false;
+
+            SoakFailure result = runSoakCase(textures, soakCase, candidate, ticks);
+            runs++;
+            if (result.failed && strcmp(result.message, failure.message) == 0)
+            {
+                enabled = candidate;
+                failure = result;
+                active.erase(active.begin() + start, active.begin() + end);
+                removed = true;
+            }
+            else
+            {
+                start = end;
+            }
+        }
+        if (!removed)
+        {
+            if (chunk == 1)
+                break;
+            chunk = max((size_t)1, chunk / 2);
+        }
+    }
+    return enabled;
+}
+
+void printSoakCase(const SoakCase &soakCase, const vector<bool> &enabled, const SoakFailure &failure)
+{
+    const char *levels[4] = {"EASY", "MEDIUM", "HARD", "IMPOSSIBLE"};
+    int count = 0;
+    for (bool on : enabled)
+        count += on;
+    cout << "  semilla " << soakCase.seed << ": " << failure.message << " en el tick " << failure.tick << endl;
+    cout << "    " << (soakCase.fixedPoint ? "punto fijo" : "float") << ", power-ups " << (soakCase.powerUps ? "si" : "no")
+         << ", hasta " << soakCase.maxScore << " puntos, izquierda " << (soakCase.leftAI ? levels[soakCase.leftLevel] : "humano")
+         << ", derecha " << (soakCase.rightAI ? levels[soakCase.rightLevel] : "humano") << endl;
+    cout << "    " << count << " de " << soakCase.actions.size() << " acciones necesarias" << (count > 0 ? ":" : "") << endl;
+    for (size_t i = 0; i < soakCase.actions.size(); i++)
+    {
+        if (!enabled[i])
+            continue;
+        const SoakAction &action = soakCase.actions[i];
+        cout << "      tick " << action.tick << ": ";
+        if (action.type == SOAK_POWER_UP)
+            cout << "power-up " << POWER_UP_NAMES[action.powerUp] << endl;
+        else
+            cout << (action.type == SOAK_LEFT_AXIS ? "eje izquierdo " : "eje derecho ") << action.axis << endl;
+    }
+}
+
+// Reparte semillas consecutivas entre los hilos hasta que se acaba el tiempo
+class SoakWorkers
+{
+private:
+    MatchTextures &textures;
+    unsigned int firstSeed;
+    Int64 deadlineMicroseconds;
+    Clock clock;
+    atomic<unsigned int> nextSeed;
+    Mutex mutex;
+
+    void worker()
+    {
+        long long ticks = 0;
+        vector<bool> enabled;
+        while (clock.getElapsedTime().asMicroseconds() < deadlineMicroseconds)
+        {
+            unsigned int seed = nextSeed++;
+            SoakCase soakCase = makeSoakCase(seed);
+            enabled.assign(soakCase.actions.size(), true);
+            SoakFailure failure = runSoakCase(textures, soakCase, enabled, ticks);
+
+            Lock lock(mutex);
+            matches++;
+            if (failure.failed)
+                failures.push_back(make_pair(seed, failure));
+        }
+        Lock lock(mutex);
+        totalTicks += ticks;
+    }
+
+public:
+    long long totalTicks;
+    long long matches;
+    vector<pair<unsigned int, SoakFailure> > failures;
+
+    SoakWorkers(MatchTextures &t, unsigned int seed, double seconds)
+        : textures(t), firstSeed(seed), deadlineMicroseconds((Int64)(seconds * 1000000)), nextSeed(seed), totalTicks(0), matches(0)
+    {
+    }
+
+    double run(int threadCount)
+    {
+        clock.restart();
+        vector<Thread *> threads;
+        for (int i = 0; i < threadCount; i++)
+        {
+            threads.push_back(new Thread(&SoakWorkers::worker, this));
+            threads.back()->launch();
+        }
+        for (Thread *thread : threads)
+        {
+            thread->wait();
+            delete thread;
+        }
+        return clock.getElapsedTime().asSeconds();
+    }
+};
+
+// Corre partidos al azar en todos los núcleos durante el tiempo pedido, informa los ticks
+// verificados por segundo y reduce las semillas que fallan (una por invariante distinta).
+// Con onlySeed >= 0 reproduce y reduce solo esa semilla. Devuelve el código de salida.
+int soakTest(double seconds, int threadCount, unsigned int firstSeed, long long onlySeed)
+{
+    MatchTextures textures;
+    textures.load();
+
+    vector<pair<unsigned int, SoakFailure> > failures;
+    if (onlySeed >= 0)
+    {
+        long long ticks = 0;
+        SoakCase soakCase = makeSoakCase((unsigned int)onlySeed);
+        vector<bool> enabled(soakCase.actions.size(), true);
+        SoakFailure failure = runSoakCase(textures, soakCase, enabled, ticks);
+        cout << "Semilla " << onlySeed << ": " << ticks << " ticks" << (failure.failed ? "" : ", todas las invariantes se cumplen") << endl;
+        if (failure.failed)
+            failures.push_back(make_pair((unsigned int)onlySeed, failure));
+    }
+    else
+    {
+        cout << "Prueba de estres: " << threadCount << " hilos durante " << seconds << " s desde la semilla " << firstSeed << endl;
+        SoakWorkers workers(textures, firstSeed, seconds);
+        double elapsed = workers.run(max(1, threadCount));
+        failures = workers.failures;
+        sort(failures.begin(), failures.end(), [](const pair<unsigned int, SoakFailure> &a, const pair<unsigned int, SoakFailure> &b)
+             { return a.first < b.first; });
+        cout << workers.matches << " partidos, " << workers.totalTicks << " ticks verificados en " << fixed << setprecision(1) << elapsed
+             << " s (" << (Uint64)(workers.totalTicks / max(elapsed, 1e-6)) << " ticks/s), " << failures.size() << " fallaron" << endl;
+    }
+
+    // Reducir la primera semilla de cada invariante distinta
+    vector<string> reduced;
+    for (const auto &entry : failures)
+    {
+        string message = entry.second.message;
+        if (find(reduced.begin(), reduced.end(), message) != reduced.end() || (int)reduced.size() >= SOAK_MAX_REDUCED)
+            continue;
+        reduced.push_back(message);
+
+        SoakCase soakCase = makeSoakCase(entry.first);
+        SoakFailure failure = entry.second;
+        int runs = 0;
+        vector<bool> enabled = reduceSoakCase(textures, soakCase, failure, runs);
+        printSoakCase(soakCase, enabled, failure);
+        cout << "    (reducido en " << runs << " re-simulaciones; reproducir con --soak-seed " << entry.first << ")" << endl;
+    }
+    return failures.empty() ? 0 : 1;
+}
+
+// Repeticiones (.rpl). Formato del archivo:
+//   ReplayHeader
+//   por cada tick un byte con los ejes de entrada que cambiaron respecto del tick anterior
+//   (bit 0 izquierdo, bit 1 derecho) seguido de los floats nuevos; cada
+//   REPLAY_KEYFRAME_INTERVAL ticks, antes de ese byte, un ReplayKeyframe con la instantánea
+//   completa del partido
+//   al final, el índice de keyframes (ReplayIndexEntry) y el ReplayFooter que lo ubica
+// Como los keyframes son regulares, ir a un tick es una división para encontrar el keyframe
+// más una re-simulación de como mucho un intervalo.
+const Uint32 REPLAY_VERSION = 1;
+const Uint32 REPLAY_KEYFRAME_INTERVAL = 2 * TICK_RATE;
+
+struct ReplayHeader
+{
+    char magic[8]; // "PONGRPL"
+    Uint32 version;
+    Uint32 tickRate;
+    Uint32 keyframeInterval;
+    Uint32 snapshotSize; // sizeof(MatchSnapshot) de la compilación que grabó
+};
+
+struct ReplayKeyframe
+{
+    Uint32 tick;
+    Uint32 stateHash;   // Match::hashState, para detectar desincronizaciones al reproducir
+    float leftAxis;     // entrada del tick anterior: base de los deltas que siguen
+    float rightAxis;
+    MatchSnapshot snapshot;
+};
+
+struct ReplayIndexEntry
+{
+    Uint32 tick;
+    Uint32 reserved;
+    Uint64 offset;
+};
+
+struct ReplayFooter
+{
+    Uint64 indexOffset;
+    Uint32 keyframeCount;
+    Uint32 tickCount;
+    char magic[8]; // "PONGIDX"
+};
+
+// Graba un partido a medida que se juega; Game llama a record() antes de cada tick
+class ReplayWriter
+{
+private:
+    string path;
+    ofstream file;
+    Uint64 offset; // bytes escritos, para el índice sin consultar la posición del archivo
+    vector<ReplayIndexEntry> index;
+    Uint32 tickCount;
+    float lastLeftAxis;
+    float lastRightAxis;
+
+    void write(const void *bytes, size_t size)
+    {
+        file.write(static_cast<const char *>(bytes), size);
+        offset += size;
+    }
+
+public:
+    explicit ReplayWriter(const string &outputPath) : path(outputPath), offset(0), tickCount(0) {}
+
+    ~ReplayWriter()
+    {
+        finish();
+    }
+
+    // Empieza a grabar un partido recién reiniciado (reemplaza la repetición anterior)
+    void begin()
+    {
+        finish();
+        file.open(path.c_str(), ios::binary | ios::trunc);
+        if (!file)
+        {
+            cout << "Error al crear " << path << endl;
+            return;
+        }
+
+        ReplayHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "PONGRPL", 8);
+        header.version = REPLAY_VERSION;
+        header.tickRate = TICK_RATE;
+        header.keyframeInterval = REPLAY_KEYFRAME_INTERVAL;
+        header.snapshotSize = sizeof(MatchSnapshot);
+        offset = 0;
+        write(&header, sizeof(header));
+
+        // Capacidad para el partido más largo que permite el menú, más un minuto de margen, así
+        // no se reserva memoria jugando
+        index.clear();
+        index.reserve((MAX_GAME_DURATION_MINUTES + 1) * 60 * TICK_RATE / REPLAY_KEYFRAME_INTERVAL + 1);
+        tickCount = 0;
+        lastLeftAxis = 0.0f;
+        lastRightAxis = 0.0f;
+    }
+
+    void record(const Match &match, float leftAxis, float rightAxis)
+    {
+        if (!file.is_open())
+            return;
+
+        if (tickCount % REPLAY_KEYFRAME_INTERVAL == 0)
+        {
+            ReplayIndexEntry entry;
+            entry.tick = tickCount;
+            entry.reserved = 0;
+            entry.offset = offset;
+            index.push_back(entry);
+
+            ReplayKeyframe keyframe;
+            keyframe.tick = tickCount;
+            keyframe.stateHash = match.hashState(2166136261u);
+            keyframe.leftAxis = lastLeftAxis;
+            keyframe.rightAxis = lastRightAxis;
+            match.saveSnapshot(keyframe.snapshot);
+            write(&keyframe, sizeof(keyframe));
+        }
+
+        Uint8 changed = (leftAxis != lastLeftAxis ? 1 : 0) | (rightAxis != lastRightAxis ? 2 : 0);
+        write(&changed, 1);
+        if (changed & 1)
+            write(&leftAxis, sizeof(leftAxis));
+        if (changed & 2)
+            write(&rightAxis, sizeof(rightAxis));
+        lastLeftAxis = leftAxis;
+        lastRightAxis = rightAxis;
+        tickCount++;
+    }
+
+    // Escribe el índice y cierra el archivo (no hace nada si no se está grabando)
+    void finish()
+    {
+        if (!file.is_open())
+            return;
+
+        ReplayFooter footer;
+        memset(&footer, 0, sizeof(footer));
+        footer.indexOffset = offset;
+        footer.keyframeCount = (Uint32)index.size();
+        footer.tickCount = tickCount;
+        memcpy(footer.magic, "PONGIDX", 8);
+        if (!index.empty())
+            write(&index[0], index.size() * sizeof(ReplayIndexEntry));
+        write(&footer, sizeof(footer));
+        file.close();
+        cout << "Repeticion guardada en " << path << ": " << tickCount << " ticks, " << index.size() << " keyframes, "
+             << offset << " bytes" << endl;
+    }
+};
+
+// Repetición abierta con el archivo proyectado en memoria: buscar un tick solo toca las
+// páginas del keyframe y de los ticks que se re-simulan, sin leer el archivo entero
+class ReplayReader
+{
+private:
+    const Uint8 *data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+    Uint32 keyframeInterval;
+    Uint32 keyframeCount;
+    Uint32 tickCount;
+    size_t indexOffset;
+
+    // Posición de reproducción
+    size_t cursor;
+    Uint32 tick;
+    Uint32 nextKeyframeTick;
+    float leftAxis;
+    float rightAxis;
+    unsigned int desyncs;
+
+    bool map(const string &path)
+    {
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+            return false;
+        size = (size_t)fileSize.QuadPart;
+        mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mappingHandle)
+            return false;
+        data = static_cast<const Uint8 *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+#else
+        fileDescriptor = ::open(path.c_str(), O_RDONLY);
+        if (fileDescriptor < 0)
+            return false;
+        struct stat info;
+        if (fstat(fileDescriptor, &info) != 0 || info.st_size == 0)
+            return false;
+        size = (size_t)info.st_size;
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+        data = mapped != MAP_FAILED ? static_cast<const Uint8 *>(mapped) : nullptr;
+#endif
+        return data != nullptr;
+    }
+
+    ReplayIndexEntry getIndexEntry(Uint32 keyframe) const
+    {
+        ReplayIndexEntry entry;
+        memcpy(&entry, data + indexOffset + keyframe * sizeof(ReplayIndexEntry), sizeof(entry));
+        return entry;
+    }
+
+public:
+    ReplayReader() : data(nullptr), size(0), keyframeCount(0), tickCount(0), cursor(0), tick(0), desyncs(0)
+    {
+#ifdef _WIN32
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = nullptr;
+#else
+        fileDescriptor = -1;
+#endif
+    }
+
+    ~ReplayReader()
+    {
+        close();
+    }
+
+    bool open(const string &path)
+    {
+        close();
+        if (!map(path))
+        {
+            cout << "Error al abrir la repeticion " << path << endl;
+            close();
+            return false;
+        }
+
+        // Validar cabecera, pie e índice antes de confiar en ningún desplazamiento
+        ReplayHeader header;
+        ReplayFooter footer;
+        bool valid = size >= sizeof(header) + sizeof(footer);
+        if (valid)
+        {
+            memcpy(&header, data, sizeof(header));
+            memcpy(&footer, data + size - sizeof(footer), sizeof(footer));
+            valid = memcmp(header.magic, "PONGRPL", 8) == 0 && memcmp(footer.magic, "PONGIDX", 8) == 0 &&
+                    header.version == REPLAY_VERSION && header.tickRate == (Uint32)TICK_RATE &&
+                    header.snapshotSize == sizeof(MatchSnapshot) && header.keyframeInterval > 0 &&
+                    footer.keyframeCount > 0 &&
+                    footer.indexOffset + (Uint64)footer.keyframeCount * sizeof(ReplayIndexEntry) + sizeof(footer) == size;
+        }
+        if (valid)
+        {
+            keyframeInterval = header.keyframeInterval;
+            keyframeCount = footer.keyframeCount;
+            tickCount = footer.tickCount;
+            indexOffset = (size_t)footer.indexOffset;
+
+            // Un keyframe cada keyframeInterval ticks, empezando por el tick 0
+            valid = keyframeCount == ((Uint64)tickCount + keyframeInterval - 1) / keyframeInterval;
+            for (Uint32 i = 0; i < keyframeCount && valid; i++)
+            {
+                ReplayIndexEntry entry = getIndexEntry(i);
+                valid = entry.tick == i * keyframeInterval && entry.offset + sizeof(ReplayKeyframe) <= indexOffset;
+                if (valid)
+                {
+                    ReplayKeyframe keyframe;
+                    memcpy(&keyframe, data + entry.offset, sizeof(keyframe));
+                    valid = Match::isValidSnapshot(keyframe.snapshot);
+                }
+            }
+        }
+        if (!valid)
+        {
+            cout << "Error: " << path << " no es una repeticion valida para esta version" << endl;
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+        if (data)
+            UnmapViewOfFile(data);
+        if (mappingHandle)
+            CloseHandle(mappingHandle);
+        if (fileHandle != INVALID_HANDLE_VALUE)
+            CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = nullptr;
+#else
+        if (data)
+            munmap(const_cast<Uint8 *>(data), size);
+        if (fileDescriptor >= 0)
+            ::close(fileDescriptor);
+        fileDescriptor = -1;
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    // Deja el partido en el tick pedido: restaura el keyframe anterior y re-simula el resto
+    // sin publicar eventos
+    void seek(Match &match, Uint32 target)
+    {
+        target = min(target, tickCount);
+        Uint32 keyframe = min(target / keyframeInterval, keyframeCount - 1);
+        ReplayIndexEntry entry = getIndexEntry(keyframe);
+
+        ReplayKeyframe record;
+        memcpy(&record, data + entry.offset, sizeof(record));
+        match.loadSnapshot(record.snapshot);
+        cursor = (size_t)entry.offset + sizeof(record);
+        tick = entry.tick;
+        nextKeyframeTick = tick + keyframeInterval;
+        leftAxis = record.leftAxis;
+        rightAxis = record.rightAxis;
+
+        match.setEventsMuted(true);
+        while (tick < target && step(match))
+        {
+        }
+        match.setEventsMuted(false);
+    }
+
+    // Avanza un tick con la entrada grabada; false al llegar al final
+    bool step(Match &match)
+    {
+        if (tick >= tickCount || cursor >= indexOffset)
+            return false;
+
+        // Al pasar por un keyframe, comprobar que la re-simulación coincide con lo grabado. La
+        // posición sale del índice (validado al abrir), no de lo que se leyó hasta acá.
+        if (tick == nextKeyframeTick)
+        {
+            Uint32 keyframe = tick / keyframeInterval;
+            if (keyframe >= keyframeCount)
+                return false;
+            cursor = (size_t)getIndexEntry(keyframe).offset;
+            Uint32 stateHash;
+            memcpy(&stateHash, data + cursor + offsetof(ReplayKeyframe, stateHash), sizeof(stateHash));
+            if (stateHash != match.hashState(2166136261u))
+                desyncs++;
+            cursor += sizeof(ReplayKeyframe);
+            nextKeyframeTick += keyframeInterval;
+        }
+
+        // Los deltas no pueden pasar al índice: un archivo corrupto termina la reproducción
+        if (cursor >= indexOffset)
+            return false;
+        Uint8 changed = data[cursor++];
+        size_t deltaSize = ((changed & 1) ? sizeof(leftAxis) : 0) + ((changed & 2) ? sizeof(rightAxis) : 0);
+        if (cursor + deltaSize > indexOffset)
+            return false;
+        if (changed & 1)
+        {
+            memcpy(&leftAxis, data + cursor, sizeof(leftAxis));
+            cursor += sizeof(leftAxis);
+        }
+        if (changed & 2)
+        {
+            memcpy(&rightAxis, data + cursor, sizeof(rightAxis));
+            cursor += sizeof(rightAxis);
+        }
+        match.tick(leftAxis, rightAxis);
+        tick++;
+        return true;
+    }
+
+    Uint32 getTick() const { return tick; }
+    Uint32 getTickCount() const { return tickCount; }
+    unsigned int getDesyncCount() const { return desyncs; }
+};
+
+// Vista de muchos partidos IA contra IA a la vez (modo kiosco y prueba de carga de punta a punta)
+const int ARENA_TOP = 24;                      // franja superior para las estadísticas
+const int ARENA_MATCH_TICKS = TICK_RATE * 180; // cada partido se reinicia a los 3 minutos o al llegar al puntaje
+const int ARENA_MAX_QUADS_PER_MATCH = 32;      // fondo, línea, 2 pelotas, 2 paletas, 3 power-ups, 2 barreras, 16 puntos
+const float ARENA_DETAIL_MIN_PIXELS = 160.0f;  // por debajo de este ancho en píxeles un partido se dibuja simplificado
+const int ARENA_BENCH_TICKS_PER_FRAME = 8;
+
+// N partidos simulados en paralelo y dibujados en una cuadrícula con un solo lote de vértices.
+// Tanto los ticks como los vértices se reparten partido por partido en el sistema de trabajos.
+class MatchArena
+{
+private:
+    MatchTextures &textures;
+    JobSystem &jobs;
+    vector<Match *> matches;
+
+    // Todas las texturas de un partido en un atlas, para dibujar todo con una textura
+    Texture atlas;
+    IntRect ballRegion;
+    IntRect paddleRegion;
+    IntRect powerUpRegions[11];
+    Vector2f whiteTexel; // para los cuadriláteros de color liso
+    vector<Vertex> vertices;  // un tramo fijo de ARENA_MAX_QUADS_PER_MATCH por partido, compactado al final
+    vector<int> matchVertices; // vértices escritos en el tramo de cada partido
+    size_t vertexCount;
+    bool reducedDetail;
+
+    // Estadísticas
+    Uint64 simulatedTicks; // ticks de partido (ticks x partidos)
+    Int64 simulationMicroseconds;
+
+    void simulateMatch(Match &match, int ticks)
+    {
+        for (int t = 0; t < ticks; t++)
+        {
+            if (match.isScoreLimitReached() || match.getClock().getTicks() >= (Uint32)ARENA_MATCH_TICKS)
+                match.reset();
+            match.tick(0.0f, 0.0f);
+        }
+    }
+
+    // Copia una textura en el atlas a partir de x y devuelve su región
+    IntRect addToAtlas(const Texture &texture, unsigned int x)
+    {
+        atlas.update(texture.copyToImage(), x, 0);
+        return IntRect(x, 0, texture.getSize().x, texture.getSize().y);
+    }
+
+    void buildAtlas()
+    {
+        const Texture *sources[13] = {&textures.ball, &textures.paddle};
+        for (int i = 0; i < 11; i++)
+            sources[2 + i] = &textures.powerUps[i];
+
+        // Una fila con 2 píxeles de separación, y un bloque blanco al final
+        unsigned int width = 4, height = 4;
+        for (const Texture *source : sources)
+        {
+            width += source->getSize().x + 2;
+            height = max(height, source->getSize().y);
+        }
+        if (!atlas.create(width, height))
+        {
+            cout << "Error al crear el atlas de la arena" << endl;
+            return;
+        }
+
+        unsigned int x = 0;
+        ballRegion = addToAtlas(textures.ball, x);
+        x += textures.ball.getSize().x + 2;
+        paddleRegion = addToAtlas(textures.paddle, x);
+        x += textures.paddle.getSize().x + 2;
+        for (int i = 0; i < 11; i++)
+        {
+            powerUpRegions[i] = addToAtlas(textures.powerUps[i], x);
+            x += textures.powerUps[i].getSize().x + 2;
+        }
+        Image white;
+        white.create(4, 4, Color::White);
+        atlas.update(white, x, 0);
+        whiteTexel = Vector2f(x + 2.0f, 2.0f);
+    }
+
+    void addQuad(Vertex *&quad, const Transform &transform, const FloatRect &rect, const IntRect &region, Color color)
+    {
+        quad[0].position = transform.transformPoint(rect.left, rect.top);
+        quad[1].position = transform.transformPoint(rect.left + rect.width, rect.top);
+        quad[2].position = transform.transformPoint(rect.left + rect.width, rect.top + rect.height);
+        quad[3].position = transform.transformPoint(rect.left, rect.top + rect.height);
+        quad[0].texCoords = Vector2f((float)region.left, (float)region.top);
+        quad[1].texCoords = Vector2f((float)(region.left + region.width), (float)region.top);
+        quad[2].texCoords = Vector2f((float)(region.left + region.width), (float)(region.top + region.height));
+        quad[3].texCoords = Vector2f((float)region.left, (float)(region.top + region.height));
+        for (int i = 0; i < 4; i++)
+            quad[i].color = color;
+        quad += 4;
+    }
+
+    void addSolidQuad(Vertex *&quad, const Transform &transform, const FloatRect &rect, Color color)
+    {
+        addQuad(quad, transform, rect, IntRect((int)whiteTexel.x, (int)whiteTexel.y, 0, 0), color);
+    }
+
+    // Un sprite del partido desplazado a su posición interpolada; simplificado es un rectángulo liso
+    void addSprite(Vertex *&quad, const Transform &tile, const Sprite &sprite, const IntRect &region, Vector2f offset, Color solidColor)
+    {
+        Transform transform = tile;
+        transform.translate(offset);
+        transform.combine(sprite.getTransform());
+        FloatRect local(0, 0, (float)sprite.getTextureRect().width, (float)sprite.getTextureRect().height);
+        if (reducedDetail)
+            addSolidQuad(quad, transform, local, solidColor);
+        else
+            addQuad(quad, transform, local, region, Color::White);
+    }
+
+    // Escribe los cuadriláteros de un partido a partir de quad y devuelve cuántos vértices usó
+    int addMatch(Vertex *quad, const Match &match, const Transform &tile, float alpha)
+    {
+        Vertex *start = quad;
+        addSolidQuad(quad, tile, FloatRect(0, 0, FIELD_WIDTH, FIELD_HEIGHT), Color(20, 20, 20));
+        if (!reducedDetail)
+        {
+            addSolidQuad(quad, tile, FloatRect(0, HEADER_HEIGHT, FIELD_WIDTH, FIELD_HEIGHT - HEADER_HEIGHT), Color(0, 0, 0));
+            addSolidQuad(quad, tile, FloatRect(FIELD_WIDTH / 2 - 1, HEADER_HEIGHT, 4, FIELD_HEIGHT - HEADER_HEIGHT), Color(255, 255, 255, 100));
+
+            // Marcador como puntos en la barra superior, hacia afuera desde el centro
+            int leftScore = max(0, min(8, match.getLeftScore()));
+            int rightScore = max(0, min(8, match.getRightScore()));
+            for (int i = 0; i < leftScore; i++)
+                addSolidQuad(quad, tile, FloatRect(FIELD_WIDTH / 2 - 40 - i * 45, 20, 30, 30), Color::White);
+            for (int i = 0; i < rightScore; i++)
+                addSolidQuad(quad, tile, FloatRect(FIELD_WIDTH / 2 + 10 + i * 45, 20, 30, 30), Color::White);
+
+            for (const auto &powerUp : match.getPowerUps())
+            {
+                if (powerUp.isActive() && !powerUp.isCollected())
+                    addSprite(quad, tile, powerUp.getSprite(), powerUpRegions[powerUp.getType()], Vector2f(0, 0), Color::White);
+            }
+        }
+
+        if (match.isBarrierLeftActive())
+            addSolidQuad(quad, tile * match.getLeftBarrier().getTransform(), FloatRect(Vector2f(0, 0), match.getLeftBarrier().getSize()),
+                         match.getLeftBarrier().getFillColor());
+        if (match.isBarrierRightActive())
+            addSolidQuad(quad, tile * match.getRightBarrier().getTransform(), FloatRect(Vector2f(0, 0), match.getRightBarrier().getSize()),
+                         match.getRightBarrier().getFillColor());
+
+        float weight = 1.0f - alpha;
+        const Paddle &leftPaddle = match.getLeftPaddle();
+        const Paddle &rightPaddle = match.getRightPaddle();
+        if (!match.isInvisibleLeftActive())
+            addSprite(quad, tile, leftPaddle.getSprite(), paddleRegion,
+                      (leftPaddle.getPreviousPosition() - leftPaddle.getSprite().getPosition()) * weight, Color::White);
+        if (!match.isInvisibleRightActive())
+            addSprite(quad, tile, rightPaddle.getSprite(), paddleRegion,
+                      (rightPaddle.getPreviousPosition() - rightPaddle.getSprite().getPosition()) * weight, Color::White);
+
+        for (const auto &ball : match.getBalls())
+        {
+            if (ball.isActive() && ball.isVisible())
+                addSprite(quad, tile, ball.getSprite(), ballRegion, (ball.getPreviousPosition() - ball.getPosition()) * weight,
+                          Color(255, 200, 0));
+        }
+        return (int)(quad - start);
+    }
+
+public:
+    MatchArena(MatchTextures &t, JobSystem &jobSystem, int matchCount, unsigned int seed)
+        : textures(t), jobs(jobSystem), vertexCount(0), reducedDetail(false), simulatedTicks(0), simulationMicroseconds(0)
+    {
+        // Todas las combinaciones de niveles, con power-ups para ejercitar toda la simulación
+        for (int i = 0; i < matchCount; i++)
+        {
+            Match *match = new Match(textures, seed + i);
+            match->getLeftPaddle().setIsAI(true);
+            match->getRightPaddle().setIsAI(true);
+            match->getLeftPaddle().setAILevel(static_cast<AILevel>(i % 4));
+            match->getRightPaddle().setAILevel(static_cast<AILevel>((i / 4) % 4));
+            match->reset();
+            matches.push_back(match);
+        }
+
+        buildAtlas();
+        vertices.resize(matches.size() * ARENA_MAX_QUADS_PER_MATCH * 4);
+        matchVertices.resize(matches.size());
+    }
+
+    ~MatchArena()
+    {
+        for (Match *match : matches)
+        {
+            delete match;
+        }
+    }
+
+    // Avanza todos los partidos la misma cantidad de ticks y vuelve cuando terminaron
+    void simulate(int ticks)
+    {
+        if (ticks <= 0)
+            return;
+
+        Clock clock;
+        auto simulateRange = [this, ticks](int begin, int end) {
+            for (int i = begin; i < end; i++)
+                simulateMatch(*matches[i], ticks);
+        };
+        jobs.parallelFor((int)matches.size(), 1, simulateRange);
+
+        simulatedTicks += (Uint64)ticks * matches.size();
+        simulationMicroseconds += clock.getElapsedTime().asMicroseconds();
+    }
+
+    // Arma los vértices de la cuadrícula en coordenadas lógicas del campo; pixelWidth es el
+    // ancho del campo en la ventana, para elegir el nivel de detalle
+    void buildVertices(float alpha, float pixelWidth)
+    {
+        int count = (int)matches.size();
+        int columns = (int)ceil(sqrt((double)count));
+        int rows = (count + columns - 1) / columns;
+        float cellWidth = (float)FIELD_WIDTH / columns;
+        float cellHeight = (float)(FIELD_HEIGHT - ARENA_TOP) / rows;
+        float scale = min(cellWidth / FIELD_WIDTH, cellHeight / FIELD_HEIGHT) * 0.96f;
+        reducedDetail = scale * pixelWidth < ARENA_DETAIL_MIN_PIXELS;
+
+        auto buildRange = [&](int begin, int end) {
+            for (int i = begin; i < end; i++)
+            {
+                Transform tile;
+                tile.translate((i % columns) * cellWidth + (cellWidth - scale * FIELD_WIDTH) / 2,
+                               ARENA_TOP + (i / columns) * cellHeight + (cellHeight - scale * FIELD_HEIGHT) / 2);
+                tile.scale(scale, scale);
+                matchVertices[i] = addMatch(&vertices[i * ARENA_MAX_QUADS_PER_MATCH * 4], *matches[i], tile, alpha);
+            }
+        };
+        jobs.parallelFor(count, 8, buildRange);
+
+        // Juntar los tramos para dibujarlos seguidos
+        vertexCount = 0;
+        for (int i = 0; i < count; i++)
+        {
+            Vertex *slot = &vertices[i * ARENA_MAX_QUADS_PER_MATCH * 4];
+            if (&vertices[vertexCount] != slot)
+                memmove(&vertices[vertexCount], slot, matchVertices[i] * sizeof(Vertex));
+            vertexCount += matchVertices[i];
+        }
+    }
+
+    // Todos los partidos en una sola llamada de dibujo
+    void draw(RenderTarget &target, float alpha, float pixelWidth)
+    {
+        buildVertices(alpha, pixelWidth);
+        if (vertexCount > 0)
+            target.draw(&vertices[0], vertexCount, Quads, RenderStates(&atlas));
+    }
+
+    int getMatchCount() const { return (int)matches.size(); }
+    int getThreadCount() const { return jobs.getThreadCount(); }
+    size_t getVertexCount() const { return vertexCount; }
+    bool isReducedDetail() const { return reducedDetail; }
+    Uint64 getSimulatedTicks() const { return simulatedTicks; }
+    Int64 getSimulationMicroseconds() const { return simulationMicroseconds; }
+
+    void resetStats()
+    {
+        simulatedTicks = 0;
+        simulationMicroseconds = 0;
+    }
+};
+
+// Tiempo de las partes paralelas de un frame según la cantidad de hilos: la simulación y
+// los vértices de una arena y la actualización y los vértices de un sistema de partículas
+void benchmarkJobs(int matchCount, int liveParticles, int frames, int maxThreads)
+{
+    MatchTextures textures;
+    textures.load();
+
+    cout << matchCount << " partidos (" << ARENA_BENCH_TICKS_PER_FRAME << " ticks por frame) y " << liveParticles
+         << " particulas, " << frames << " frames" << endl;
+    cout << "hilos  simulacion  vertices arena  particulas   frame (us)  aceleracion" << endl;
+    double singleThreadFrame = 0;
+    int cpuCount = max(1, maxThreads);
+    for (int threadCount = 1; threadCount <= cpuCount; threadCount = threadCount * 2 > cpuCount && threadCount < cpuCount ? cpuCount : threadCount * 2)
+    {
+        JobSystem jobs(threadCount);
+        MatchArena arena(textures, jobs, matchCount, 1234);
+        ParticleSystem particles(liveParticles + 1024);
+        particles.setJobSystem(&jobs);
+
+        Int64 simulationTime = 0, arenaBuildTime = 0, particleTime = 0;
+        Clock clock;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            while (particles.getCount() < liveParticles)
+            {
+                particles.burst(Vector2f(425, 300), min(256, liveParticles - particles.getCount()), Color::White, 150.0f, 2.0f);
+            }
+
+            clock.restart();
+            arena.simulate(ARENA_BENCH_TICKS_PER_FRAME);
+            simulationTime += clock.restart().asMicroseconds();
+            arena.buildVertices(1.0f, 1920.0f);
+            arenaBuildTime += clock.restart().asMicroseconds();
+            particles.update(1.0f / FRAME_RATE);
+            particles.buildVertices();
+            particleTime += clock.restart().asMicroseconds();
+        }
+
+        double frameTime = (double)(simulationTime + arenaBuildTime + particleTime) / frames;
+        if (threadCount == 1)
+            singleThreadFrame = frameTime;
+        cout << setw(5) << threadCount << setw(12) << simulationTime / frames << setw(16) << arenaBuildTime / frames
+             << setw(12) << particleTime / frames << setw(13) << (Int64)frameTime << setw(12) << fixed << setprecision(2)
+             << singleThreadFrame / frameTime << "x" << endl;
+        cout.unsetf(ios::floatfield);
+    }
+}
+
+// Métricas en vivo para mirar un kiosco sin depurador. El hilo principal solo escribe
+// atómicos relajados (un solo escritor, sin bloqueos ni reservas de memoria); MetricsServer
+// los lee desde su hilo y arma el texto en formato de Prometheus.
+const Int64 TICK_HISTOGRAM_BOUNDS[] = {10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000};             // microsegundos
+const Int64 FRAME_HISTOGRAM_BOUNDS[] = {2000, 4000, 6000, 8333, 10000, 16667, 33333, 50000, 100000, 250000}; // microsegundos
+const char *const PHASE_METRIC_NAMES[PHASE_COUNT] = {"events", "simulation", "effects", "render"};
+const unsigned short METRICS_DEFAULT_PORT = 9120;
+
+// Histograma de duraciones con límites fijos en microsegundos. Cada cubeta cuenta solo su
+// intervalo; al exportar se acumulan, como pide el formato de Prometheus.
+class MetricsHistogram
+{
+private:
+    static const int MAX_BOUNDS = 10;
+    const Int64 *bounds;
+    int boundCount;
+    atomic<Uint64> buckets[MAX_BOUNDS + 1]; // la última es +Inf
+    atomic<Uint64> sumMicroseconds;
+
+public:
+    MetricsHistogram(const Int64 *histogramBounds, int count) : bounds(histogramBounds), boundCount(min(count, MAX_BOUNDS)), sumMicroseconds(0)
+    {
+        for (int i = 0; i <= MAX_BOUNDS; i++)
+            buckets[i] = 0;
+    }
+
+    void observe(Int64 microseconds)
+    {
+        int bucket = 0;
+        while (bucket < boundCount && microseconds > bounds[bucket])
+            bucket++;
+        buckets[bucket].fetch_add(1, memory_order_relaxed);
+        sumMicroseconds.fetch_add((Uint64)max((Int64)0, microseconds), memory_order_relaxed);
+    }
+
+    void write(ostream &out, const char *name, const char *help) const
+    {
+        out << "# HELP " << name << " " << help << "\n# TYPE " << name << " histogram\n";
+        Uint64 cumulative = 0;
+        for (int i = 0; i <= boundCount; i++)
+        {
+            cumulative += buckets[i].load(memory_order_relaxed);
+            out << name << "_bucket{le=\"";
+            if (i < boundCount)
+                out << bounds[i] / 1e6;
+            else
+                out << "+Inf";
+            out << "\"} " << cumulative << "\n";
+        }
+        out << name << "_sum " << sumMicroseconds.load(memory_order_relaxed) / 1e6 << "\n";
+        out << name << "_count " << cumulative << "\n";
+    }
+};
+
+class Metrics
+{
+private:
+    atomic<Uint64> frames;
+    atomic<Uint64> ticks;
+    atomic<int> framesPerSecond;
+    MetricsHistogram tickDurations;
+    MetricsHistogram frameDurations;
+    atomic<Uint64> phaseMicroseconds[PHASE_COUNT];
+    atomic<Uint64> allocations[PHASE_COUNT];
+    atomic<bool> allocationsTracked;
+    atomic<int> state;
+    atomic<int> balls;
+    atomic<int> powerUps;
+    atomic<int> leftScore;
+    atomic<int> rightScore;
+
+    // Solo los usa el hilo principal para calcular los FPS del último segundo
+    Int64 secondStart;
+    int secondFrames;
+
+public:
+    Metrics()
+        : frames(0), ticks(0), framesPerSecond(0),
+          tickDurations(TICK_HISTOGRAM_BOUNDS, sizeof(TICK_HISTOGRAM_BOUNDS) / sizeof(TICK_HISTOGRAM_BOUNDS[0])),
+          frameDurations(FRAME_HISTOGRAM_BOUNDS, sizeof(FRAME_HISTOGRAM_BOUNDS) / sizeof(FRAME_HISTOGRAM_BOUNDS[0])),
+          allocationsTracked(false), state(MENU), balls(0), powerUps(0), leftScore(0), rightScore(0), secondStart(0), secondFrames(0)
+    {
+        for (int i = 0; i < PHASE_COUNT; i++)
+        {
+            phaseMicroseconds[i] = 0;
+            allocations[i] = 0;
+        }
+    }
+
+    void recordTick(Int64 microseconds)
+    {
+        ticks.fetch_add(1, memory_order_relaxed);
+        tickDurations.observe(microseconds);
+    }
+
+    // Un frame completo (espera incluida) que terminó en now, con el tiempo de cada fase
+    void recordFrame(Int64 now, Int64 frameMicroseconds, const Int64 phases[PHASE_COUNT])
+    {
+        frames.fetch_add(1, memory_order_relaxed);
+        frameDurations.observe(frameMicroseconds);
+        for (int i = 0; i < PHASE_COUNT; i++)
+            phaseMicroseconds[i].fetch_add((Uint64)phases[i], memory_order_relaxed);
+
+        secondFrames++;
+        if (now - secondStart >= 1000000)
+        {
+            framesPerSecond.store((int)(secondFrames * 1000000 / (now - secondStart)), memory_order_relaxed);
+            secondStart = now;
+            secondFrames = 0;
+        }
+    }
+
+    // Reservas del frame por fase; solo existen en compilaciones con PONG_INSTRUMENT
+    void recordAllocations()
+    {
+        for (int i = 0; i < PHASE_COUNT; i++)
+        {
+            long long count = instrumentAllocations(static_cast<InstrumentPhase>(i));
+            if (count < 0)
+                return;
+            allocations[i].fetch_add((Uint64)count, memory_order_relaxed);
+        }
+        allocationsTracked.store(true, memory_order_relaxed);
+    }
+
+    void recordMatch(GameState gameState, const Match &match)
+    {
+        state.store(gameState, memory_order_relaxed);
+        balls.store((int)match.getBalls().size(), memory_order_relaxed);
+        powerUps.store((int)match.getPowerUps().size(), memory_order_relaxed);
+        leftScore.store(match.getLeftScore(), memory_order_relaxed);
+        rightScore.store(match.getRightScore(), memory_order_relaxed);
+    }
+
+    // Texto en formato de exposición de Prometheus (se llama desde el hilo del servidor)
+    string format() const
+    {
+        ostringstream out;
+        out << "# HELP pong_frames_total Frames dibujados.\n# TYPE pong_frames_total counter\n";
+        out << "pong_frames_total " << frames.load(memory_order_relaxed) << "\n";
+        out << "# HELP pong_fps Frames por segundo en el ultimo segundo.\n# TYPE pong_fps gauge\n";
+        out << "pong_fps " << framesPerSecond.load(memory_order_relaxed) << "\n";
+        out << "# HELP pong_ticks_total Ticks de simulacion ejecutados.\n# TYPE pong_ticks_total counter\n";
+        out << "pong_ticks_total " << ticks.load(memory_order_relaxed) << "\n";
+        tickDurations.write(out, "pong_tick_duration_seconds", "Duracion de cada tick de simulacion.");
+        frameDurations.write(out, "pong_frame_duration_seconds", "Duracion de cada frame, espera incluida.");
+
+        out << "# HELP pong_phase_seconds_total Tiempo acumulado en cada fase del frame.\n# TYPE pong_phase_seconds_total counter\n";
+        for (int i = 0; i < PHASE_COUNT; i++)
+            out << "pong_phase_seconds_total{phase=\"" << PHASE_METRIC_NAMES[i] << "\"} " << phaseMicroseconds[i].load(memory_order_relaxed) / 1e6 << "\n";
+        if (allocationsTracked.load(memory_order_relaxed))
+        {
+            out << "# HELP pong_allocations_total Reservas de memoria del hilo principal por fase.\n# TYPE pong_allocations_total counter\n";
+            for (int i = 0; i < PHASE_COUNT; i++)
+                out << "pong_allocations_total{phase=\"" << PHASE_METRIC_NAMES[i] << "\"} " << allocations[i].load(memory_order_relaxed) << "\n";
+        }
+
+        out << "# HELP pong_balls Pelotas en juego.\n# TYPE pong_balls gauge\npong_balls " << balls.load(memory_order_relaxed) << "\n";
+        out << "# HELP pong_power_ups Power-ups en el campo o con efecto activo.\n# TYPE pong_power_ups gauge\npong_power_ups "
+            << powerUps.load(memory_order_relaxed) << "\n";
+        out << "# HELP pong_score Marcador del partido en curso.\n# TYPE pong_score gauge\n";
+        out << "pong_score{side=\"left\"} " << leftScore.load(memory_order_relaxed) << "\n";
+        out << "pong_score{side=\"right\"} " << rightScore.load(memory_order_relaxed) << "\n";
+        out << "# HELP pong_game_state Estado actual del juego (1 en el estado activo).\n# TYPE pong_game_state gauge\n";
+        int currentState = state.load(memory_order_relaxed);
+        for (int i = 0; i < GAME_STATE_COUNT; i++)
+            out << "pong_game_state{state=\"" << GAME_STATE_NAMES[i] << "\"} " << (i == currentState ? 1 : 0) << "\n";
+        out << "# HELP process_cpu_seconds_total Tiempo de CPU del proceso.\n# TYPE process_cpu_seconds_total counter\n";
+        out << "process_cpu_seconds_total " << getProcessCpuMicroseconds() / 1e6 << "\n";
+        return out.str();
+    }
+};
+
+// Atiende GET /metrics en 127.0.0.1 desde un hilo propio, una conexión a la vez (HTTP/1.0).
+// Solo escucha en localhost: el kiosco no expone nada hacia la red.
+class MetricsServer
+{
+private:
+    const Metrics &metrics;
+    TcpListener listener;
+    Thread thread;
+    atomic<bool> stopping;
+    bool listening;
+
+    void serve()
+    {
+        SocketSelector selector;
+        selector.add(listener);
+        while (!stopping)
+        {
+            // Con espera acotada para ver stopping al cerrar el juego
+            if (!selector.wait(milliseconds(200)) || !selector.isReady(listener))
+                continue;
+            TcpSocket client;
+            if (listener.accept(client) != Socket::Done)
+                continue;
+            respond(client);
+            client.disconnect();
+        }
+    }
+
+    void respond(TcpSocket &client)
+    {
+        // Leer hasta el fin de los encabezados; a un cliente lento se le da un segundo
+        string request;
+        SocketSelector selector;
+        selector.add(client);
+        char buffer[512];
+        while (request.find("\r\n\r\n") == string::npos && request.size() < 4096 && selector.wait(seconds(1)))
+        {
+            size_t received = 0;
+            if (client.receive(buffer, sizeof(buffer), received) != Socket::Done)
+                return;
+            request.append(buffer, received);
+        }
+
+        string status = "200 OK";
+        string body;
+        if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0)
+            body = metrics.format();
+        else
+        {
+            status = "404 Not Found";
+            body = "Metricas en /metrics\n";
+        }
+        ostringstream response;
+        response << "HTTP/1.0 " << status << "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: " << body.size()
+                 << "\r\nConnection: close\r\n\r\n" << body;
+        string text = response.str();
+        client.send(text.data(), text.size());
+    }
+
+public:
+    explicit MetricsServer(const Metrics &gameMetrics)
+        : metrics(gameMetrics), thread(&MetricsServer::serve, this), stopping(false), listening(false)
+    {
+    }
+
+    ~MetricsServer()
+    {
+        stopping = true;
+        if (listening)
+            thread.wait();
+        listener.close();
+    }
+
+    bool start(unsigned short port)
+    {
+        if (listener.listen(port, IpAddress::LocalHost) != Socket::Done)
+            return false;
+        listening = true;
+        thread.launch();
+        return true;
+    }
+};
+
+// Control de paletas desde otros procesos (bots) por memoria compartida. En cada tick el juego
+// publica el estado del partido con un seqlock y despierta a los bots; cada bot responde en
+// su lugar de comando (también con seqlock) con un eje o una altura objetivo para su paleta.
+// Las esperas usan futex en Linux y eventos con nombre en Windows: sin sockets ni sondeo.
+const Uint32 BOT_MAGIC = 0x544F4250; // "PBOT"
+const Uint32 BOT_LAYOUT_VERSION = 1;
+const int BOT_MAX_BALLS = 2;
+const int BOT_LOCKSTEP_TIMEOUT_MILLISECONDS = 100; // un bot colgado no frena el partido para siempre
+#ifdef _WIN32
+const char *const BOT_SHARED_NAME = "Local\\PongBot";
+#else
+const char *const BOT_SHARED_NAME = "/pong_bot";
+#endif
+const char *const BOT_SIDE_NAMES[2] = {"left", "right"};
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && sizeof(atomic<Uint32>) == sizeof(Uint32),
+              "los atomicos de la memoria compartida tienen que ser palabras sin bloqueo");
+
+// Lo que ve un bot en cada tick. Lado 0 = izquierda, 1 = derecha.
+struct BotGameState
+{
+    Uint32 tick;
+    Uint32 ballCount;
+    float ballX[BOT_MAX_BALLS];
+    float ballY[BOT_MAX_BALLS];
+    float ballVelocityX[BOT_MAX_BALLS];
+    float ballVelocityY[BOT_MAX_BALLS];
+    float paddleY[2];
+    float paddleHalfHeight[2];
+    float paddleSpeed[2];
+    Int32 score[2];
+    Int64 publishNanoseconds; // getMonotonicNanoseconds() al publicar
+};
+
+enum BotCommandMode
+{
+    BOT_COMMAND_NONE,
+    BOT_COMMAND_AXIS,  // value en [-1, 1], como el teclado (negativo hacia arriba)
+    BOT_COMMAND_TARGET // value = altura a la que mover el centro de la paleta
+};
+
+struct BotCommand
+{
+    Uint32 stateTick; // tick del estado al que responde
+    Uint32 mode;
+    float value;
+    Uint32 reserved;
+    Int64 writeNanoseconds;
+};
+
+// La región compartida. La secuencia de cada seqlock queda impar mientras se escribe; los bots
+// esperan sobre stateSequence y el juego (en modo lockstep) sobre la de su lugar de comando.
+struct BotSharedRegion
+{
+    Uint32 magic;
+    Uint32 version;
+    atomic<Uint32> gameAlive; // 0 cuando el juego cierra: los bots terminan
+    atomic<Uint32> lockstep;  // 1 si el juego espera el comando de cada tick
+
+    alignas(64) atomic<Uint32> stateSequence;
+    BotGameState state;
+
+    struct CommandSlot
+    {
+        alignas(64) atomic<Uint32> sequence;
+        atomic<Uint32> attached; // 1 mientras hay un bot conectado a este lado
+        BotCommand command;
+    } commands[2];
+};
+
+// Seqlock entre procesos. El escritor es uno solo por secuencia.
+template <typename T>
+void seqlockWrite(atomic<Uint32> &sequence, T &shared, const T &value)
+{
+    Uint32 start = sequence.load(memory_order_relaxed);
+    sequence.store(start + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&shared, &value, sizeof(T));
+    sequence.store(start + 2, memory_order_release);
+}
+
+// Devuelve falso si no logró una copia consistente (el escritor seguía escribiendo)
+template <typename T>
+bool seqlockRead(const atomic<Uint32> &sequence, const T &shared, T &value, Uint32 &readSequence)
+{
+    for (int attempt = 0; attempt < 1000; attempt++)
+    {
+        Uint32 before = sequence.load(memory_order_acquire);
+        if (before & 1)
+            continue;
+        memcpy(&value, &shared, sizeof(T));
+        atomic_thread_fence(memory_order_acquire);
+        if (sequence.load(memory_order_relaxed) == before)
+        {
+            readSequence = before;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Mapeo de la región: el juego la crea y la borra al cerrar; los bots la abren ya creada
+class BotSharedMemory
+{
+private:
+    BotSharedRegion *region;
+    bool owner;
+#ifdef _WIN32
+    HANDLE mappingHandle;
+#endif
+
+public:
+    BotSharedMemory() : region(nullptr), owner(false)
+    {
+#ifdef _WIN32
+        mappingHandle = nullptr;
+#endif
+    }
+
+    ~BotSharedMemory()
+    {
+        close();
+    }
+
+#ifndef _WIN32
+    // Una región con nombre que ya existe solo se reutiliza si el juego que la creó la cerró
+    // (gameAlive en 0); si otro juego la está usando, no se toca
+    static bool isAbandoned()
+    {
+        int fileDescriptor = shm_open(BOT_SHARED_NAME, O_RDONLY, 0600);
+        if (fileDescriptor < 0)
+            return errno == ENOENT;
+        struct stat info;
+        void *mapped = MAP_FAILED;
+        if (fstat(fileDescriptor, &info) == 0 && info.st_size >= (off_t)sizeof(BotSharedRegion))
+            mapped = mmap(nullptr, sizeof(BotSharedRegion), PROT_READ, MAP_SHARED, fileDescriptor, 0);
+        ::close(fileDescriptor);
+        if (mapped == MAP_FAILED)
+            return false;
+        bool abandoned = static_cast<BotSharedRegion *>(mapped)->gameAlive.load(memory_order_acquire) == 0;
+        munmap(mapped, sizeof(BotSharedRegion));
+        return abandoned;
+    }
+#endif
+
+    // Crea la región para los bots. Falla si otro juego ya la tiene abierta.
+    bool create()
+    {
+        close();
+#ifdef _WIN32
+        mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(BotSharedRegion), BOT_SHARED_NAME);
+        if (!mappingHandle)
+            return false;
+        bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+        region = static_cast<BotSharedRegion *>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(BotSharedRegion)));
+
+        // La región sigue viva mientras algún bot tenga una vista: se reutiliza solo si su juego cerró
+        if (region && existed && region->gameAlive.load(memory_order_acquire) != 0)
+        {
+            cout << "Error: otro juego ya comparte su estado con bots en " << BOT_SHARED_NAME << endl;
+            close();
+            return false;
+        }
+        owner = true;
+#else
+        int fileDescriptor = shm_open(BOT_SHARED_NAME, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fileDescriptor < 0 && errno == EEXIST)
+        {
+            if (!isAbandoned())
+            {
+                cout << "Error: otro juego ya comparte su estado con bots en /dev/shm" << BOT_SHARED_NAME
+                     << " (si ningun juego esta abierto, borrar ese archivo)" << endl;
+                return false;
+            }
+            shm_unlink(BOT_SHARED_NAME);
+            fileDescriptor = shm_open(BOT_SHARED_NAME, O_CREAT | O_EXCL | O_RDWR, 0600);
+        }
+        if (fileDescriptor < 0)
+            return false;
+        owner = true; // el nombre es de este juego desde acá: close() lo borra
+        void *mapped = MAP_FAILED;
+        if (ftruncate(fileDescriptor, sizeof(BotSharedRegion)) == 0)
+            mapped = mmap(nullptr, sizeof(BotSharedRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+        ::close(fileDescriptor);
+        region = mapped != MAP_FAILED ? static_cast<BotSharedRegion *>(mapped) : nullptr;
+#endif
+        if (!region)
+        {
+            close();
+            return false;
+        }
+
+        // La región es nueva o la dejó un juego que ya cerró: se empieza de cero
+        memset(static_cast<void *>(region), 0, sizeof(BotSharedRegion));
+        region->magic = BOT_MAGIC;
+        region->version = BOT_LAYOUT_VERSION;
+        region->gameAlive.store(1, memory_order_release);
+        return true;
+    }
+
+    bool open()
+    {
+        close();
+#ifdef _WIN32
+        mappingHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, BOT_SHARED_NAME);
+        if (!mappingHandle)
+            return false;
+        region = static_cast<BotSharedRegion *>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(BotSharedRegion)));
+#else
+        int fileDescriptor = shm_open(BOT_SHARED_NAME, O_RDWR, 0600);
+        if (fileDescriptor < 0)
+            return false;
+        struct stat info;
+        void *mapped = MAP_FAILED;
+        if (fstat(fileDescriptor, &info) == 0 && info.st_size >= (off_t)sizeof(BotSharedRegion))
+            mapped = mmap(nullptr, sizeof(BotSharedRegion), PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+        ::close(fileDescriptor);
+        region = mapped != MAP_FAILED ? static_cast<BotSharedRegion *>(mapped) : nullptr;
+#endif
+        if (!region || region->gameAlive.load(memory_order_acquire) != 1 || region->magic != BOT_MAGIC ||
+            region->version != BOT_LAYOUT_VERSION)
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        // Borrar el nombre antes de marcar la región como cerrada: un juego nuevo que la vea
+        // abandonada no puede haber creado todavía otra con el mismo nombre
+        if (owner)
+            shm_unlink(BOT_SHARED_NAME);
+#endif
+        if (region && owner)
+            region->gameAlive.store(0, memory_order_release);
+#ifdef _WIN32
+        if (region)
+            UnmapViewOfFile(region);
+        if (mappingHandle)
+            CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+#else
+        if (region)
+            munmap(region, sizeof(BotSharedRegion));
+#endif
+        region = nullptr;
+        owner = false;
+    }
+
+    BotSharedRegion *get() const { return region; }
+};
+
+// Despertar entre procesos sobre una palabra de la región. En Linux es un futex sobre la
+// palabra misma; en Windows, un evento con nombre por cada palabra y lado.
+class BotSignal
+{
+private:
+#ifdef _WIN32
+    HANDLE event;
+#endif
+
+public:
+    BotSignal()
+    {
+#ifdef _WIN32
+        event = nullptr;
+#endif
+    }
+
+    ~BotSignal()
+    {
+#ifdef _WIN32
+        if (event)
+            CloseHandle(event);
+#endif
+    }
+
+    bool open(const string &name)
+    {
+#ifdef _WIN32
+        event = CreateEventA(nullptr, FALSE, FALSE, ("Local\\" + name).c_str());
+        return event != nullptr;
+#else
+        (void)name;
+        return true;
+#endif
+    }
+
+    void wake(atomic<Uint32> &word)
+    {
+#ifdef _WIN32
+        (void)word;
+        SetEvent(event);
+#elif defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<Uint32 *>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+        (void)word;
+#endif
+    }
+
+    // Duerme mientras la palabra siga valiendo seen, hasta el tiempo límite. Puede volver antes
+    // sin que haya cambiado: quien espera vuelve a mirar.
+    void wait(atomic<Uint32> &word, Uint32 seen, int timeoutMilliseconds)
+    {
+        if (word.load(memory_order_acquire) != seen)
+            return;
+#ifdef _WIN32
+        WaitForSingleObject(event, (DWORD)timeoutMilliseconds);
+#elif defined(__linux__)
+        timespec timeout;
+        timeout.tv_sec = timeoutMilliseconds / 1000;
+        timeout.tv_nsec = (long)(timeoutMilliseconds % 1000) * 1000000;
+        syscall(SYS_futex, reinterpret_cast<Uint32 *>(&word), FUTEX_WAIT, seen, &timeout, nullptr, 0);
+#else
+        (void)timeoutMilliseconds;
+        usleep(50);
+#endif
+    }
+};
+
+// Latencias con un casillero por microsegundo hasta 100 us; no reserva memoria al medir
+struct LatencyHistogram
+{
+    static const int BUCKET_COUNT = 101;
+    Int64 buckets[BUCKET_COUNT];
+    Int64 samples;
+    Int64 totalNanoseconds;
+    Int64 maxNanoseconds;
+
+    LatencyHistogram()
+    {
+        memset(buckets, 0, sizeof(buckets));
+        samples = totalNanoseconds = maxNanoseconds = 0;
+    }
+
+    void add(Int64 nanoseconds)
+    {
+        nanoseconds = max<Int64>(0, nanoseconds);
+        buckets[min<Int64>(nanoseconds / 1000, BUCKET_COUNT - 1)]++;
+        samples++;
+        totalNanoseconds += nanoseconds;
+        maxNanoseconds = max(maxNanoseconds, nanoseconds);
+    }
+
+    // Microsegundos enteros por debajo de los que cae la fracción pedida de las muestras
+    int percentile(double fraction) const
+    {
+        Int64 needed = (Int64)ceil(samples * fraction);
+        Int64 seen = 0;
+        for (int i = 0; i < BUCKET_COUNT; i++)
+        {
+            seen += buckets[i];
+            if (seen >= needed)
+                return i + 1;
+        }
+        return BUCKET_COUNT;
+    }
+
+    void print(const char *label) const
+    {
+        if (samples == 0)
+            return;
+        cout << "  " << label << ": " << samples << " muestras, promedio " << fixed << setprecision(1)
+             << totalNanoseconds / 1000.0 / samples << " us, p50 < " << percentile(0.5) << " us, p99 < "
+             << percentile(0.99) << " us, maxima " << maxNanoseconds / 1000.0 << " us" << endl;
+    }
+};
+
+// El lado del juego: publica el estado y toma los comandos de los lados que manejan bots.
+// En modo lockstep (partidos sin ventana) el juego espera en cada tick la respuesta al estado
+// publicado; con ventana nunca espera y usa el último comando que haya llegado.
+class BotLink
+{
+private:
+    BotSharedMemory memory;
+    BotSharedRegion *region;
+    BotSignal stateSignals[2];
+    BotSignal commandSignals[2];
+    bool controlled[2];
+    bool lockstep;
+    bool published;
+    Uint32 publishedTick;
+    Int64 publishedNanoseconds;
+    BotCommand commands[2];          // último comando leído de cada lado
+    Uint32 commandSequences[2];      // su secuencia, para medir cada comando una sola vez
+    LatencyHistogram responseLatency; // publicación -> comando escrito por el bot
+    LatencyHistogram pickupLatency;   // publicación -> comando leído por el juego (lockstep)
+    Int64 staleTicks;                 // ticks en que el bot no había respondido al último estado
+    Int64 timeouts;
+
+public:
+    BotLink() : region(nullptr), lockstep(false), published(false), publishedTick(0), publishedNanoseconds(0),
+                staleTicks(0), timeouts(0)
+    {
+        memset(commands, 0, sizeof(commands));
+        controlled[0] = controlled[1] = false;
+        commandSequences[0] = commandSequences[1] = 0;
+    }
+
+    ~BotLink()
+    {
+        close();
+    }
+
+    bool open(bool left, bool right, bool waitEachTick)
+    {
+        if (!memory.create())
+            return false;
+        region = memory.get();
+        region->lockstep.store(waitEachTick ? 1 : 0, memory_order_release);
+        controlled[0] = left;
+        controlled[1] = right;
+        lockstep = waitEachTick;
+        for (int side = 0; side < 2; side++)
+        {
+            if (!stateSignals[side].open(string("PongBotState") + BOT_SIDE_NAMES[side]) ||
+                !commandSignals[side].open(string("PongBotCommand") + BOT_SIDE_NAMES[side]))
+                return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if (!region)
+            return;
+        region->gameAlive.store(0, memory_order_release);
+        for (int side = 0; side < 2; side++)
+        {
+            stateSignals[side].wake(region->stateSequence);
+        }
+        memory.close();
+        region = nullptr;
+    }
+
+    bool controls(int side) const { return controlled[side]; }
+    bool isAttached(int side) const { return region->commands[side].attached.load(memory_order_acquire) != 0; }
+
+    // Espera a que se conecten los bots de todos los lados controlados
+    bool waitForBots(int seconds)
+    {
+        for (int i = 0; i < seconds * 100; i++)
+        {
+            if ((!controlled[0] || isAttached(0)) && (!controlled[1] || isAttached(1)))
+                return true;
+            sleep(milliseconds(10));
+        }
+        return false;
+    }
+
+    void publish(const Match &match)
+    {
+        BotGameState state;
+        memset(&state, 0, sizeof(state));
+        state.tick = match.getClock().getTicks();
+        for (const Ball &ball : match.getBalls())
+        {
+            if (!ball.isActive() || state.ballCount >= (Uint32)BOT_MAX_BALLS)
+                continue;
+            state.ballX[state.ballCount] = ball.getPosition().x;
+            state.ballY[state.ballCount] = ball.getPosition().y;
+            state.ballVelocityX[state.ballCount] = ball.getVelocity().x;
+            state.ballVelocityY[state.ballCount] = ball.getVelocity().y;
+            state.ballCount++;
+        }
+        const Paddle *paddles[2] = {&match.getLeftPaddle(), &match.getRightPaddle()};
+        for (int side = 0; side < 2; side++)
+        {
+            state.paddleY[side] = paddles[side]->getSprite().getPosition().y;
+            state.paddleHalfHeight[side] = paddles[side]->getBounds().height / 2;
+            state.paddleSpeed[side] = paddles[side]->getSpeed();
+        }
+        state.score[0] = match.getLeftScore();
+        state.score[1] = match.getRightScore();
+        state.publishNanoseconds = getMonotonicNanoseconds();
+
+        seqlockWrite(region->stateSequence, region->state, state);
+        published = true;
+        publishedTick = state.tick;
+        publishedNanoseconds = state.publishNanoseconds;
+        for (int side = 0; side < 2; side++)
+        {
+            if (controlled[side])
+                stateSignals[side].wake(region->stateSequence);
+        }
+    }
+
+    // Modo lockstep: espera la respuesta de cada bot al estado recién publicado, con tiempo límite
+    void waitForCommands()
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            if (!controlled[side])
+                continue;
+            BotSharedRegion::CommandSlot &slot = region->commands[side];
+            Int64 deadline = getMonotonicNanoseconds() + BOT_LOCKSTEP_TIMEOUT_MILLISECONDS * 1000000LL;
+            for (;;)
+            {
+                Uint32 current = slot.sequence.load(memory_order_acquire);
+                BotCommand command;
+                Uint32 sequence;
+                if (seqlockRead(slot.sequence, slot.command, command, sequence) && command.stateTick == publishedTick)
+                {
+                    pickupLatency.add(getMonotonicNanoseconds() - publishedNanoseconds);
+                    break;
+                }
+                Int64 remaining = deadline - getMonotonicNanoseconds();
+                if (remaining <= 0 || !isAttached(side))
+                {
+                    timeouts++;
+                    break;
+                }
+                commandSignals[side].wait(slot.sequence, current, (int)(remaining / 1000000) + 1);
+            }
+        }
+    }
+
+    // Eje de este tick para la paleta del lado, a partir del último comando del bot (nunca espera)
+    float takeAxis(int side, const Paddle &paddle)
+    {
+        BotSharedRegion::CommandSlot &slot = region->commands[side];
+        BotCommand command;
+        Uint32 sequence;
+        if (!seqlockRead(slot.sequence, slot.command, command, sequence))
+        {
+            command = commands[side];
+            sequence = commandSequences[side];
+        }
+
+        if (sequence != commandSequences[side])
+        {
+            commandSequences[side] = sequence;
+            commands[side] = command;
+            if (command.stateTick == publishedTick)
+                responseLatency.add(command.writeNanoseconds - publishedNanoseconds);
+        }
+        if (published && commands[side].stateTick != publishedTick)
+            staleTicks++;
+
+        float axis = 0.0f;
+        if (commands[side].mode == BOT_COMMAND_AXIS)
+            axis = commands[side].value;
+        else if (commands[side].mode == BOT_COMMAND_TARGET)
+            axis = (commands[side].value - paddle.getSprite().getPosition().y) / paddle.getSpeed(); // llega justo si está a menos de un paso
+        return max(-1.0f, min(1.0f, axis));
+    }
+
+    void printReport() const
+    {
+        if (responseLatency.samples == 0 && pickupLatency.samples == 0 && timeouts == 0)
+            return;
+        cout << "Bots: " << staleTicks << " ticks sin respuesta al ultimo estado, " << timeouts << " esperas vencidas" << endl;
+        responseLatency.print("publicacion -> comando escrito");
+        pickupLatency.print("publicacion -> comando leido por el juego");
+    }
+};
+
+// Bot de referencia en otro proceso: sigue la pelota que se acerca a su lado, prediciendo los
+// rebotes en las paredes. Sirve de ejemplo del protocolo y para medir la latencia.
+int runBotClient(int side)
+{
+    BotSharedMemory memory;
+    cout << "Bot " << BOT_SIDE_NAMES[side] << ": esperando al juego..." << endl;
+    while (!memory.open())
+    {
+        sleep(milliseconds(100));
+    }
+    BotSharedRegion *region = memory.get();
+    BotSharedRegion::CommandSlot &slot = region->commands[side];
+    if (slot.attached.exchange(1) != 0)
+    {
+        cout << "Ya hay un bot en el lado " << BOT_SIDE_NAMES[side] << endl;
+        return 1;
+    }
+    BotSignal stateSignal;
+    BotSignal commandSignal;
+    stateSignal.open(string("PongBotState") + BOT_SIDE_NAMES[side]);
+    commandSignal.open(string("PongBotCommand") + BOT_SIDE_NAMES[side]);
+    cout << "Bot conectado" << (region->lockstep.load() ? " (el juego espera cada comando)" : "") << endl;
+
+    LatencyHistogram wakeLatency; // publicación -> estado leído por el bot
+    Uint32 seen = 0;
+    BotCommand command;
+    memset(&command, 0, sizeof(command));
+    command.mode = BOT_COMMAND_TARGET;
+    while (region->gameAlive.load(memory_order_acquire))
+    {
+        Uint32 current = region->stateSequence.load(memory_order_acquire);
+        BotGameState state;
+        Uint32 sequence;
+        if (current == seen || (current & 1) || !seqlockRead(region->stateSequence, region->state, state, sequence))
+        {
+            stateSignal.wait(region->stateSequence, current, 100);
+            continue;
+        }
+        seen = sequence;
+        wakeLatency.add(getMonotonicNanoseconds() - state.publishNanoseconds);
+
+        // Altura a la que llegará la pelota más cercana que viene hacia este lado
+        float paddleX = side == 0 ? PADDLE_MARGIN : FIELD_WIDTH - PADDLE_MARGIN;
+        float target = PLAY_CENTER_Y;
+        float bestTime = FLT_MAX;
+        for (Uint32 i = 0; i < state.ballCount; i++)
+        {
+            float velocityX = state.ballVelocityX[i];
+            if ((side == 0) != (velocityX < 0) || velocityX == 0)
+                continue;
+            float time = (paddleX - state.ballX[i]) / velocityX;
+            if (time >= bestTime)
+                continue;
+            bestTime = time;
+            float span = (float)(FIELD_HEIGHT - HEADER_HEIGHT);
+            float y = fmod(state.ballY[i] - HEADER_HEIGHT + state.ballVelocityY[i] * time, 2 * span);
+            if (y < 0)
+                y += 2 * span;
+            target = HEADER_HEIGHT + (y > span ? 2 * span - y : y);
+        }
+
+        command.stateTick = state.tick;
+        command.value = target;
+        command.writeNanoseconds = getMonotonicNanoseconds();
+        seqlockWrite(slot.sequence, slot.command, command);
+        commandSignal.wake(slot.sequence);
+    }
+    slot.attached.store(0, memory_order_release);
+
+    cout << "El juego se cerro" << endl;
+    wakeLatency.print("publicacion -> estado leido por el bot");
+    return 0;
+}
+
+// Partido sin ventana de un bot (lado izquierdo) contra la IA DIFICIL, en lockstep: el juego
+// publica, espera el comando y avanza. Con tickRate 0 corre tan rápido como responda el bot.
+int playBotMatch(int ticks, int tickRate)
+{
+    MatchTextures textures;
+    textures.load();
+    BotLink link;
+    if (!link.open(true, false, true))
+    {
+        cout << "Error al crear la memoria compartida " << BOT_SHARED_NAME << endl;
+        return 1;
+    }
+    cout << "Esperando un bot: PongMejorado.exe --bot-client left" << endl;
+    if (!link.waitForBots(30))
+    {
+        cout << "Ningun bot se conecto" << endl;
+        return 1;
+    }
+
+    Match match(textures, 1);
+    match.setMaxScore(7);
+    match.getLeftPaddle().setIsAI(false);
+    match.getRightPaddle().setIsAI(true);
+    match.getRightPaddle().setAILevel(HARD);
+    match.reset();
+    link.publish(match);
+    link.waitForCommands();
+
+    int botWins = 0;
+    int aiWins = 0;
+    Clock clock;
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        match.tick(link.takeAxis(0, match.getLeftPaddle()), 0.0f);
+        if (match.isScoreLimitReached())
+        {
+            (match.getLeftScore() > match.getRightScore() ? botWins : aiWins)++;
+            match.reset();
+        }
+        link.publish(match);
+        link.waitForCommands();
+
+        // Ritmo del juego real: el bot duerme entre ticks como con ventana
+        if (tickRate > 0)
+        {
+            Int64 due = (Int64)(tick + 1) * 1000000 / tickRate;
+            Int64 early = due - clock.getElapsedTime().asMicroseconds();
+            if (early > 0)
+                sleep(microseconds(early));
+        }
+    }
+    double seconds = clock.getElapsedTime().asSeconds();
+
+    cout << ticks << " ticks en " << fixed << setprecision(2) << seconds << " s (" << setprecision(0) << ticks / seconds
+         << " ticks/s); partidos: bot " << botWins << ", IA " << aiWins << endl;
+    link.printReport();
+    return 0;
+}
+
+// Clase principal del juego
+class Game
+{
+private:
+    RenderWindow window;
+    GameState state;
+    // En la sección private de la clase Game
+    vector<BitmapText> pauseMenuOptions;
+    int selectedPauseOption;
+
+    // Submenús dibujados en la misma ventana; los textos se crean una sola vez
+    BitmapText optionsTitle;
+    vector<BitmapText> optionsMenuOptions;
+    int selectedOptionsOption;
+    BitmapText difficultyTitle;
+    vector<BitmapText> difficultyOptions;
+    int selectedDifficultyOption;
+
+    // Recursos
+    MatchTextures textures;
+    Font font;            // FreeType, solo como respaldo de bakedFont
+    BitmapFont bakedFont; // glifos pre-rasterizados de todos los tamaños que se usan
+
+    // Partido en curso
+    Match *match;
+
+    // Interfaz
+    BitmapText scoreLeft;
+    BitmapText scoreRight;
+    BitmapText pauseText;
+    BitmapText gameOverText;
+    BitmapText gameOverHint;
+    RectangleShape headerBar; // Barra para separar el área de puntaje del juego
+    RectangleShape centerLine;
+
+    // Capa estática (fondo, barra superior, línea central, puntajes y temporizador)
+    // compuesta en una textura que solo se vuelve a dibujar cuando cambia su contenido
+    RenderTexture staticLayer;
+    Sprite staticLayerSprite;
+    bool staticLayerDirty;
+
+    // Vista de las coordenadas lógicas del campo sobre la ventana, con franjas si no coincide la proporción
+    View fieldView;
+    int frameRate;           // frames por segundo dibujados (144, 240, 360...), independiente de TICK_RATE
+    float renderAlpha;       // fracción del tick en curso ya transcurrida, para interpolar al dibujar
+    Vector2u recordingSize;  // tamaño fijo de la ventana mientras se graba
+
+    JobSystem jobs; // hilos para las partes paralelas de cada frame (partículas, arena)
+    ParticleSystem particles;
+    SoundBank sounds;
+    MusicMixer music;
+    MatchEventQueue particleEvents; // eventos del partido para cada consumidor del hilo principal
+    MatchEventQueue soundEvents;
+    MatchEventQueue interfaceEvents;
+    Clock particleClock;
+    FrameRecorder *recorder; // nulo si no se está grabando
+    Telemetry *telemetry;    // nulo si no se registra telemetría
+
+    // Repeticiones: grabación de los partidos jugados y visor con búsqueda
+    ReplayWriter *replayWriter; // nulo si no se graban repeticiones
+    ReplayReader *replay;       // repetición abierta en el visor (estado REPLAY)
+    bool replayPaused;
+    bool replayRewinding;
+    bool replayScrubbing; // arrastrando el mouse sobre la línea de tiempo
+    RectangleShape replayBar;
+    RectangleShape replayProgress;
+    BitmapText replayText;
+    bool fixedPointPhysics;
+
+    // Arena de muchos partidos IA contra IA (estado ARENA)
+    MatchArena *arena;
+    int arenaPendingTicks; // ticks vencidos en este frame; se simulan juntos en un solo lote
+    BitmapText arenaText;
+    Clock arenaStatsClock;
+
+    // Lógica del juego
+    GameTimer *timer;
+    Menu *menu;
+    Clock inputClock; // reloj de alta resolución para las marcas de tiempo de entrada
+    InputQueue input;
+    Int64 simulationTime; // inicio del próximo tick, en microsegundos de inputClock
+
+    // Velocidad de la simulación en potencias de 2: de 0.25x (cámara lenta) a 64x (solo IA vs IA)
+    static const int MIN_SPEED_STEP = -2;
+    static const int MAX_SPEED_STEP = 6;
+    int speedStep;
+    BitmapText speedTexts[MAX_SPEED_STEP - MIN_SPEED_STEP + 1]; // uno por velocidad, para no reservar memoria al cambiarla
+
+    // Configuraciones
+    GameMode gameMode;
+
+    // Pantallas quietas: sin cambios pendientes el bucle duerme en waitEvent en lugar de dibujar
+    bool attractEnabled; // demostración IA vs IA detrás de los menús (anima el menú en cada tick)
+    bool screenDirty;    // algo cambió desde el último frame dibujado
+    bool cpuReport;
+    Int64 stateWallMicroseconds[GAME_STATE_COUNT];
+    Int64 stateCpuMicroseconds[GAME_STATE_COUNT];
+
+    Metrics metrics;               // contadores en vivo (atómicos, sin bloqueos)
+    MetricsServer *metricsServer;  // nulo si no se exponen por HTTP
+    BotLink *botLink;              // nulo si ninguna paleta la maneja un bot externo
+
+public:
+    Game(bool fixedPoint = false) : window(VideoMode(FIELD_WIDTH, FIELD_HEIGHT), "Pong 2.0"), jobs(getCpuCount()) // Aumentar altura para el área de puntaje
+    {
+        // Cargar recursos ANTES de crear el partido
+        textures.load();
+
+        if (!font.loadFromFile(FONT_PATH))
+        {
+            cout << "Error al cargar Fuente Pixel Art" << endl;
+        }
+
+        // Atlas generado con --bake-font; si no está, hornearlo ahora para que ningún texto
+        // rasterice glifos la primera vez que aparece en pantalla
+        if (!bakedFont.loadFromFile(BAKED_FONT_PATH, font))
+        {
+            bakedFont.bake(font);
+        }
+
+        // Configurar la ventana (el ritmo de frames lo controla run() para seguir
+        // sondeando la entrada mientras espera)
+        simulationTime = 0;
+
+        // Inicializar el estado del juego
+        state = MENU;
+        recorder = nullptr;
+        telemetry = nullptr;
+        replayWriter = nullptr;
+        replay = nullptr;
+        replayPaused = false;
+        replayRewinding = false;
+        replayScrubbing = false;
+        fixedPointPhysics = fixedPoint;
+        arena = nullptr;
+        arenaPendingTicks = 0;
+        particles.setJobSystem(&jobs);
+        metricsServer = nullptr;
+        botLink = nullptr;
+        attractEnabled = true;
+        screenDirty = true;
+        cpuReport = false;
+        for (int i = 0; i < GAME_STATE_COUNT; i++)
+        {
+            stateWallMicroseconds[i] = 0;
+            stateCpuMicroseconds[i] = 0;
+        }
+
+        // Crear el menú
+        menu = new Menu(bakedFont);
+
+        // Crear el partido DESPUÉS de cargar las texturas, con una semilla distinta en cada ejecución
+        match = new Match(textures, static_cast<unsigned int>(time(nullptr)));
+        match->subscribe(&particleEvents);
+        match->subscribe(&interfaceEvents);
+        match->setFixedPoint(fixedPoint);
+        match->getRightPaddle().setAILevel(menu->getAILevel1());
+
+        // Configurar el texto
+        scoreLeft.setFont(bakedFont);
+        scoreLeft.setCharacterSize(40);
+        scoreLeft.setPosition(200, 30); // Posición en la barra superior
+
+        scoreRight.setFont(bakedFont);
+        scoreRight.setCharacterSize(40);
+        scoreRight.setPosition(650, 30); // Posición en la barra superior
+
+        // Indicador de velocidad en la esquina de la barra superior (oculto a 1x)
+        const char *speedLabels[] = {"x0.25", "x0.5", "x1", "x2", "x4", "x8", "x16", "x32", "x64"};
+        speedStep = 0;
+        for (int step = MIN_SPEED_STEP; step <= MAX_SPEED_STEP; step++)
+        {
+            BitmapText &text = speedTexts[step - MIN_SPEED_STEP];
+            text.setFont(bakedFont);
+            text.setCharacterSize(30);
+            text.setString(speedLabels[step - MIN_SPEED_STEP]);
+            text.setFillColor(Color(255, 200, 0));
+            text.setOrigin(text.getLocalBounds().width, 0);
+            text.setPosition(830, 30);
+        }
+
+        // Crear barra de separación
+        headerBar.setSize(Vector2f(FIELD_WIDTH, HEADER_HEIGHT)); // Altura de la barra superior
+        headerBar.setFillColor(Color(20, 20, 20)); // Color ligeramente diferente al fondo
+        headerBar.setPosition(0, 0);
+
+        // Línea central
+        centerLine.setSize(Vector2f(2, FIELD_HEIGHT - HEADER_HEIGHT));
+        centerLine.setPosition(FIELD_WIDTH / 2, HEADER_HEIGHT);
+        centerLine.setFillColor(Color(255, 255, 255, 100));
+
+        // Línea de tiempo del visor de repeticiones
+        replayBar.setSize(Vector2f(FIELD_WIDTH - 40, 8));
+        replayBar.setPosition(20, FIELD_HEIGHT - 18);
+        replayBar.setFillColor(Color(255, 255, 255, 60));
+        replayProgress.setPosition(20, FIELD_HEIGHT - 18);
+        replayProgress.setFillColor(Color(255, 200, 0));
+        replayText.setFont(bakedFont);
+        replayText.setCharacterSize(14);
+        replayText.setPosition(20, FIELD_HEIGHT - 40);
+        arenaText.setFont(bakedFont);
+        arenaText.setCharacterSize(14);
+        arenaText.setPosition(8, 4);
+
+        // Vista lógica y capa estática a la resolución de la ventana
+        frameRate = FRAME_RATE;
+        renderAlpha = 1.0f;
+        updateView();
+
+        pauseText.setFont(bakedFont);
+        pauseText.setCharacterSize(60);
+        pauseText.setString("PAUSA");
+        FloatRect pauseBounds = pauseText.getLocalBounds();
+        pauseText.setOrigin(pauseBounds.left + pauseBounds.width / 2.0f, pauseBounds.top + pauseBounds.height / 2.0f);
+        pauseText.setPosition(FIELD_WIDTH / 2.0f, 50);
+        pauseText.setFillColor(Color::White);
+
+        // En el constructor de Game, después de inicializar pauseText
+        pauseMenuOptions.clear();
+        selectedPauseOption = 0;
+
+        BitmapText resumeOption("Continuar", bakedFont, 30);
+        resumeOption.setPosition(350, 200);
+        pauseMenuOptions.push_back(resumeOption);
+
+        BitmapText menuOption("Volver al Menu", bakedFont, 30);
+        menuOption.setPosition(350, 250);
+        pauseMenuOptions.push_back(menuOption);
+
+        BitmapText exitOption("Salir", bakedFont, 30);
+        exitOption.setPosition(350, 300);
+        pauseMenuOptions.push_back(exitOption);
+
+        // Centrar las opciones horizontalmente
+        for (auto &option : pauseMenuOptions)
+        {
+            FloatRect bounds = option.getLocalBounds();
+            option.setOrigin(bounds.width / 2, 0);
+            option.setPosition(425, option.getPosition().y);
+        }
+
+        // Resaltar la opción seleccionada
+        pauseMenuOptions[selectedPauseOption].setFillColor(Color::Yellow);
+
+        // Menú de opciones (los valores se escriben en refreshOptionsMenu)
+        optionsTitle.setFont(bakedFont);
+        optionsTitle.setCharacterSize(50);
+        optionsTitle.setString("OPCIONES");
+        FloatRect titleBounds = optionsTitle.getLocalBounds();
+        optionsTitle.setOrigin(titleBounds.left + titleBounds.width / 2.0f, titleBounds.top);
+        optionsTitle.setPosition(FIELD_WIDTH / 2.0f, 50);
+
+        selectedOptionsOption = 0;
+        for (int i = 0; i < 6; i++)
+        {
+            optionsMenuOptions.push_back(BitmapText("", bakedFont, 30));
+        }
+        refreshOptionsMenu();
+
+        // Menú de dificultad para Player vs IA
+        difficultyTitle.setFont(bakedFont);
+        difficultyTitle.setCharacterSize(40);
+        difficultyTitle.setString("SELECCIONA DIFICULTAD");
+        titleBounds = difficultyTitle.getLocalBounds();
+        difficultyTitle.setOrigin(titleBounds.left + titleBounds.width / 2.0f, titleBounds.top);
+        difficultyTitle.setPosition(FIELD_WIDTH / 2.0f, 100);
+
+        selectedDifficultyOption = 0;
+        const char *difficultyNames[] = {"FACIL", "MEDIA", "DIFICIL", "IMPOSIBLE"};
+        for (int i = 0; i < 4; i++)
+        {
+            BitmapText option(difficultyNames[i], bakedFont, 30);
+            FloatRect bounds = option.getLocalBounds();
+            option.setOrigin(bounds.left + bounds.width / 2.0f, bounds.top);
+            option.setPosition(FIELD_WIDTH / 2.0f, 200 + i * 50);
+            difficultyOptions.push_back(option);
+        }
+        difficultyOptions[selectedDifficultyOption].setFillColor(Color::Yellow);
+
+        gameOverText.setFont(bakedFont);
+        gameOverText.setCharacterSize(30); // Tamaño más pequeño
+        gameOverText.setFillColor(Color::White);
+
+        // Centrar el texto horizontalmente
+        FloatRect textBounds = gameOverText.getLocalBounds();
+        gameOverText.setOrigin(textBounds.left + textBounds.width / 2.0f, textBounds.top + textBounds.height / 2.0f);
+        gameOverText.setPosition(425, 275); // Centro de la pantalla
+
+        gameOverHint.setFont(bakedFont);
+        gameOverHint.setCharacterSize(14);
+        gameOverHint.setString("Presiona R para reiniciar o M para menu");
+        FloatRect hintBounds = gameOverHint.getLocalBounds();
+        gameOverHint.setOrigin(hintBounds.left + hintBounds.width / 2.0f, hintBounds.top + hintBounds.height / 2.0f);
+        gameOverHint.setPosition(FIELD_WIDTH / 2.0f, 50);
+        gameOverHint.setFillColor(Color::White);
+
+        updateScoreDisplay();
+
+        // Crear el temporizador (3 minutos por defecto)
+        timer = new GameTimer(bakedFont, 3, match->getClock());
+
+        // Configuraciones por defecto
+        gameMode = PLAYER_VS_AI;
+
+        // Partido de demostración detrás del menú principal
+        startAttractMode();
+    }
+
+    ~Game()
+    {
+        sounds.printStats();
+        unsigned int dropped = particleEvents.getDropped() + soundEvents.getDropped() + interfaceEvents.getDropped();
+        if (dropped > 0)
+            cout << "Eventos del partido descartados por colas llenas: " << dropped << endl;
+        instrumentPrintStats();
+        if (cpuReport)
+            printCpuReport();
+        if (recorder)
+        {
+            recorder->finish();
+            recorder->printStats();
+            delete recorder;
+        }
+        if (telemetry)
+        {
+            telemetry->finish();
+            telemetry->printStats();
+            delete telemetry;
+        }
+        if (replay && replay->getDesyncCount() > 0)
+        {
+            cout << "Repeticion: " << replay->getDesyncCount() << " keyframes no coincidieron con la re-simulacion" << endl;
+        }
+        if (botLink)
+        {
+            botLink->printReport();
+            delete botLink;
+        }
+        delete metricsServer;
+        delete arena;
+        delete replayWriter;
+        delete replay;
+        delete timer;
+        delete menu;
+        delete match;
+    }
+
+    // Menús sin el partido de demostración detrás: la pantalla queda quieta y el bucle puede dormir
+    void setAttractMode(bool enabled)
+    {
+        attractEnabled = enabled;
+    }
+
+    // Expone las métricas en http://127.0.0.1:<port>/metrics desde un hilo propio
+    bool startMetricsServer(unsigned short port)
+    {
+        metricsServer = new MetricsServer(metrics);
+        if (!metricsServer->start(port))
+        {
+            cout << "Error al abrir el puerto de metricas " << port << endl;
+            delete metricsServer;
+            metricsServer = nullptr;
+            return false;
+        }
+        cout << "Metricas en http://127.0.0.1:" << port << "/metrics" << endl;
+        return true;
+    }
+
+    // Deja las paletas de los lados pedidos en manos de bots externos (ver runBotClient)
+    bool openBotLink(bool left, bool right)
+    {
+        botLink = new BotLink();
+        if (!botLink->open(left, right, false))
+        {
+            cout << "Error al crear la memoria compartida para bots " << BOT_SHARED_NAME << endl;
+            delete botLink;
+            botLink = nullptr;
+            return false;
+        }
+        bool sides[2] = {left, right};
+        for (int side = 0; side < 2; side++)
+        {
+            if (sides[side])
+                cout << "Bots: conectar con PongMejorado.exe --bot-client " << BOT_SIDE_NAMES[side] << endl;
+        }
+        return true;
+    }
+
+    // Al salir, informa cuánta CPU usó el proceso en cada estado del juego
+    void enableCpuReport()
+    {
+        cpuReport = true;
+    }
+
+    // Graba cada partido jugado (no la demostración) en el archivo; cada partido nuevo reemplaza al anterior
+    void startReplayRecording(const string &path)
+    {
+        replayWriter = new ReplayWriter(path);
+    }
+
+    // Abre una repetición en el visor, desde el principio
+    bool openReplay(const string &path)
+    {
+        ReplayReader *reader = new ReplayReader();
+        if (!reader->open(path))
+        {
+            delete reader;
+            return false;
+        }
+        delete replay;
+        replay = reader;
+
+        // La repetición suena como un partido, pero no vuelve a registrar telemetría
+        match->subscribe(&soundEvents);
+        if (telemetry)
+            match->unsubscribe(&telemetry->getQueue());
+
+        state = REPLAY;
+        replayPaused = false;
+        replayRewinding = false;
+        seekReplay(0);
+        timer->reset();
+        setSpeedStep(0);
+        updateReplayText();
+        return true;
+    }
+
+    // Cuadrícula de partidos IA contra IA simulados entre todos los núcleos; Escape vuelve al menú
+    void startArena(int matchCount)
+    {
+        delete arena;
+        arena = new MatchArena(textures, jobs, max(1, matchCount), static_cast<unsigned int>(time(nullptr)));
+        arenaPendingTicks = 0;
+        state = ARENA;
+        setSpeedStep(0);
+        arenaText.setString("");
+        arenaStatsClock.restart();
+    }
+
+    // Medición de punta a punta: simulación y dibujo de la arena con todos los núcleos, sin
+    // esperar entre frames (--bench-jobs mide cómo escala con la cantidad de hilos)
+    void benchmarkArena(int matchCount, int frames)
+    {
+        startArena(matchCount);
+        Int64 renderMicroseconds = 0;
+        Clock clock;
+        for (int frame = 0; frame < frames && window.isOpen(); frame++)
+        {
+            handleEvents();
+            arena->simulate(ARENA_BENCH_TICKS_PER_FRAME);
+            clock.restart();
+            render();
+            renderMicroseconds += clock.getElapsedTime().asMicroseconds();
+        }
+        double seconds = arena->getSimulationMicroseconds() / 1000000.0;
+        cout << matchCount << " partidos, " << arena->getThreadCount() << " hilos: " << (Uint64)(arena->getSimulatedTicks() / max(seconds, 1e-6))
+             << " ticks de partido/s, simulacion " << arena->getSimulationMicroseconds() / max(1, frames) << " us/frame ("
+             << ARENA_BENCH_TICKS_PER_FRAME << " ticks), dibujo " << renderMicroseconds / max(1, frames) << " us/frame, "
+             << arena->getVertexCount() << " vertices" << (arena->isReducedDetail() ? " (detalle reducido)" : "") << endl;
+        delete arena;
+        arena = nullptr;
+        startAttractMode();
+    }
+
+    // Tamaño inicial de la ventana en píxeles; el campo se escala conservando la proporción
+    void setResolution(unsigned int width, unsigned int height)
+    {
+        window.setSize(Vector2u(width, height));
+        updateView();
+    }
+
+    // Frecuencia de dibujo (p. ej. la del monitor); la simulación sigue a TICK_RATE
+    void setFrameRate(int fps)
+    {
+        frameRate = max(30, min(1000, fps));
+    }
+
+    // Graba lo que se ve en la ventana (menús con la demostración IA vs IA incluidos)
+    void startRecording(const string &path, int fps)
+    {
+        recordingSize = window.getSize();
+        recorder = new FrameRecorder(recordingSize.x, recordingSize.y, path, fps, frameRate);
+    }
+
+    // Registra la telemetría de todos los partidos (incluida la demostración) en un archivo binario
+    void startTelemetry(const string &path)
+    {
+        telemetry = new Telemetry(path);
+        match->subscribe(&telemetry->getQueue());
+    }
+
+    void run()
+    {
+        Clock frameClock;
+        instrumentBegin();
+
+        while (window.isOpen())
+        {
+            GameState frameState = state;
+            Int64 frameStart = inputClock.getElapsedTime().asMicroseconds();
+            Int64 cpuStart = getProcessCpuMicroseconds();
+
+            // Nada que animar ni dibujar: bloquearse hasta el próximo evento en lugar de repetir
+            // el mismo frame. El tiempo dormido no se simula ni se anima al despertar.
+            if (canIdle())
+            {
+                instrumentSetPhase(PHASE_EVENTS);
+                Event event;
+                if (window.waitEvent(event))
+                {
+                    handleEvent(event);
+                }
+                handleEvents();
+
+                Int64 now = inputClock.getElapsedTime().asMicroseconds();
+                input.integrate(simulationTime, now);
+                simulationTime = now;
+                particleClock.restart();
+                frameClock.restart();
+                accountStateTime(frameState, frameStart, cpuStart);
+                continue;
+            }
+
+            bool playingAtStart = state == PLAYING;
+            instrumentSetPhase(PHASE_EVENTS);
+            handleEvents();
+
+            // Duración real de un tick a la velocidad actual: a 64x corren ~64 ticks por frame
+            // y solo se dibuja el estado del último
+            Int64 tickMicroseconds = speedStep >= 0 ? TICK_MICROSECONDS >> speedStep : TICK_MICROSECONDS << -speedStep;
+
+            // Si nos atrasamos demasiado (p. ej. ventana arrastrada) no recuperar los ticks perdidos
+            Int64 now = inputClock.getElapsedTime().asMicroseconds();
+            if (now - simulationTime > TICK_MICROSECONDS * 30)
+            {
+                input.integrate(simulationTime, now - tickMicroseconds);
+                simulationTime = now - tickMicroseconds;
+            }
+
+            // Ejecutar todos los ticks de simulación cuyo intervalo ya terminó
+            instrumentSetPhase(PHASE_SIMULATION);
+            while (simulationTime + tickMicroseconds <= now)
+            {
+                input.integrate(simulationTime, simulationTime + tickMicroseconds);
+                Int64 tickStart = inputClock.getElapsedTime().asMicroseconds();
+                update();
+                metrics.recordTick(inputClock.getElapsedTime().asMicroseconds() - tickStart);
+                simulationTime += tickMicroseconds;
+            }
+            if (state == ARENA)
+            {
+                arena->simulate(arenaPendingTicks);
+                arenaPendingTicks = 0;
+            }
+
+            // Dibujar entre los dos últimos ticks según cuánto avanzó el tick en curso; sin
+            // simulación en marcha (pausa, fin del partido) se dibuja el último tick tal cual
+            bool replayStill = state == REPLAY && (replayPaused || replayRewinding);
+            if (state == PAUSED || state == GAME_OVER || replayStill)
+                renderAlpha = 1.0f;
+            else
+                renderAlpha = min(1.0f, (float)(now - simulationTime) / tickMicroseconds);
+
+            // Tiempo de cada fase para las métricas (la espera del final no cuenta como eventos)
+            Int64 phaseMicroseconds[PHASE_COUNT];
+            phaseMicroseconds[PHASE_EVENTS] = now - frameStart;
+            Int64 phaseEnd = inputClock.getElapsedTime().asMicroseconds();
+            phaseMicroseconds[PHASE_SIMULATION] = phaseEnd - now;
+
+            // Consumir los eventos publicados durante los ticks de este frame
+            instrumentSetPhase(PHASE_EFFECTS);
+            particles.consume(particleEvents);
+            sounds.consume(soundEvents);
+            sounds.flush();
+            consumeInterfaceEvents();
+
+            // Las partículas y la mezcla de música se actualizan por frame, fuera del tick de simulación;
+            // las partículas siguen la velocidad de la simulación
+            float frameSeconds = min(particleClock.restart().asSeconds(), 0.1f);
+            particles.update((float)ldexp(frameSeconds, speedStep));
+            music.update(computeMusicIntensity(), frameSeconds, state == PAUSED);
+
+            Int64 effectsEnd = inputClock.getElapsedTime().asMicroseconds();
+            phaseMicroseconds[PHASE_EFFECTS] = effectsEnd - phaseEnd;
+
+            instrumentSetPhase(PHASE_RENDER);
+            render();
+            phaseMicroseconds[PHASE_RENDER] = inputClock.getElapsedTime().asMicroseconds() - effectsEnd;
+
+            // Esperar al siguiente frame sondeando la entrada para que las marcas
+            // de tiempo tengan resolución de ~1 ms en lugar de un frame
+            instrumentSetPhase(PHASE_EVENTS);
+            while (window.isOpen() && frameClock.getElapsedTime().asMicroseconds() < 1000000 / frameRate)
+            {
+                handleEvents();
+                sleep(microseconds(INPUT_POLL_MICROSECONDS));
+            }
+            frameClock.restart();
+
+            Int64 frameEnd = inputClock.getElapsedTime().asMicroseconds();
+            metrics.recordMatch(state, *match);
+            metrics.recordAllocations();
+            metrics.recordFrame(frameEnd, frameEnd - frameStart, phaseMicroseconds);
+
+            // El presupuesto de reservas solo aplica a frames jugados de principio a fin
+            instrumentEndFrame(playingAtStart && state == PLAYING);
+            accountStateTime(frameState, frameStart, cpuStart);
+        }
+    }
+
+private:
+    // Se puede dormir si la pantalla no cambió, no hay partículas vivas ni fundidos de música y
+    // el estado no avanza solo (pausa, fin del partido, repetición detenida o menús sin demostración)
+    bool canIdle() const
+    {
+        if (screenDirty || recorder || particles.getCount() > 0 || !music.isSettled())
+            return false;
+        bool stillMenu = !attractEnabled && (state == MENU || state == OPTIONS || state == AI_DIFFICULTY);
+        bool stillReplay = state == REPLAY && replayPaused && !replayScrubbing;
+        return state == PAUSED || state == GAME_OVER || stillMenu || stillReplay;
+    }
+
+    void accountStateTime(GameState frameState, Int64 frameStart, Int64 cpuStart)
+    {
+        stateWallMicroseconds[frameState] += inputClock.getElapsedTime().asMicroseconds() - frameStart;
+        stateCpuMicroseconds[frameState] += getProcessCpuMicroseconds() - cpuStart;
+    }
+
+    void printCpuReport() const
+    {
+        cout << "Uso de CPU por estado (todos los hilos, % de un nucleo):" << endl;
+        for (int i = 0; i < GAME_STATE_COUNT; i++)
+        {
+            if (stateWallMicroseconds[i] == 0)
+                continue;
+            cout << "  " << GAME_STATE_NAMES[i] << ": " << fixed << setprecision(1) << 100.0 * stateCpuMicroseconds[i] / stateWallMicroseconds[i]
+                 << "% durante " << stateWallMicroseconds[i] / 1000000.0 << " s" << endl;
+        }
+    }
+
+    void handleEvents()
+    {
+        Event event;
+        while (window.pollEvent(event))
+        {
+            handleEvent(event);
+        }
+    }
+
+    void handleEvent(const Event &event)
+    {
+        // Cualquier evento puede cambiar lo que se ve (menús, ventana, mouse sobre la línea de tiempo)
+        screenDirty = true;
+
+        if (event.type == Event::Closed)
+        {
+            window.close();
+        }
+        else if (state == REPLAY && event.type == Event::MouseButtonPressed && event.mouseButton.button == Mouse::Left)
+        {
+            replayScrubbing = scrubReplay(event.mouseButton.x, event.mouseButton.y, true);
+        }
+        else if (state == REPLAY && event.type == Event::MouseMoved && replayScrubbing)
+        {
+            scrubReplay(event.mouseMove.x, event.mouseMove.y, false);
+        }
+        else if (event.type == Event::MouseButtonReleased)
+        {
+            replayScrubbing = false;
+        }
+        else if (event.type == Event::Resized)
+        {
+            // El video grabado tiene tamaño fijo, así que no se redimensiona mientras se graba
+            if (recorder && window.getSize() != recordingSize)
+                window.setSize(recordingSize);
+            updateView();
+        }
+
+        // Registrar todas las pulsaciones con su marca de tiempo para la simulación
+        if (event.type == Event::KeyPressed || event.type == Event::KeyReleased)
+        {
+            input.push(event.key.code, event.type == Event::KeyPressed, inputClock.getElapsedTime().asMicroseconds());
+        }
+        else if (event.type == Event::LostFocus)
+        {
+            input.releaseAll(inputClock.getElapsedTime().asMicroseconds());
+        }
+
+        if (event.type == Event::KeyPressed)
+        {
+            if (state == MENU)
+            {
+                handleMenuInput(event.key.code);
+            }
+            else if (state == OPTIONS)
+            {
+                handleOptionsInput(event.key.code);
+            }
+            else if (state == AI_DIFFICULTY)
+            {
+                handleDifficultyInput(event.key.code);
+            }
+            else if (state == PLAYING)
+            {
+                if (event.key.code == Keyboard::PageUp)
+                {
+                    setSpeedStep(speedStep + 1);
+                }
+                else if (event.key.code == Keyboard::PageDown)
+                {
+                    setSpeedStep(speedStep - 1);
+                }
+                else if (event.key.code == Keyboard::Home)
+                {
+                    setSpeedStep(0);
+                }
+                else if (event.key.code == Keyboard::Escape)
+                {
+                    state = PAUSED;
+                    // Resetear la selección al pausar
+                    selectedPauseOption = 0;
+                    // Actualizar colores de las opciones
+                    for (auto &option : pauseMenuOptions)
+                    {
+                        option.setFillColor(Color::White);
+                    }
+                    pauseMenuOptions[selectedPauseOption].setFillColor(Color::Yellow);
+                }
+            }
+            else if (state == PAUSED)
+            {
+                switch (event.key.code)
+                {
+                case Keyboard::Escape:
+                    // Volver al juego al presionar Escape nuevamente
+                    state = PLAYING;
+                    break;
+
+                case Keyboard::Up:
+                    // Navegar hacia arriba en el menú
+                    pauseMenuOptions[selectedPauseOption].setFillColor(Color::White);
+                    selectedPauseOption = (selectedPauseOption - 1 + pauseMenuOptions.size()) % pauseMenuOptions.size();
+                    pauseMenuOptions[selectedPauseOption].setFillColor(Color::Yellow);
+                    break;
+
+                case Keyboard::Down:
+                    // Navegar hacia abajo en el menú
+                    pauseMenuOptions[selectedPauseOption].setFillColor(Color::White);
+                    selectedPauseOption = (selectedPauseOption + 1) % pauseMenuOptions.size();
+                    pauseMenuOptions[selectedPauseOption].setFillColor(Color::Yellow);
+                    break;
+
+                case Keyboard::Return:
+                    // Seleccionar opción
+                    handlePauseMenuSelection();
+                    break;
+                }
+            }
+            else if (state == REPLAY)
+            {
+                handleReplayInput(event.key.code);
+            }
+            else if (state == ARENA)
+            {
+                handleArenaInput(event.key.code);
+            }
+            else if (state == GAME_OVER)
+            {
+                if (event.key.code == Keyboard::R)
+                {
+                    resetGame();
+                    state = PLAYING;
+                }
+                else if (event.key.code == Keyboard::M)
+                {
+                    startAttractMode();
+                }
+            }
+        }
+    }
+
+    void handlePauseMenuSelection()
+    {
+        switch (selectedPauseOption)
+        {
+        case 0: // Continuar
+            state = PLAYING;
+            break;
+
+        case 1: // Volver al menú
+            startAttractMode();
+            break;
+
+        case 2: // Salir
+            window.close();
+            break;
+        }
+    }
+
+    void handleMenuInput(Keyboard::Key key)
+    {
+        if (key == Keyboard::Up)
+        {
+            menu->moveUp();
+        }
+        else if (key == Keyboard::Down)
+        {
+            menu->moveDown();
+        }
+        else if (key == Keyboard::Return)
+        {
+            int option = menu->getSelectedOption();
+            switch (option)
+            {
+            case 0: // Un Jugador vs IA
+                // En lugar de iniciar el juego directamente, pasar al submenú de dificultad
+                state = AI_DIFFICULTY;
+                break;
+            case 1: // Dos Jugadores
+                gameMode = PLAYER_VS_PLAYER;
+                match->getLeftPaddle().setIsAI(false);
+                match->getRightPaddle().setIsAI(false);
+                resetGame();
+                state = PLAYING;
+                break;
+            case 2: // IA vs IA
+                gameMode = AI_VS_AI;
+                match->getLeftPaddle().setIsAI(true);
+                match->getRightPaddle().setIsAI(true);
+                match->getLeftPaddle().setAILevel(menu->getAILevel1());
+                match->getRightPaddle().setAILevel(menu->getAILevel2());
+                resetGame();
+                state = PLAYING;
+                break;
+            case 3: // Opciones
+                // Pasar al menú de opciones
+                refreshOptionsMenu();
+                state = OPTIONS;
+                break;
+            case 4: // Salir
+                window.close();
+                break;
+            }
+        }
+    }
+
+    void update()
+    {
+        if (state == PLAYING)
+        {
+            // Actualizar temporizador
+            if (timer->updateDisplay())
+            {
+                staticLayerDirty = true;
+            }
+
+            // Verificar condiciones de fin de juego
+            int leftScore = match->getLeftScore();
+            int rightScore = match->getRightScore();
+            if (timer->isTimeUp() || match->isScoreLimitReached())
+            {
+                // Configurar el texto de game over
+                gameOverText.setFont(bakedFont);
+                gameOverText.setString(leftScore > rightScore ? "JUGADOR 1 GANA!" : (rightScore > leftScore ? "JUGADOR 2 GANA!" : "EMPATE!"));
+                gameOverText.setCharacterSize(30); // Tamaño más pequeño
+
+                // Centrar el texto horizontalmente y verticalmente
+                FloatRect textBounds = gameOverText.getLocalBounds();
+                gameOverText.setOrigin(textBounds.left + textBounds.width / 2.0f, textBounds.top + textBounds.height / 2.0f);
+                gameOverText.setPosition(425, 200); // Posicionado más arriba en la pantalla
+
+                if (replayWriter)
+                    replayWriter->finish();
+                state = GAME_OVER;
+                return;
+            }
+
+            // Avanzar un tick de la simulación con la entrada integrada de este tick
+            float leftAxis = input.getHeldFraction(Keyboard::S) - input.getHeldFraction(Keyboard::W);
+            float rightAxis = input.getHeldFraction(Keyboard::Down) - input.getHeldFraction(Keyboard::Up);
+            if (botLink && botLink->controls(0))
+                leftAxis = botLink->takeAxis(0, match->getLeftPaddle());
+            if (botLink && botLink->controls(1))
+                rightAxis = botLink->takeAxis(1, match->getRightPaddle());
+            if (replayWriter)
+                replayWriter->record(*match, leftAxis, rightAxis);
+            match->tick(leftAxis, rightAxis);
+            if (botLink)
+                botLink->publish(*match);
+        }
+        else if (state == REPLAY)
+        {
+            if (!replayPaused)
+            {
+                if (replayRewinding && replay->getTick() > 0)
+                {
+                    seekReplay(replay->getTick() - 1);
+                }
+                else if (replayRewinding || !replay->step(*match))
+                {
+                    // Se llegó al principio o al final
+                    replayPaused = true;
+                    replayRewinding = false;
+                    updateReplayText();
+                }
+            }
+            if (timer->updateDisplay())
+            {
+                staticLayerDirty = true;
+            }
+        }
+        else if (state == ARENA)
+        {
+            // Los partidos de la arena avanzan en un solo lote por frame, repartido entre los hilos
+            arenaPendingTicks++;
+        }
+        else if ((state == MENU || state == OPTIONS || state == AI_DIFFICULTY) && attractEnabled)
+        {
+            // El partido de demostración sigue corriendo mientras se navegan los menús
+            if (match->isScoreLimitReached())
+            {
+                startAttractMode();
+            }
+            match->tick(0.0f, 0.0f);
+        }
+    }
+
+    // Intensidad del partido en [0, 1] a partir de la velocidad de la pelota más rápida,
+    // lo parejo del marcador y el tiempo restante
+    float computeMusicIntensity()
+    {
+        if (state != PLAYING && state != PAUSED)
+            return 0.0f;
+
+        float speed = 0.0f;
+        for (const auto &ball : match->getBalls())
+        {
+            if (!ball.isActive())
+                continue;
+            float range = ball.getMaxSpeed() - ball.getBaseSpeed();
+            speed = max(speed, (ball.getSpeed() - ball.getBaseSpeed()) / range);
+        }
+        speed = max(0.0f, min(1.0f, speed));
+
+        // Marcador parejo y cerca del puntaje máximo = más tensión
+        int leftScore = match->getLeftScore();
+        int rightScore = match->getRightScore();
+        float closeness = 1.0f - min(1.0f, abs(leftScore - rightScore) / 3.0f);
+        float nearEnd = (float)max(leftScore, rightScore) / max(1, match->getMaxScore());
+        float score = closeness * (0.5f + 0.5f * min(1.0f, nearEnd));
+
+        // El último tercio del tiempo sube la intensidad progresivamente
+        float timePressure = max(0.0f, 1.0f - timer->getRemainingFraction() * 3.0f);
+
+        return 0.5f * speed + 0.25f * score + 0.25f * timePressure;
+    }
+
+    // Ajusta la vista lógica a la ventana conservando la proporción del campo y recrea la
+    // capa estática a la resolución real del área visible para no perder nitidez
+    void updateView()
+    {
+        Vector2u size = window.getSize();
+        float windowRatio = (float)size.x / max(1u, size.y);
+        float fieldRatio = (float)FIELD_WIDTH / FIELD_HEIGHT;
+        FloatRect viewport(0, 0, 1, 1);
+        if (windowRatio > fieldRatio)
+        {
+            viewport.width = fieldRatio / windowRatio;
+            viewport.left = (1 - viewport.width) / 2;
+        }
+        else
+        {
+            viewport.height = windowRatio / fieldRatio;
+            viewport.top = (1 - viewport.height) / 2;
+        }
+        fieldView.reset(FloatRect(0, 0, FIELD_WIDTH, FIELD_HEIGHT));
+        fieldView.setViewport(viewport);
+        window.setView(fieldView);
+
+        unsigned int layerWidth = max(1u, (unsigned int)(size.x * viewport.width + 0.5f));
+        unsigned int layerHeight = max(1u, (unsigned int)(size.y * viewport.height + 0.5f));
+        if (!staticLayer.create(layerWidth, layerHeight))
+        {
+            cout << "Error al crear la capa estatica" << endl;
+        }
+        staticLayer.setView(View(FloatRect(0, 0, FIELD_WIDTH, FIELD_HEIGHT)));
+        staticLayerSprite.setTexture(staticLayer.getTexture(), true);
+        staticLayerSprite.setScale((float)FIELD_WIDTH / layerWidth, (float)FIELD_HEIGHT / layerHeight);
+        staticLayerDirty = true;
+    }
+
+    void redrawStaticLayer()
+    {
+        staticLayer.clear(Color(0, 0, 0));
+        staticLayer.draw(headerBar);
+        staticLayer.draw(centerLine);
+        staticLayer.draw(scoreLeft);
+        staticLayer.draw(scoreRight);
+        staticLayer.draw(timer->getDisplay());
+        staticLayer.display();
+        staticLayerDirty = false;
+    }
+
+    // Desplaza un objeto de su posición en el último tick a la interpolada con el anterior
+    RenderStates interpolate(Vector2f previous, Vector2f current) const
+    {
+        RenderStates states;
+        states.transform.translate((previous - current) * (1.0f - renderAlpha));
+        return states;
+    }
+
+    // Dibuja el campo, el partido y las partículas
+    void drawMatch()
+    {
+        // La capa estática cubre todo el campo; limpiar solo hace falta por las franjas laterales
+        window.clear(Color::Black);
+        if (staticLayerDirty)
+        {
+            redrawStaticLayer();
+        }
+        window.draw(staticLayerSprite);
+
+        // Dibujar pelotas
+        for (const auto &ball : match->getBalls())
+        {
+            if (ball.isActive() && ball.isVisible())
+            {
+                window.draw(ball.getSprite(), interpolate(ball.getPreviousPosition(), ball.getPosition()));
+            }
+        }
+
+        // Dibujar paletas
+        Paddle &leftPaddle = match->getLeftPaddle();
+        Paddle &rightPaddle = match->getRightPaddle();
+        if (!match->isInvisibleLeftActive())
+            window.draw(leftPaddle.getSprite(), interpolate(leftPaddle.getPreviousPosition(), leftPaddle.getSprite().getPosition()));
+        if (!match->isInvisibleRightActive())
+            window.draw(rightPaddle.getSprite(), interpolate(rightPaddle.getPreviousPosition(), rightPaddle.getSprite().getPosition()));
+
+        // Dibujar barreras si están activas
+        if (match->isBarrierLeftActive())
+            window.draw(match->getLeftBarrier());
+        if (match->isBarrierRightActive())
+            window.draw(match->getRightBarrier());
+
+        // Dibujar power-ups
+        for (const auto &powerUp : match->getPowerUps())
+        {
+            if (powerUp.isActive() && !powerUp.isCollected())
+            {
+                window.draw(powerUp.getSprite());
+            }
+        }
+
+        // Dibujar partículas (una sola llamada de dibujo)
+        particles.draw(window);
+
+        if (speedStep != 0 && state != MENU && state != OPTIONS && state != AI_DIFFICULTY)
+        {
+            window.draw(speedTexts[speedStep - MIN_SPEED_STEP]);
+        }
+    }
+
+    void render()
+    {
+        if (state == ARENA)
+        {
+            drawArena();
+        }
+        else if (state == MENU || state == OPTIONS || state == AI_DIFFICULTY)
+        {
+            // Menús sobre el partido de demostración oscurecido
+            drawMatch();
+
+            RectangleShape overlay(Vector2f(FIELD_WIDTH, FIELD_HEIGHT));
+            overlay.setFillColor(Color(0, 0, 0, 200));
+            window.draw(overlay);
+
+            if (state == MENU)
+            {
+                menu->draw(window);
+            }
+            else if (state == OPTIONS)
+            {
+                window.draw(optionsTitle);
+                for (const auto &option : optionsMenuOptions)
+                {
+                    window.draw(option);
+                }
+            }
+            else
+            {
+                window.draw(difficultyTitle);
+                for (const auto &option : difficultyOptions)
+                {
+                    window.draw(option);
+                }
+            }
+        }
+        else
+        {
+            drawMatch();
+
+            // Menú de pausa
+            if (state == PAUSED)
+            {
+                // Fondo semitransparente oscuro
+                RectangleShape overlay(Vector2f(FIELD_WIDTH, FIELD_HEIGHT));
+                overlay.setFillColor(Color(0, 0, 0, 180));
+                window.draw(overlay);
+
+                // Texto "PAUSA" centrado
+                window.draw(pauseText);
+
+                // Dibujar opciones del menú de pausa
+                for (const auto &option : pauseMenuOptions)
+                {
+                    window.draw(option);
+                }
+            }
+
+            // Línea de tiempo y controles del visor de repeticiones
+            if (state == REPLAY)
             {
-                if (!ball.isActive())
-                    continue;
+                float progress = replay->getTickCount() > 0 ? (float)replay->getTick() / replay->getTickCount() : 0.0f;
+                replayProgress.setSize(Vector2f(replayBar.getSize().x * progress, replayBar.getSize().y));
+                window.draw(replayBar);
+                window.draw(replayProgress);
+                window.draw(replayText);
+            }
 
-                FloatRect ballBounds = ball.getSprite().getGlobalBounds();
-                if (ballBounds.intersects(barrierBounds))
-                {
-                    // Invertir la dirección horizontal de la pelota
-                    ball.reverseX();
-                    // Mover la pelota fuera de la barrera para evitar colisiones múltiples
-                    Vector2f ballPos = ball.getPosition();
-                    if (ball.getVelocity().x < 0)
-                    {
-                        ball.getSprite().setPosition(barrierBounds.left + barrierBounds.width + ballBounds.width / 2, ballPos.y);
-                    }
-                    else
-                    {
-                        ball.getSprite().setPosition(barrierBounds.left - ballBounds.width / 2, ballPos.y);
-                    }
-                }
+            // Pantalla de fin de juego
+            if (state == GAME_OVER)
+            {
+                RectangleShape overlay(Vector2f(FIELD_WIDTH, FIELD_HEIGHT));
+                overlay.setFillColor(Color(0, 0, 0, 180));
+                window.draw(overlay);
+
+                window.draw(gameOverText);
+
+                // Instrucciones para continuar
+                window.draw(gameOverHint);
+            }
+        }
+
+        if (recorder)
+        {
+            recorder->capture();
+        }
+
+        window.display();
+        screenDirty = false;
+    }
+
+    void resetGame()
+    {
+        // Aplicar configuraciones del menú y reiniciar el partido (con sonido, a diferencia de la demostración)
+        match->subscribe(&soundEvents);
+        match->setMaxScore(menu->getMaxScore());
+        match->setPowerUpsEnabled(menu->arePowerUpsEnabled());
+        if (botLink)
+        {
+            // El bot reemplaza al jugador o a la IA de su lado
+            if (botLink->controls(0))
+                match->getLeftPaddle().setIsAI(false);
+            if (botLink->controls(1))
+                match->getRightPaddle().setIsAI(false);
+        }
+        match->reset();
+        particles.clear();
+        updateScoreDisplay();
+
+        // Reiniciar temporizador
+        timer->reset();
+
+        // Cada partido jugado empieza una repetición nueva desde su estado inicial
+        if (replayWriter)
+            replayWriter->begin();
+
+        // La cámara lenta se conserva entre partidos, el avance rápido solo en IA vs IA
+        setSpeedStep(speedStep);
+    }
+
+    // Cambia la velocidad de la simulación; con jugadores humanos no pasa de 1x
+    void setSpeedStep(int step)
+    {
+        bool humanPlayer = state != REPLAY && state != ARENA && (!match->getLeftPaddle().getIsAI() || !match->getRightPaddle().getIsAI());
+        int maxStep = humanPlayer ? 0 : MAX_SPEED_STEP;
+        speedStep = max(MIN_SPEED_STEP, min(maxStep, step));
+    }
+
+    // El marcador en pantalla solo cambia con un gol o al comenzar un partido
+    void consumeInterfaceEvents()
+    {
+        MatchEvent event;
+        bool scoreChanged = false;
+        while (interfaceEvents.pop(event))
+        {
+            if (event.type == EVENT_GOAL || event.type == EVENT_MATCH_START)
+                scoreChanged = true;
+        }
+        if (scoreChanged)
+            updateScoreDisplay();
+    }
+
+    void updateScoreDisplay()
+    {
+        scoreLeft.setString(to_string(match->getLeftScore()));
+        scoreRight.setString(to_string(match->getRightScore()));
+        staticLayerDirty = true;
+    }
+
+    // Visor de repeticiones: Espacio pausa, flechas buscan (o avanzan un tick en pausa),
+    // R rebobina, Inicio/Fin van a los extremos y RePág/AvPág cambian la velocidad
+    void handleReplayInput(Keyboard::Key key)
+    {
+        Uint32 tick = replay->getTick();
+        switch (key)
+        {
+        case Keyboard::Escape:
+            startAttractMode();
+            return;
+        case Keyboard::Space:
+            replayPaused = !replayPaused;
+            replayRewinding = false;
+            break;
+        case Keyboard::R:
+            replayRewinding = !replayRewinding;
+            replayPaused = false;
+            break;
+        case Keyboard::Right:
+            if (replayPaused)
+                replay->step(*match);
+            else
+                seekReplay(tick + 5 * TICK_RATE);
+            break;
+        case Keyboard::Left:
+            if (replayPaused)
+                seekReplay(tick > 0 ? tick - 1 : 0);
+            else
+                seekReplay(tick > 5 * TICK_RATE ? tick - 5 * TICK_RATE : 0);
+            break;
+        case Keyboard::Home:
+            seekReplay(0);
+            break;
+        case Keyboard::End:
+            seekReplay(replay->getTickCount());
+            break;
+        case Keyboard::PageUp:
+            setSpeedStep(speedStep + 1);
+            break;
+        case Keyboard::PageDown:
+            setSpeedStep(speedStep - 1);
+            break;
+        default:
+            break;
+        }
+        updateReplayText();
+    }
+
+    // Salta a un tick de la repetición; los efectos del tick anterior ya no corresponden
+    void seekReplay(Uint32 tick)
+    {
+        replay->seek(*match, tick);
+        particles.clear();
+        updateScoreDisplay();
+        if (timer->updateDisplay())
+        {
+            staticLayerDirty = true;
+        }
+    }
+
+    // Lleva la repetición a la posición del mouse sobre la línea de tiempo. Con requireHit
+    // solo responde si el clic cae sobre la barra (con un margen para acertarle)
+    bool scrubReplay(int x, int y, bool requireHit)
+    {
+        Vector2f point = window.mapPixelToCoords(Vector2i(x, y));
+        FloatRect bounds = replayBar.getGlobalBounds();
+        if (requireHit && (point.y < bounds.top - 10 || point.y > bounds.top + bounds.height + 10))
+            return false;
+        float fraction = max(0.0f, min(1.0f, (point.x - bounds.left) / bounds.width));
+        seekReplay((Uint32)(fraction * replay->getTickCount()));
+        return true;
+    }
+
+    void updateReplayText()
+    {
+        string status = replayRewinding ? "REBOBINANDO" : (replayPaused ? "PAUSA" : "REPRODUCIENDO");
+        replayText.setString("REPETICION - " + status + "   Espacio, flechas, R rebobinar, Inicio/Fin, RePag/AvPag, Esc");
+    }
+
+    // Partido IA vs IA sin sonido que se juega detrás de los menús
+    void startAttractMode()
+    {
+        if (replayWriter)
+            replayWriter->finish();
+        if (telemetry)
+            match->subscribe(&telemetry->getQueue());
+
+        state = MENU;
+        speedStep = 0;
+        match->setFixedPoint(fixedPointPhysics); // una repetición pudo cambiar el modo de física
+        match->getLeftPaddle().setIsAI(true);
+        match->getRightPaddle().setIsAI(true);
+        match->getLeftPaddle().setAILevel(menu->getAILevel1());
+        match->getRightPaddle().setAILevel(menu->getAILevel2());
+        match->setMaxScore(menu->getMaxScore());
+        match->setPowerUpsEnabled(menu->arePowerUpsEnabled());
+        match->unsubscribe(&soundEvents);
+        match->reset();
+        particles.clear();
+        updateScoreDisplay();
+    }
+
+    void handleArenaInput(Keyboard::Key key)
+    {
+        if (key == Keyboard::PageUp)
+        {
+            setSpeedStep(speedStep + 1);
+        }
+        else if (key == Keyboard::PageDown)
+        {
+            setSpeedStep(speedStep - 1);
+        }
+        else if (key == Keyboard::Home)
+        {
+            setSpeedStep(0);
+        }
+        else if (key == Keyboard::Escape)
+        {
+            delete arena;
+            arena = nullptr;
+            startAttractMode();
+        }
+    }
+
+    void drawArena()
+    {
+        window.clear(Color::Black);
+        float pixelWidth = window.getSize().x * fieldView.getViewport().width;
+        arena->draw(window, renderAlpha, pixelWidth);
+
+        // Rendimiento de la simulación, una vez por segundo
+        if (arenaStatsClock.getElapsedTime() >= seconds(1))
+        {
+            arenaStatsClock.restart();
+            Int64 elapsed = max((Int64)1, arena->getSimulationMicroseconds());
+            arenaText.setString(to_string(arena->getMatchCount()) + " partidos, " + to_string(arena->getThreadCount()) + " hilos, " +
+                                to_string((Uint64)(arena->getSimulatedTicks() * 1000000 / elapsed)) + " ticks/s de simulacion");
+            arena->resetStats();
+        }
+        window.draw(arenaText);
+
+        if (speedStep != 0)
+        {
+            window.draw(speedTexts[speedStep - MIN_SPEED_STEP]);
+        }
+    }
+
+    // Reescribe los textos del menú de opciones con los valores actuales
+    void refreshOptionsMenu()
+    {
+        optionsMenuOptions[0].setString("Dificultad IA 1: " + to_string(static_cast<int>(menu->getAILevel1())));
+        optionsMenuOptions[1].setString("Dificultad IA 2: " + to_string(static_cast<int>(menu->getAILevel2())));
+        optionsMenuOptions[2].setString("Duracion Partida: " + to_string(menu->getGameDuration()) + " min");
+        optionsMenuOptions[3].setString("Puntuacion Maxima: " + to_string(menu->getMaxScore()));
+        optionsMenuOptions[4].setString("Power-Ups: " + string(menu->arePowerUpsEnabled() ? "Activados" : "Desactivados"));
+        optionsMenuOptions[5].setString("Volver");
+
+        for (size_t i = 0; i < optionsMenuOptions.size(); i++)
+        {
+            BitmapText &optionText = optionsMenuOptions[i];
+            FloatRect optionBounds = optionText.getLocalBounds();
+            optionText.setOrigin(optionBounds.left + optionBounds.width / 2.0f, optionBounds.top);
+            optionText.setPosition(FIELD_WIDTH / 2.0f, 150 + i * 50);
+
+            // Resaltar opción seleccionada
+            if (i == selectedOptionsOption)
+                optionText.setFillColor(Color::Yellow);
+            else
+                optionText.setFillColor(Color::White);
+        }
+    }
+
+    void handleOptionsInput(Keyboard::Key key)
+    {
+        int optionCount = optionsMenuOptions.size();
+        if (key == Keyboard::Up)
+        {
+            selectedOptionsOption = (selectedOptionsOption - 1 + optionCount) % optionCount;
+        }
+        else if (key == Keyboard::Down)
+        {
+            selectedOptionsOption = (selectedOptionsOption + 1) % optionCount;
+        }
+        else if (key == Keyboard::Left)
+        {
+            // Disminuir valor
+            switch (selectedOptionsOption)
+            {
+            case 0: // Nivel IA 1
+                if (menu->getAILevel1() > EASY)
+                    menu->setAILevel1(static_cast<AILevel>(static_cast<int>(menu->getAILevel1()) - 1));
+                break;
+            case 1: // Nivel IA 2
+                if (menu->getAILevel2() > EASY)
+                    menu->setAILevel2(static_cast<AILevel>(static_cast<int>(menu->getAILevel2()) - 1));
+                break;
+            case 2: // Duración del juego
+                if (menu->getGameDuration() > 1)
+                    menu->setGameDuration(menu->getGameDuration() - 1);
+                break;
+            case 3: // Puntuación máxima
+                if (menu->getMaxScore() > 3)
+                    menu->setMaxScore(menu->getMaxScore() - 2);
+                break;
+            case 4: // Power-Ups
+                menu->setPowerUpsEnabled(!menu->arePowerUpsEnabled());
+                break;
+            }
+        }
+        else if (key == Keyboard::Right)
+        {
+            // Aumentar valor
+            switch (selectedOptionsOption)
+            {
+            case 0: // Nivel IA 1
+                if (menu->getAILevel1() < IMPOSSIBLE)
+                    menu->setAILevel1(static_cast<AILevel>(static_cast<int>(menu->getAILevel1()) + 1));
+                break;
+            case 1: // Nivel IA 2
+                if (menu->getAILevel2() < IMPOSSIBLE)
+                    menu->setAILevel2(static_cast<AILevel>(static_cast<int>(menu->getAILevel2()) + 1));
+                break;
+            case 2: // Duración del juego
+                if (menu->getGameDuration() < MAX_GAME_DURATION_MINUTES)
+                    menu->setGameDuration(menu->getGameDuration() + 1);
+                break;
+            case 3: // Puntuación máxima
+                if (menu->getMaxScore() < 21)
+                    menu->setMaxScore(menu->getMaxScore() + 2);
+                break;
+            case 4: // Power-Ups
+                menu->setPowerUpsEnabled(!menu->arePowerUpsEnabled());
+                break;
             }
         }
+        else if ((key == Keyboard::Return && selectedOptionsOption == 5) || key == Keyboard::Escape)
+        {
+            // Volver al menú principal con la demostración usando la nueva configuración
+            startAttractMode();
+            return;
+        }
+
+        refreshOptionsMenu();
+    }
+
+    void handleDifficultyInput(Keyboard::Key key)
+    {
+        const AILevel difficultyLevels[] = {EASY, MEDIUM, HARD, IMPOSSIBLE};
+
+        if (key == Keyboard::Up)
+        {
+            difficultyOptions[selectedDifficultyOption].setFillColor(Color::White);
+            selectedDifficultyOption = (selectedDifficultyOption - 1 + 4) % 4;
+            difficultyOptions[selectedDifficultyOption].setFillColor(Color::Yellow);
+        }
+        else if (key == Keyboard::Down)
+        {
+            difficultyOptions[selectedDifficultyOption].setFillColor(Color::White);
+            selectedDifficultyOption = (selectedDifficultyOption + 1) % 4;
+            difficultyOptions[selectedDifficultyOption].setFillColor(Color::Yellow);
+        }
+        else if (key == Keyboard::Return)
+        {
+            // Configurar el juego con la dificultad seleccionada
+            gameMode = PLAYER_VS_AI;
+            match->getLeftPaddle().setIsAI(false);
+            match->getRightPaddle().setIsAI(true);
+            match->getRightPaddle().setAILevel(difficultyLevels[selectedDifficultyOption]);
+            menu->setAILevel1(difficultyLevels[selectedDifficultyOption]); // Guardar la selección
+            resetGame();
+            state = PLAYING;
+        }
+        else if (key == Keyboard::Escape)
+        {
+            state = MENU;
+        }
     }
 };
 
-int main()
+// Paso de preparación: rasteriza pixelart.ttf en todos los tamaños del juego y guarda el atlas
+// con sus métricas, que Game carga al iniciar en lugar de hornearlo
+bool bakeFontAtlas(const string &path)
+{
+    Font font;
+    if (!font.loadFromFile(FONT_PATH))
+    {
+        cout << "Error al cargar Fuente Pixel Art" << endl;
+        return false;
+    }
+    Clock clock;
+    BitmapFont bakedFont;
+    if (!bakedFont.bake(font))
+    {
+        cout << "Error al crear el atlas de la fuente" << endl;
+        return false;
+    }
+    Int64 bakeMicroseconds = clock.getElapsedTime().asMicroseconds();
+    if (!bakedFont.save(path))
+    {
+        cout << "Error al escribir " << path << ".png / .txt" << endl;
+        return false;
+    }
+    Vector2u size = bakedFont.getTexture().getSize();
+    cout << bakedFont.getGlyphCount() << " glifos en " << BAKED_FONT_SIZE_COUNT << " tamaños, atlas de " << size.x << "x" << size.y
+         << " horneado en " << bakeMicroseconds / 1000 << " ms: " << path << ".png / .txt" << endl;
+    return true;
+}
+
+int main(int argc, char *argv[])
 {
-    Game game;
+    // Modo de medición del sistema de partículas: PongMejorado.exe --bench-particles [cantidad]
+    if (argc > 1 && string(argv[1]) == "--bench-particles")
+    {
+        benchmarkParticles(argc > 2 ? atoi(argv[2]) : 50000, 1200);
+        return 0;
+    }
+
+    // Atlas de la fuente para los tamaños que usa el juego: PongMejorado.exe --bake-font [salida sin extensión]
+    if (argc > 1 && string(argv[1]) == "--bake-font")
+    {
+        return bakeFontAtlas(argc > 2 ? argv[2] : BAKED_FONT_PATH) ? 0 : 1;
+    }
+
+    // Ajuste automático de la IA: PongMejorado.exe --tune-ai [victorias objetivo] [máximo de partidos por candidato]
+    if (argc > 1 && string(argv[1]) == "--tune-ai")
+    {
+        tuneAILevels(argc > 2 ? (float)atof(argv[2]) : 0.75f, argc > 3 ? atoi(argv[3]) : 2000);
+        return 0;
+    }
+
+    // Verificación bit a bit de la física en punto fijo: PongMejorado.exe --check-fixed [partidos] [hash esperado]
+    if (argc > 1 && string(argv[1]) == "--check-fixed")
+    {
+        return checkFixedPoint(argc > 2 ? atoi(argv[2]) : 64, argc > 3 ? argv[3] : nullptr);
+    }
+
+    // Prueba de estrés con invariantes: PongMejorado.exe --soak [segundos] [hilos] [semilla inicial]
+    if (argc > 1 && string(argv[1]) == "--soak")
+    {
+        return soakTest(argc > 2 ? atof(argv[2]) : 60.0, argc > 3 ? atoi(argv[3]) : getCpuCount(),
+                        argc > 4 ? (unsigned int)strtoul(argv[4], nullptr, 10) : 1, -1);
+    }
+
+    // Reproducir y reducir una semilla de la prueba de estrés: PongMejorado.exe --soak-seed semilla
+    if (argc > 2 && string(argv[1]) == "--soak-seed")
+    {
+        return soakTest(0.0, 1, 0, strtoll(argv[2], nullptr, 10));
+    }
+
+    // Costo de la física en float contra punto fijo: PongMejorado.exe --bench-physics [partidos]
+    if (argc > 1 && string(argv[1]) == "--bench-physics")
+    {
+        benchmarkPhysics(argc > 2 ? atoi(argv[2]) : 64);
+        return 0;
+    }
+
+    // Pruebas de colisión por pelota: PongMejorado.exe --bench-collisions [ticks]
+    if (argc > 1 && string(argv[1]) == "--bench-collisions")
+    {
+        benchmarkCollisions(argc > 2 ? atoi(argv[2]) : 1000000);
+        return 0;
+    }
+
+    // Reinicios por segundo y memoria por partido: PongMejorado.exe --bench-match-memory [reinicios]
+    if (argc > 1 && string(argv[1]) == "--bench-match-memory")
+    {
+        benchmarkMatchMemory(argc > 2 ? atoi(argv[2]) : 1000000);
+        return 0;
+    }
+    // Exportar telemetría a CSV: PongMejorado.exe --telemetry-csv entrada.bin salida.csv
+    if (argc > 3 && string(argv[1]) == "--telemetry-csv")
+    {
+        return exportTelemetryCsv(argv[2], argv[3]) ? 0 : 1;
+    }
+
+    // Costo de la telemetría por tick: PongMejorado.exe --bench-telemetry [partidos]
+    if (argc > 1 && string(argv[1]) == "--bench-telemetry")
+    {
+        benchmarkTelemetry(argc > 2 ? atoi(argv[2]) : 32);
+        return 0;
+    }
+    // Tiempo de frame según la cantidad de hilos: PongMejorado.exe --bench-jobs [partidos] [partículas] [frames] [hilos]
+    if (argc > 1 && string(argv[1]) == "--bench-jobs")
+    {
+        benchmarkJobs(argc > 2 ? atoi(argv[2]) : 256, argc > 3 ? atoi(argv[3]) : 50000, argc > 4 ? atoi(argv[4]) : 300,
+                      argc > 5 ? atoi(argv[5]) : getCpuCount());
+        return 0;
+    }
+    // Simulación y dibujo de muchos partidos a la vez: PongMejorado.exe --bench-arena [partidos] [frames]
+    if (argc > 1 && string(argv[1]) == "--bench-arena")
+    {
+        Game game;
+        game.benchmarkArena(argc > 2 ? atoi(argv[2]) : 64, argc > 3 ? atoi(argv[3]) : 600);
+        return 0;
+    }
+
+    // Bot de referencia por memoria compartida: PongMejorado.exe --bot-client left|right
+    if (argc > 1 && string(argv[1]) == "--bot-client")
+    {
+        return runBotClient(argc > 2 && string(argv[2]) == "right" ? 1 : 0);
+    }
+    // Bot contra la IA sin ventana y latencia del protocolo: PongMejorado.exe --bot-match [ticks] [ticks/s, 0 = sin pausa]
+    if (argc > 1 && string(argv[1]) == "--bot-match")
+    {
+        return playBotMatch(argc > 2 ? atoi(argv[2]) : 12000, argc > 3 ? atoi(argv[3]) : TICK_RATE);
+    }
+
+    // Opciones del juego:
+    //   --fixed-point              física determinista en punto fijo
+    //   --record archivo.y4m [fps] graba video (o una secuencia de PNG si no termina en .y4m)
+    //   --telemetry archivo.bin    registra la telemetría de los partidos
+    //   --size 1920x1080           tamaño inicial de la ventana (el campo se escala)
+    //   --fps 240                  frecuencia de dibujo, p. ej. la del monitor
+    //   --record-replay archivo.rpl graba una repetición de cada partido jugado
+    //   --replay archivo.rpl       abre el visor de repeticiones
+    //   --arena 64                 cuadrícula de partidos IA contra IA (16, 64, 256...)
+    //   --no-attract               menús quietos, sin la demostración IA vs IA detrás
+    //   --cpu-report               al salir, uso de CPU en cada estado (menús, pausa, juego...)
+    //   --metrics [puerto]         métricas de Prometheus en http://127.0.0.1:9120/metrics
+    //   --bot left|right|both      paletas manejadas por bots externos (--bot-client)
+    bool fixedPoint = false;
+    bool attract = true;
+    bool cpuReport = false;
+    int metricsPort = 0;
+    bool botLeft = false, botRight = false;
+    string recordPath;
+    string telemetryPath;
+    int recordFps = 60;
+    string replayRecordPath;
+    string replayPath;
+    int arenaMatches = 0;
+    unsigned int windowWidth = 0, windowHeight = 0;
+    int frameRate = FRAME_RATE;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (arg == "--fixed-point")
+        {
+            fixedPoint = true;
+        }
+        else if (arg == "--record" && i + 1 < argc)
+        {
+            recordPath = argv[++i];
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+                recordFps = atoi(argv[++i]);
+        }
+        else if (arg == "--telemetry" && i + 1 < argc)
+        {
+            telemetryPath = argv[++i];
+        }
+        else if (arg == "--size" && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%ux%u", &windowWidth, &windowHeight) != 2)
+                windowWidth = windowHeight = 0;
+        }
+        else if (arg == "--fps" && i + 1 < argc)
+        {
+            frameRate = atoi(argv[++i]);
+        }
+        else if (arg == "--record-replay" && i + 1 < argc)
+        {
+            replayRecordPath = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc)
+        {
+            replayPath = argv[++i];
+        }
+        else if (arg == "--arena" && i + 1 < argc)
+        {
+            arenaMatches = atoi(argv[++i]);
+        }
+        else if (arg == "--no-attract")
+        {
+            attract = false;
+        }
+        else if (arg == "--cpu-report")
+        {
+            cpuReport = true;
+        }
+        else if (arg == "--metrics")
+        {
+            metricsPort = METRICS_DEFAULT_PORT;
+            if (i + 1 < argc && isdigit(argv[i + 1][0]))
+                metricsPort = atoi(argv[++i]);
+        }
+        else if (arg == "--bot" && i + 1 < argc)
+        {
+            string side = argv[++i];
+            botLeft = side == "left" || side == "both";
+            botRight = side == "right" || side == "both";
+        }
+    }
+
+    Game game(fixedPoint);
+    if (windowWidth > 0 && windowHeight > 0)
+    {
+        game.setResolution(windowWidth, windowHeight);
+    }
+    game.setFrameRate(frameRate);
+    game.setAttractMode(attract);
+    if (cpuReport)
+    {
+        game.enableCpuReport();
+    }
+    if (metricsPort > 0)
+    {
+        game.startMetricsServer((unsigned short)metricsPort);
+    }
+    if (botLeft || botRight)
+    {
+        game.openBotLink(botLeft, botRight);
+    }
+    if (!recordPath.empty())
+    {
+        game.startRecording(recordPath, recordFps);
+    }
+    if (!telemetryPath.empty())
+    {
+        game.startTelemetry(telemetryPath);
+    }
+    if (!replayRecordPath.empty())
+    {
+        game.startReplayRecording(replayRecordPath);
+    }
+    if (!replayPath.empty())
+    {
+        game.openReplay(replayPath);
+    }
+    if (arenaMatches > 0)
+    {
+        game.startArena(arenaMatches);
+    }
     game.run();
     return 0;
 }